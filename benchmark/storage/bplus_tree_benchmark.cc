@@ -0,0 +1,105 @@
+#include <benchmark/benchmark.h>
+#include <glog/logging.h>
+
+#include <filesystem>
+#include <functional>
+#include <memory>
+#include <random>
+#include <string>
+#include <thread>
+
+#include "src/common/config.h"
+#include "src/storage/bplus_tree.h"
+#include "src/storage/buffer_manager.h"
+#include "src/storage/disk_manager.h"
+#include "src/storage/log_manager.h"
+#include "src/storage/option.h"
+
+//
+// Concurrent point lookups and updates on a single B+ tree.
+//
+// The tree is loaded with TREE_KEYS keys once. Every thread then picks keys
+// uniformly at random and either reads the key or overwrites its value, with
+// the percentage of writes given as the argument. The writes don't change
+// the shape of the tree, so every run sees the same tree. The throughput of
+// all threads together is reported, which shows how far readers and writers
+// scale before they serialize on the latches of the upper levels.
+//
+
+namespace graphchaindb {
+namespace {
+
+static constexpr absl::string_view BENCHMARK_DB_PATH =
+    "/tmp/toykv_bplus_tree_benchmark";
+static constexpr int TREE_KEYS = 500;
+
+std::string KeyOf(int i) { return "benchmark_key_" + std::to_string(i); }
+
+// The tree shared by all of the benchmark threads
+struct SharedTree {
+    SharedTree() {
+        std::string path{BENCHMARK_DB_PATH.data(), BENCHMARK_DB_PATH.size()};
+        std::filesystem::remove(path + ".db");
+        std::filesystem::remove(path + ".log");
+
+        disk_manager = std::make_unique<DiskManager>(BENCHMARK_DB_PATH);
+        log_manager = std::make_unique<LogManager>(disk_manager.get());
+        buffer_manager = std::make_unique<BufferManager>(disk_manager.get(),
+                                                         log_manager.get());
+        bplus_tree = std::make_unique<BplusTree>(
+            buffer_manager.get(), disk_manager.get(), log_manager.get());
+
+        CHECK(disk_manager->CreateDBFilesAndLoadDB().ok());
+        log_manager->SetNextLogNumber(STARTING_LOG_NUMBER);
+        CHECK(buffer_manager->Init(STARTING_NORMAL_PAGE_ID).ok());
+        CHECK(bplus_tree->Init().ok());
+
+        for (int i = 0; i < TREE_KEYS; i++) {
+            CHECK(bplus_tree->Insert(WriteOptions(), KeyOf(i), KeyOf(i)).ok());
+        }
+    }
+
+    std::unique_ptr<DiskManager> disk_manager;
+    std::unique_ptr<LogManager> log_manager;
+    std::unique_ptr<BufferManager> buffer_manager;
+    std::unique_ptr<BplusTree> bplus_tree;
+};
+
+BplusTree* GetSharedTree() {
+    static SharedTree shared_tree;
+    return shared_tree.bplus_tree.get();
+}
+
+void BM_BplusTreeConcurrentReadWrite(benchmark::State& state) {
+    auto bplus_tree = GetSharedTree();
+    int write_percent = state.range(0);
+
+    std::mt19937 generator(
+        std::hash<std::thread::id>()(std::this_thread::get_id()));
+    std::uniform_int_distribution<int> key_distribution(0, TREE_KEYS - 1);
+    std::uniform_int_distribution<int> percent_distribution(0, 99);
+
+    for (auto _ : state) {
+        auto key = KeyOf(key_distribution(generator));
+        if (percent_distribution(generator) < write_percent) {
+            CHECK(bplus_tree->Insert(WriteOptions(), key, key).ok());
+        } else {
+            auto value_or_status = bplus_tree->Get(ReadOptions(), key);
+            CHECK(value_or_status.ok());
+            benchmark::DoNotOptimize(value_or_status);
+        }
+    }
+
+    state.SetItemsProcessed(state.iterations());
+}
+
+BENCHMARK(BM_BplusTreeConcurrentReadWrite)
+    ->ArgName("write_percent")
+    ->Arg(0)
+    ->Arg(10)
+    ->Arg(50)
+    ->ThreadRange(1, 8)
+    ->UseRealTime();
+
+}  // namespace
+}  // namespace graphchaindb
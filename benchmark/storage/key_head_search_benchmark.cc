@@ -0,0 +1,84 @@
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+#include "src/storage/key_head_search.h"
+
+//
+// Search for the range of equal key heads among the sorted key heads of a
+// single B+ tree node, see BplusTreePage::GetKeyHead.
+//
+// The scalar binary search is the baseline for the vector implementations,
+// which narrow the heads down and then scan them. The node size is the
+// argument and goes beyond the fanout of the pages.
+//
+
+namespace graphchaindb {
+namespace {
+
+static constexpr int LOOKUPS = 1024;
+
+// A node with random heads, and lookups for half of them and for as many
+// heads which aren't in the node
+struct Node {
+    explicit Node(int size) {
+        std::mt19937 generator(42);
+        std::uniform_int_distribution<uint32_t> distribution;
+        for (int i = 0; i < size; i++) {
+            key_heads.push_back(distribution(generator));
+        }
+        std::sort(key_heads.begin(), key_heads.end());
+
+        std::uniform_int_distribution<int> index_distribution(0, size - 1);
+        for (int i = 0; i < LOOKUPS; i++) {
+            lookups.push_back(i % 2 == 0
+                                  ? key_heads[index_distribution(generator)]
+                                  : distribution(generator));
+        }
+    }
+
+    std::vector<uint32_t> key_heads;
+    std::vector<uint32_t> lookups;
+};
+
+void BM_KeyHeadSearch(benchmark::State& state, KeyHeadSearchType type) {
+    if (!IsKeyHeadSearchSupported(type)) {
+        state.SkipWithError("unsupported by the CPU");
+        return;
+    }
+
+    Node node(state.range(0));
+    int count = node.key_heads.size();
+
+    int lookup = 0;
+    for (auto _ : state) {
+        auto range = SearchKeyHeads(type, node.key_heads.data(), count,
+                                    node.lookups[lookup++ % LOOKUPS]);
+        benchmark::DoNotOptimize(range);
+    }
+
+    state.SetItemsProcessed(state.iterations());
+}
+
+BENCHMARK_CAPTURE(BM_KeyHeadSearch, scalar, KeyHeadSearchType::SCALAR)
+    ->ArgName("keys")
+    ->RangeMultiplier(2)
+    ->Range(8, 1024);
+BENCHMARK_CAPTURE(BM_KeyHeadSearch, sse42, KeyHeadSearchType::SSE42)
+    ->ArgName("keys")
+    ->RangeMultiplier(2)
+    ->Range(8, 1024);
+BENCHMARK_CAPTURE(BM_KeyHeadSearch, avx2, KeyHeadSearchType::AVX2)
+    ->ArgName("keys")
+    ->RangeMultiplier(2)
+    ->Range(8, 1024);
+BENCHMARK_CAPTURE(BM_KeyHeadSearch, neon, KeyHeadSearchType::NEON)
+    ->ArgName("keys")
+    ->RangeMultiplier(2)
+    ->Range(8, 1024);
+
+}  // namespace
+}  // namespace graphchaindb
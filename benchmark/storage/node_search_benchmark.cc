@@ -0,0 +1,165 @@
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "src/storage/bplus_tree_page.h"
+#include "src/storage/bplus_tree_search.h"
+#include "src/storage/default_key_comparator.h"
+#include "src/storage/string_container.h"
+
+//
+// Search for a key among the sorted keys of a single B+ tree node.
+//
+// The node is an array of string containers with random short keys, the way
+// they are laid out in the pages. The node size is the argument and goes
+// well beyond the fanout of the current pages, which shows how the search
+// scales once the nodes hold more keys. The linear scan which copies every
+// key out of its container is the baseline, as the tree searched before.
+//
+// The comparisons counter is the number of key comparisons per lookup,
+// which the key heads of the normalized prefix search mostly avoid.
+//
+
+namespace graphchaindb {
+namespace {
+
+static constexpr int LOOKUPS = 1024;
+static constexpr int KEY_SIZE = 16;
+
+std::string RandomKey(std::mt19937* generator) {
+    static constexpr char ALPHABET[] = "abcdefghijklmnopqrstuvwxyz0123456789";
+    std::uniform_int_distribution<int> distribution(0, sizeof(ALPHABET) - 2);
+    std::string key(KEY_SIZE, ' ');
+    for (auto& c : key) {
+        c = ALPHABET[distribution(*generator)];
+    }
+    return key;
+}
+
+// A comparator which counts the comparisons
+class CountingKeyComparator : public DefaultKeyComparator {
+   public:
+    int Compare(const absl::string_view a, const absl::string_view b) override {
+        comparisons++;
+        return DefaultKeyComparator::Compare(a, b);
+    }
+
+    int64_t comparisons = 0;
+};
+
+// A node with random keys, and lookups for half of them and for as many
+// keys which aren't in the node
+struct Node {
+    explicit Node(int size) : keys(size) {
+        std::mt19937 generator(42);
+        std::vector<std::string> sorted_keys;
+        for (int i = 0; i < size; i++) {
+            sorted_keys.push_back(RandomKey(&generator));
+        }
+        std::sort(sorted_keys.begin(), sorted_keys.end());
+
+        for (int i = 0; i < size; i++) {
+            keys[i].SetStringData(nullptr, sorted_keys[i]);
+            key_heads.push_back(BplusTreePage::GetKeyHead(sorted_keys[i]));
+        }
+
+        std::uniform_int_distribution<int> distribution(0, size - 1);
+        for (int i = 0; i < LOOKUPS; i++) {
+            lookups.push_back(i % 2 == 0 ? sorted_keys[distribution(generator)]
+                                         : RandomKey(&generator));
+        }
+    }
+
+    std::vector<StringContainer> keys;
+    std::vector<uint32_t> key_heads;
+    std::vector<std::string> lookups;
+};
+
+void ReportComparisons(benchmark::State& state,
+                       const CountingKeyComparator& comp) {
+    state.counters["comparisons"] =
+        static_cast<double>(comp.comparisons) / state.iterations();
+    state.SetItemsProcessed(state.iterations());
+}
+
+void BM_NodeSearchLinear(benchmark::State& state) {
+    Node node(state.range(0));
+    CountingKeyComparator comp;
+    int count = node.keys.size();
+
+    int lookup = 0;
+    for (auto _ : state) {
+        auto& key = node.lookups[lookup++ % LOOKUPS];
+        int idx = 0;
+        while (idx < count &&
+               comp.Compare(key, node.keys[idx].GetStringData(nullptr)) > 0) {
+            idx++;
+        }
+        benchmark::DoNotOptimize(idx);
+    }
+
+    ReportComparisons(state, comp);
+}
+
+void BM_NodeSearchBinary(benchmark::State& state) {
+    Node node(state.range(0));
+    CountingKeyComparator comp;
+    int count = node.keys.size();
+
+    int lookup = 0;
+    for (auto _ : state) {
+        auto& key = node.lookups[lookup++ % LOOKUPS];
+        bool found;
+        auto idx = LowerBoundKey(
+            count,
+            [&](int32_t idx) {
+                return CompareStoredKey(&comp, nullptr, key, &node.keys[idx]);
+            },
+            &found);
+        benchmark::DoNotOptimize(idx);
+    }
+
+    ReportComparisons(state, comp);
+}
+
+void BM_NodeSearchNormalizedPrefix(benchmark::State& state) {
+    Node node(state.range(0));
+    CountingKeyComparator comp;
+    int count = node.keys.size();
+
+    int lookup = 0;
+    for (auto _ : state) {
+        auto& key = node.lookups[lookup++ % LOOKUPS];
+        auto key_head = BplusTreePage::GetKeyHead(key);
+        bool found;
+        auto idx = LowerBoundKey(
+            count,
+            [&](int32_t idx) {
+                int comp_result = CompareKeyHead(key_head, node.key_heads[idx]);
+                if (comp_result != 0) {
+                    return comp_result;
+                }
+                return CompareStoredKey(&comp, nullptr, key, &node.keys[idx]);
+            },
+            &found);
+        benchmark::DoNotOptimize(idx);
+    }
+
+    ReportComparisons(state, comp);
+}
+
+BENCHMARK(BM_NodeSearchLinear)->ArgName("keys")->RangeMultiplier(4)->Range(
+    16, 1024);
+BENCHMARK(BM_NodeSearchBinary)->ArgName("keys")->RangeMultiplier(4)->Range(
+    16, 1024);
+BENCHMARK(BM_NodeSearchNormalizedPrefix)
+    ->ArgName("keys")
+    ->RangeMultiplier(4)
+    ->Range(16, 1024);
+
+}  // namespace
+}  // namespace graphchaindb
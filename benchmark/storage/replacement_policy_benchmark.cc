@@ -0,0 +1,123 @@
+#include <benchmark/benchmark.h>
+
+#include <memory>
+#include <random>
+#include <unordered_map>
+#include <vector>
+
+#include "src/common/config.h"
+#include "src/storage/option.h"
+#include "src/storage/replacement_policy.h"
+
+//
+// Trace driven comparison of the buffer pool replacement policies.
+//
+// The trace interleaves point lookups with a full scan, the way they arrive
+// at the buffer pool when a lookup workload runs while a scan is in
+// progress. A point lookup reads the root, one of a few internal pages and
+// one of the hot leaves. The scan reads every page of a large range once.
+// Every policy replays the same trace against a simulated pool and the hit
+// ratio of the point lookups is reported.
+//
+
+namespace graphchaindb {
+namespace {
+
+static constexpr int POOL_FRAMES = 512;
+static constexpr int INTERNAL_PAGES = 16;
+static constexpr int HOT_LEAF_PAGES = 256;
+static constexpr int WARMUP_LOOKUPS = 10000;
+static constexpr int SCAN_PAGES = 100000;
+static constexpr page_id_t FIRST_SCAN_PAGE_ID = 1000000;
+
+struct Access {
+    page_id_t page_id;
+    bool is_lookup;
+};
+
+std::vector<Access> BuildTrace(int lookups_per_scan_page) {
+    std::mt19937 generator(42);
+    std::uniform_int_distribution<int> internal_distribution(
+        0, INTERNAL_PAGES - 1);
+    std::uniform_int_distribution<int> leaf_distribution(0,
+                                                         HOT_LEAF_PAGES - 1);
+
+    std::vector<Access> trace;
+    auto add_lookup = [&]() {
+        trace.push_back({0, true});
+        trace.push_back({1 + internal_distribution(generator), true});
+        trace.push_back(
+            {1 + INTERNAL_PAGES + leaf_distribution(generator), true});
+    };
+
+    for (int i = 0; i < WARMUP_LOOKUPS; i++) {
+        add_lookup();
+    }
+
+    for (int i = 0; i < SCAN_PAGES; i++) {
+        trace.push_back({FIRST_SCAN_PAGE_ID + i, false});
+        for (int j = 0; j < lookups_per_scan_page; j++) {
+            add_lookup();
+        }
+    }
+
+    return trace;
+}
+
+// Replays the trace against a pool of POOL_FRAMES frames managed by the
+// policy. Pages are unpinned right after the access, so every frame is
+// evictable.
+void BM_ReplacementPolicyScanWithLookups(benchmark::State& state) {
+    auto type = static_cast<ReplacementPolicyType>(state.range(0));
+    auto trace = BuildTrace(state.range(1));
+
+    int64_t lookups = 0;
+    int64_t lookup_hits = 0;
+    for (auto _ : state) {
+        auto policy = NewReplacementPolicy(type, POOL_FRAMES);
+        std::unordered_map<page_id_t, int> page_table;
+        std::vector<page_id_t> frames(POOL_FRAMES, INVALID_PAGE_ID);
+        int used_frames = 0;
+        lookups = 0;
+        lookup_hits = 0;
+
+        for (std::size_t i = 0; i < trace.size(); i++) {
+            auto& access = trace[i];
+            bool measured = access.is_lookup && i >= 3 * WARMUP_LOOKUPS;
+            lookups += measured;
+
+            auto itr = page_table.find(access.page_id);
+            if (itr != page_table.end()) {
+                lookup_hits += measured;
+                policy->RecordAccess(itr->second);
+                continue;
+            }
+
+            int frame_index = used_frames;
+            if (used_frames < POOL_FRAMES) {
+                used_frames++;
+            } else {
+                frame_index = policy->Evict([](int) { return true; }).value();
+                page_table.erase(frames[frame_index]);
+            }
+
+            frames[frame_index] = access.page_id;
+            page_table[access.page_id] = frame_index;
+            policy->RecordInsert(frame_index, access.page_id);
+        }
+    }
+
+    state.counters["lookup_hit_ratio"] =
+        static_cast<double>(lookup_hits) / lookups;
+    state.counters["accesses"] = benchmark::Counter(
+        trace.size(), benchmark::Counter::kIsIterationInvariantRate);
+}
+
+BENCHMARK(BM_ReplacementPolicyScanWithLookups)
+    ->ArgNames({"policy", "lookups_per_scan_page"})
+    ->ArgsProduct({{REPLACEMENT_POLICY_CLOCK, REPLACEMENT_POLICY_TWO_QUEUE},
+                   {1, 4}})
+    ->Unit(benchmark::kMillisecond);
+
+}  // namespace
+}  // namespace graphchaindb
@@ -11,14 +11,35 @@ static constexpr int PAGE_SIZE = 4096;  // size of a page in Bytes
 static constexpr int STRING_CONTAINER_SIZE =
     64;  // size of the string container in Bytes
 static constexpr int PAGE_BUFFER_SIZE = 50;  // size of the buffer pool cache
+static constexpr int PAGE_BUFFER_PARTITIONS =
+    5;  // number of independently locked buffer pool partitions. MUST divide
+        // PAGE_BUFFER_SIZE
+static constexpr int CACHE_LINE_SIZE = 64;  // size of a cpu cache line
+static constexpr int HUGE_PAGE_SIZE =
+    2 * 1024 * 1024;  // size of a huge page backing the buffer pool in Bytes
 static constexpr int INVALID_PAGE_ID = -1;   // indicates an invalid page
 static constexpr int ROOT_PAGE_ID = 0;       // id of the root database page
+static constexpr int FREE_SPACE_MAP_PAGE_ID =
+    1;  // id of the page tracking the free space of the overflow pages
+static constexpr uint32_t DB_FORMAT_VERSION =
+    0x746b7602;  // format of the db file, stored in the root page. Files of a
+                 // different format are refused
 static constexpr int STARTING_NORMAL_PAGE_ID =
-    1;  // id of the first non-special page
-static constexpr int BPLUS_LEAF_KEY_VALUE_SIZE =
-    30;  // maximum number of key-value pairs in a leaf node
+    2;  // id of the first non-special page
+static constexpr int FREE_SPACE_CLASSES =
+    16;  // number of size classes of the free space map
+static constexpr int FREE_SPACE_CLASS_SIZE =
+    PAGE_SIZE / FREE_SPACE_CLASSES;  // Bytes of free space per size class
+static constexpr int BPLUS_MAX_INLINE_STRING_SIZE =
+    128;  // longest key or value stored in a B+ tree page as is. Longer ones
+          // are kept in a string container
+static constexpr int BPLUS_MIN_FILL_PERCENT =
+    25;  // a B+ tree page used less than this is rebalanced after a delete.
+         // Well below half, so that a page which was just split or merged
+         // isn't merged or split again right away
 static constexpr int BPLUS_INTERNAL_KEY_PAGE_ID_SIZE =
-    49;  // maximum number of key-pageid pairs in an internal node
+    PAGE_SIZE / 10;  // upper bound of the key-pageid pairs in an internal
+                     // node, reached with empty keys
 
 static constexpr int VERBOSE_CHEAP =
     1;  // verbose logging which includes should be cheap
@@ -36,8 +57,40 @@ static constexpr ln_t STARTING_LOG_NUMBER =
 static constexpr absl::string_view NEXT_PAGE_ID_KEY = "toykv-next-page-id";
 static constexpr absl::string_view INDEX_ROOT_PAGE_ID_KEY =
     "toykv-index-root-page-id";
+static constexpr absl::string_view BULK_LOAD_KEY =
+    "toykv-bulk-load";  // "<index root page id> <next page id>" of a load
 
-static constexpr int FLUSH_WAIT_INTERVAL_MILLISECONDS = 500;
+static constexpr int OPTIMISTIC_READ_MAX_ATTEMPTS =
+    3;  // optimistic B+ tree descents before falling back to read locks
+static constexpr int OPTIMISTIC_WRITE_MAX_ATTEMPTS =
+    3;  // optimistic B+ tree descents of a write before falling back to
+        // exclusive latch crabbing
+
+static constexpr int FLUSH_WAIT_INTERVAL_MILLISECONDS =
+    500;  // longest pause of the background writer between two rounds
+static constexpr int FLUSH_MIN_WAIT_INTERVAL_MILLISECONDS =
+    10;  // shortest pause of the background writer between two rounds
+static constexpr int FLUSH_LOW_WATERMARK_PERCENT =
+    10;  // dirty pages in the pool which the background writer leaves alone
+static constexpr int FLUSH_HIGH_WATERMARK_PERCENT =
+    50;  // dirty pages in the pool above which the writer runs flat out
+static constexpr int FLUSH_MAX_PAGES_PER_ROUND =
+    16;  // pages written by the background writer in a round due to the
+         // watermarks
+static constexpr int FLUSH_MAX_LOG_DISTANCE =
+    1000;  // log entries a page may stay dirty for before it is written
+
+static constexpr int READAHEAD_INITIAL_WINDOW =
+    2;  // leaves prefetched once a sequential leaf scan is detected
+static constexpr int READAHEAD_MAX_WINDOW =
+    8;  // maximum number of leaves prefetched ahead of a scan
+static constexpr int READAHEAD_MAX_STREAMS =
+    4;  // number of concurrent scans tracked by the readahead
+
+static constexpr int WARMUP_SAVE_INTERVAL_MILLISECONDS =
+    30000;  // pause between two saves of the resident pages for warm-up
+static constexpr int WARMUP_PREFETCH_THREADS =
+    4;  // threads reading the saved pages back in after a restart
 
 }  // namespace graphchaindb
 
@@ -0,0 +1,103 @@
+#include "background_writer.h"
+
+#include <glog/logging.h>
+
+#include <algorithm>
+
+#include "buffer_manager.h"
+#include "log_manager.h"
+
+namespace graphchaindb {
+
+BackgroundWriter::BackgroundWriter(BufferManager* buffer_manager,
+                                   LogManager* log_manager)
+    : buffer_manager_{CHECK_NOTNULL(buffer_manager)},
+      log_manager_{CHECK_NOTNULL(log_manager)} {}
+
+BackgroundWriter::~BackgroundWriter() { Stop(); }
+
+void BackgroundWriter::Start() {
+    std::unique_lock l(mu_);
+    if (running_) {
+        return;
+    }
+
+    running_ = true;
+    worker_ = std::thread(&BackgroundWriter::WorkerRoutine, this);
+}
+
+void BackgroundWriter::Stop() {
+    {
+        std::unique_lock l(mu_);
+        if (!running_) {
+            return;
+        }
+
+        running_ = false;
+    }
+
+    stop_cv_.notify_all();
+    worker_.join();
+}
+
+void BackgroundWriter::WorkerRoutine() {
+    std::unique_lock l(mu_);
+    while (running_) {
+        l.unlock();
+        auto pause = RunRound();
+        l.lock();
+
+        stop_cv_.wait_for(l, pause, [this] { return !running_; });
+    }
+}
+
+std::chrono::milliseconds BackgroundWriter::RunRound() {
+    static constexpr int low_watermark =
+        PAGE_BUFFER_SIZE * FLUSH_LOW_WATERMARK_PERCENT / 100;
+    static constexpr int high_watermark =
+        PAGE_BUFFER_SIZE * FLUSH_HIGH_WATERMARK_PERCENT / 100;
+    static_assert(low_watermark < high_watermark,
+                  "the low watermark must be below the high watermark");
+
+    auto dirty_page_count = buffer_manager_->GetDirtyPageCount();
+    auto next_log_number = log_manager_->GetNextLogNumber();
+
+    int max_pages = std::clamp(dirty_page_count - low_watermark, 0,
+                               FLUSH_MAX_PAGES_PER_ROUND);
+    ln_t log_number_limit = INVALID_LOG_NUMBER;
+    if (next_log_number != INVALID_LOG_NUMBER) {
+        log_number_limit = next_log_number - FLUSH_MAX_LOG_DISTANCE;
+    }
+
+    auto written_or_status =
+        buffer_manager_->FlushDirtyPages(max_pages, log_number_limit);
+    if (!written_or_status.ok()) {
+        LOG(ERROR) << "BackgroundWriter::RunRound: error while writing the "
+                      "dirty pages";
+    } else if (written_or_status.value() > 0) {
+        VLOG(VERBOSE_CHEAP) << "BackgroundWriter::RunRound: wrote "
+                            << written_or_status.value() << " of "
+                            << dirty_page_count << " dirty pages";
+    }
+
+    // pace the next round by the dirty ratio and the growth of the log
+    int pause = FLUSH_WAIT_INTERVAL_MILLISECONDS;
+    if (dirty_page_count >= high_watermark) {
+        pause = FLUSH_MIN_WAIT_INTERVAL_MILLISECONDS;
+    } else if (dirty_page_count > low_watermark) {
+        pause -= (FLUSH_WAIT_INTERVAL_MILLISECONDS -
+                  FLUSH_MIN_WAIT_INTERVAL_MILLISECONDS) *
+                 (dirty_page_count - low_watermark) /
+                 (high_watermark - low_watermark);
+    }
+
+    if (last_round_log_number_ != INVALID_LOG_NUMBER &&
+        next_log_number - last_round_log_number_ > FLUSH_MAX_LOG_DISTANCE / 2) {
+        pause = std::max(pause / 2, FLUSH_MIN_WAIT_INTERVAL_MILLISECONDS);
+    }
+    last_round_log_number_ = next_log_number;
+
+    return std::chrono::milliseconds(pause);
+}
+
+}  // namespace graphchaindb
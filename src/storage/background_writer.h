@@ -0,0 +1,69 @@
+#ifndef STORAGE_BACKGROUND_WRITER_H
+#define STORAGE_BACKGROUND_WRITER_H
+
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+#include "src/common/config.h"
+
+namespace graphchaindb {
+
+class BufferManager;
+class LogManager;
+
+// BackgroundWriter writes the dirty pages of the buffer pool to disk in the
+// background so that evictions rarely have to.
+//
+// Every round writes the pages which have been dirty the longest, in the
+// order of the log number at which they were made dirty:
+// - enough pages to bring the dirty pages down to the low watermark, at most
+//   FLUSH_MAX_PAGES_PER_ROUND
+// - every page which has been dirty for more than FLUSH_MAX_LOG_DISTANCE
+//   log entries, which bounds the log replayed by recovery
+//
+// The pause between the rounds shrinks from FLUSH_WAIT_INTERVAL_MILLISECONDS
+// at the low watermark to FLUSH_MIN_WAIT_INTERVAL_MILLISECONDS at the high
+// watermark, and also shrinks when the log grew by more than half of
+// FLUSH_MAX_LOG_DISTANCE since the previous round.
+//
+// It is thread safe.
+class BackgroundWriter {
+   public:
+    BackgroundWriter(BufferManager* buffer_manager, LogManager* log_manager);
+
+    BackgroundWriter(const BackgroundWriter&) = delete;
+    BackgroundWriter& operator=(const BackgroundWriter&) = delete;
+
+    // Stops the worker
+    ~BackgroundWriter();
+
+    // Start the background worker
+    void Start();
+
+    // Stop the background worker. Waits for the round in progress to finish.
+    void Stop();
+
+   private:
+    // Loop of the background worker
+    void WorkerRoutine();
+
+    // Write the dirty pages which are due. Returns the pause before the next
+    // round.
+    std::chrono::milliseconds RunRound();
+
+    BufferManager* buffer_manager_;
+    LogManager* log_manager_;
+    ln_t last_round_log_number_{INVALID_LOG_NUMBER};  // only used by the
+                                                      // worker
+
+    std::mutex mu_;  // protects running_
+    std::condition_variable stop_cv_;
+    bool running_{false};
+    std::thread worker_;
+};
+
+}  // namespace graphchaindb
+
+#endif  // STORAGE_BACKGROUND_WRITER_H
@@ -2,8 +2,19 @@
 
 #include <glog/logging.h>
 
+#include <algorithm>
+#include <cstring>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "absl/strings/str_cat.h"
+#include "bplus_tree_bulk_loader.h"
+#include "bplus_tree_iterator.h"
 #include "bplus_tree_page_internal.h"
 #include "bplus_tree_page_leaf.h"
+#include "bplus_tree_search.h"
 #include "default_key_comparator.h"
 
 //
@@ -21,10 +32,22 @@ BplusTree::BplusTree(BufferManager* buffer_manager, DiskManager* disk_manager,
 
 BplusTree::BplusTree(BufferManager* buffer_manager, DiskManager* disk_manager,
                      LogManager* log_manager, KeyComparator* comp)
+    : BplusTree(buffer_manager, disk_manager, log_manager, comp, Options()) {}
+
+BplusTree::BplusTree(BufferManager* buffer_manager, DiskManager* disk_manager,
+                     LogManager* log_manager, const Options& options)
+    : BplusTree(CHECK_NOTNULL(buffer_manager), CHECK_NOTNULL(disk_manager),
+                CHECK_NOTNULL(log_manager), new DefaultKeyComparator(),
+                options) {}
+
+BplusTree::BplusTree(BufferManager* buffer_manager, DiskManager* disk_manager,
+                     LogManager* log_manager, KeyComparator* comp,
+                     const Options& options)
     : comp_{CHECK_NOTNULL(comp)},
       buffer_manager_{CHECK_NOTNULL(buffer_manager)},
       disk_manager_{CHECK_NOTNULL(disk_manager)},
-      log_manager_{CHECK_NOTNULL(log_manager)} {}
+      log_manager_{CHECK_NOTNULL(log_manager)},
+      blink_{options.blink_tree} {}
 
 BplusTree::~BplusTree() { delete comp_; }
 
@@ -61,190 +84,170 @@ absl::Status BplusTree::Init(page_id_t root_page_id) {
     }
 
     root_page_id_ = root_page_id;
+    buffer_manager_->SetIndexRootPageId(root_page_id);
     return absl::OkStatus();
 }
 
 absl::Status BplusTree::Insert(const WriteOptions& options,
                                absl::string_view key, absl::string_view value) {
-    CHECK_NE(root_page_id_, INVALID_PAGE_ID);
+    CHECK_NE(root_page_id_.load(), INVALID_PAGE_ID);
     LOG(INFO) << "BplusTree::Insert: start";
     LOG(INFO) << "key: " << key << " value: " << value;
 
+    for (int attempt = 0; attempt < OPTIMISTIC_WRITE_MAX_ATTEMPTS; attempt++) {
+        auto s = InsertOptimistic(key, value);
+        if (absl::IsFailedPrecondition(s)) {
+            break;
+        }
+        if (!absl::IsAborted(s)) {
+            return s;
+        }
+    }
+
+    if (blink_) {
+        return InsertBlink(key, value);
+    }
+
+    LOG(INFO) << "BplusTree::Insert: optimistic insert failed. crabbing "
+                 "down with exclusive locks";
+
     auto status_or_root_page_container =
-        buffer_manager_->GetPageWithId(root_page_id_);
+        GetLatchedRootPage(/* exclusive */ true);
     if (!status_or_root_page_container.ok()) {
         LOG(ERROR) << "BplusTree::Insert: getting root page failed";
         return status_or_root_page_container.status();
     }
 
     auto root_page_container = status_or_root_page_container.value();
-    CHECK_NOTNULL(root_page_container);
-
-    root_page_container->AquireExclusiveLock();
-
-    bool is_full = IsPageFull(root_page_container);
-    absl::Status s;
-    if (is_full) {
-        LOG(INFO) << "BplusTree::Insert: root page is full. creating new root";
-
-        auto status_or_new_root_page_container =
-            buffer_manager_->AllocateNewPage();
-        if (!status_or_new_root_page_container.ok()) {
-            LOG(ERROR) << "BplusTree::Insert: creating new root page failed";
+    if (!IsPageFull(root_page_container)) {
+        LOG(INFO) << "BplusTree::Insert: root page is non-full";
+        return InsertNonFull(key, value, root_page_container,
+                             /* is_dirty */ false);
+    }
 
-            root_page_container->ReleaseExclusiveLock();
-            return status_or_new_root_page_container.status();
-        }
+    LOG(INFO) << "BplusTree::Insert: root page is full. creating new root";
 
-        auto new_root_page_container =
-            status_or_new_root_page_container.value();
-        CHECK_NOTNULL(new_root_page_container);
+    auto status_or_new_root_page_container =
+        buffer_manager_->AllocateNewPage();
+    if (!status_or_new_root_page_container.ok()) {
+        LOG(ERROR) << "BplusTree::Insert: creating new root page failed";
 
-        new_root_page_container->AquireExclusiveLock();
+        buffer_manager_->UnpinPage(root_page_container);
+        root_page_container->ReleaseExclusiveLock();
+        return status_or_new_root_page_container.status();
+    }
 
-        auto new_root_page = reinterpret_cast<BplusTreeInternalPage*>(
-            new_root_page_container->GetData());
-        new_root_page->InitPage(new_root_page_container->GetPageId(),
-                                PageType::PAGE_TYPE_BPLUS_INTERNAL,
-                                INVALID_PAGE_ID);
+    auto new_root_page_container = status_or_new_root_page_container.value();
+    CHECK_NOTNULL(new_root_page_container);
 
-        new_root_page->children_[0] = root_page_id_;
+    new_root_page_container->AquireExclusiveLock();
 
-        auto split_status =
-            SplitChild(new_root_page_container, 0, root_page_container);
-        if (!split_status.ok()) {
-            LOG(ERROR) << "BplusTree::Insert: creating new root page failed";
+    auto new_root_page = reinterpret_cast<BplusTreeInternalPage*>(
+        new_root_page_container->GetData());
+    new_root_page->InitPage(new_root_page_container->GetPageId(),
+                            PageType::PAGE_TYPE_BPLUS_INTERNAL,
+                            INVALID_PAGE_ID);
 
-            new_root_page_container->ReleaseExclusiveLock();
-            root_page_container->ReleaseExclusiveLock();
-            return split_status.status();
-        }
+    new_root_page->SetChild(0, root_page_container->GetPageId());
 
+    auto split_status =
+        SplitChild(new_root_page_container, 0, root_page_container);
+    absl::Status s = split_status.status();
+    if (s.ok()) {
         s = UpdateRoot(new_root_page_container->GetPageId());
-        if (!s.ok()) {
-            LOG(ERROR) << "BplusTree::Insert: updating root failed";
-
-            new_root_page_container->ReleaseExclusiveLock();
-            root_page_container->ReleaseExclusiveLock();
-            return s;
-        }
-
-        buffer_manager_->UnpinPage(root_page_container, /* is_dirty */ true);
-        root_page_container->ReleaseExclusiveLock();
+    }
 
-        s = InsertNonFull(key, value, new_root_page_container);
+    // Writers waiting for the old root notice that it was replaced once they
+    // hold its latch, see GetLatchedRootPage.
+    buffer_manager_->UnpinPage(root_page_container, /* is_dirty */ true);
+    root_page_container->ReleaseExclusiveLock();
+    if (!s.ok()) {
+        LOG(ERROR) << "BplusTree::Insert: creating new root page failed";
 
         buffer_manager_->UnpinPage(new_root_page_container,
                                    /* is_dirty */ true);
         new_root_page_container->ReleaseExclusiveLock();
-    } else {
-        LOG(INFO) << "BplusTree::Insert: root page is non-full";
-        s = InsertNonFull(key, value, root_page_container);
-
-        buffer_manager_->UnpinPage(root_page_container, /* is_dirty */ true);
-        root_page_container->ReleaseExclusiveLock();
+        return s;
     }
 
-    return s;
+    return InsertNonFull(key, value, new_root_page_container,
+                         /* is_dirty */ true);
 }
 
 absl::Status BplusTree::InsertNonFull(absl::string_view key,
                                       absl::string_view value,
-                                      Page* page_container) {
+                                      Page* page_container, bool is_dirty) {
     CHECK_NOTNULL(page_container);
 
-    auto bplus_tree_page =
-        reinterpret_cast<BplusTreePage*>(page_container->GetData());
-    auto page_type = bplus_tree_page->GetPageType();
-    LOG(INFO) << "BplusTree::InsertNonFull: start for page id: "
-              << bplus_tree_page->GetPageId()
-              << " and page_type: " << page_type;
-
-    if (page_type == PageType::PAGE_TYPE_BPLUS_LEAF) {
-        LOG(INFO) << "BplusTree::InsertNonFull: reached the leaf page";
-
-        auto leaf_page =
-            reinterpret_cast<BplusTreeLeafPage*>(page_container->GetData());
-
-        int32_t insert_index = 0;
-        bool duplicate = false;
-        while (insert_index < leaf_page->count_) {
-            int comp = comp_->Compare(
-                key, leaf_page->data_[insert_index].key.GetStringData(
-                         buffer_manager_));
-            if (comp == 0) {
-                duplicate = true;
-                break;
-            } else if (comp == -1) {
-                break;
-            }
-
-            insert_index++;
-        }
-
-        if (!duplicate) {
-            for (int32_t idx = std::max(leaf_page->count_ - 1, 0);
-                 idx >= insert_index; idx--) {
-                leaf_page->data_[idx + 1] = leaf_page->data_[idx];
-            }
+    // Latch crabbing: the child is split before descending into it if it is
+    // full, so a split further down never reaches the page. Its latch is
+    // released as soon as the child is latched and not full.
+    while (true) {
+        auto bplus_tree_page =
+            reinterpret_cast<BplusTreePage*>(page_container->GetData());
+        auto page_type = bplus_tree_page->GetPageType();
+        LOG(INFO) << "BplusTree::InsertNonFull: start for page id: "
+                  << bplus_tree_page->GetPageId()
+                  << " and page_type: " << page_type;
+
+        if (page_type == PageType::PAGE_TYPE_BPLUS_LEAF) {
+            break;
         }
 
-        LOG(INFO) << "BplusTree::InsertNonFull: inserting at index: "
-                  << insert_index;
+        if (page_type != PageType::PAGE_TYPE_BPLUS_INTERNAL) {
+            LOG(ERROR) << "BplusTree::InsertNonFull: unknown page type";
 
-        leaf_page->data_[insert_index].key.SetStringData(buffer_manager_, key);
-        leaf_page->data_[insert_index].value.SetStringData(buffer_manager_,
-                                                           value);
-
-        if (!duplicate) {
-            leaf_page->count_++;
+            buffer_manager_->UnpinPage(page_container, is_dirty);
+            page_container->ReleaseExclusiveLock();
+            return absl::InternalError(
+                "BplusTree::InsertNonFull: unknown page type");
         }
 
-    } else if (page_type == PageType::PAGE_TYPE_BPLUS_INTERNAL) {
         LOG(INFO) << "BplusTree::InsertNonFull: an internal node";
 
         auto internal_page =
             reinterpret_cast<BplusTreeInternalPage*>(page_container->GetData());
 
-        int32_t insert_index = 0;
-        for (; insert_index < internal_page->count_ &&
-               comp_->Compare(key,
-                              internal_page->keys_[insert_index].GetStringData(
-                                  buffer_manager_)) > 0;
-             insert_index++) {
-        }
+        int32_t insert_index = FindChildIndex(key, internal_page);
 
         LOG(INFO)
             << "BplusTree::InsertNonFull: insert index in the internal node is "
             << insert_index;
 
-        auto child_page_id = internal_page->children_[insert_index];
-        auto child_page_container_or_status =
-            buffer_manager_->GetPageWithId(child_page_id);
+        auto child_page_id = internal_page->GetChild(insert_index);
+        auto child_page_container_or_status = buffer_manager_->GetChildPage(
+            page_container, insert_index, child_page_id);
         if (!child_page_container_or_status.ok()) {
             LOG(ERROR) << "BplusTree::InsertNonFull: error while getting child "
                           "page from buffer";
+
+            buffer_manager_->UnpinPage(page_container, is_dirty);
+            page_container->ReleaseExclusiveLock();
             return child_page_container_or_status.status();
         }
 
         auto child_page_container = child_page_container_or_status.value();
         child_page_container->AquireExclusiveLock();
 
-        bool is_full = IsPageFull(child_page_container);
-        if (is_full) {
+        bool child_is_dirty = false;
+        if (IsPageFull(child_page_container)) {
             auto split_status =
                 SplitChild(page_container, insert_index, child_page_container);
             if (!split_status.ok()) {
                 LOG(ERROR)
                     << "BplusTree::InsertNonFull: error while splitting child";
 
+                buffer_manager_->UnpinPage(child_page_container);
                 child_page_container->ReleaseExclusiveLock();
+                buffer_manager_->UnpinPage(page_container, is_dirty);
+                page_container->ReleaseExclusiveLock();
                 return split_status.status();
             }
 
-            if (comp_->Compare(key,
-                               internal_page->keys_[insert_index].GetStringData(
-                                   buffer_manager_)) > 0) {
+            is_dirty = true;
+            child_is_dirty = true;
+            if (CompareKeyAt(comp_, buffer_manager_, key, internal_page,
+                             insert_index) > 0) {
                 insert_index++;
 
                 buffer_manager_->UnpinPage(child_page_container,
@@ -252,11 +255,15 @@ absl::Status BplusTree::InsertNonFull(absl::string_view key,
                 child_page_container->ReleaseExclusiveLock();
 
                 auto updated_child_page_container_or_status =
-                    buffer_manager_->GetPageWithId(
-                        internal_page->children_[insert_index]);
+                    buffer_manager_->GetChildPage(
+                        page_container, insert_index,
+                        internal_page->GetChild(insert_index));
                 if (!updated_child_page_container_or_status.ok()) {
                     LOG(ERROR) << "BplusTree::InsertNonFull: error while "
                                   "changing insert index";
+
+                    buffer_manager_->UnpinPage(page_container, is_dirty);
+                    page_container->ReleaseExclusiveLock();
                     return updated_child_page_container_or_status.status();
                 }
 
@@ -266,21 +273,40 @@ absl::Status BplusTree::InsertNonFull(absl::string_view key,
             }
         }
 
-        auto insert_status = InsertNonFull(key, value, child_page_container);
+        buffer_manager_->UnpinPage(page_container, is_dirty);
+        page_container->ReleaseExclusiveLock();
+        page_container = child_page_container;
+        is_dirty = child_is_dirty;
+    }
 
-        buffer_manager_->UnpinPage(child_page_container, /* is_dirty */ true);
-        child_page_container->ReleaseExclusiveLock();
+    LOG(INFO) << "BplusTree::InsertNonFull: reached the leaf page";
 
-        return insert_status;
-    } else {
-        LOG(ERROR) << "BplusTree::InsertNonFull: unknown page type";
-        return absl::InternalError(
-            "BplusTree::InsertNonFull: unknown page type");
-    }
+    InsertIntoLeaf(key, value, page_container);
 
+    buffer_manager_->UnpinPage(page_container, /* is_dirty */ true);
+    page_container->ReleaseExclusiveLock();
     return absl::OkStatus();
 }
 
+void BplusTree::InsertIntoLeaf(absl::string_view key, absl::string_view value,
+                               Page* page_container) {
+    auto leaf_page =
+        reinterpret_cast<BplusTreeLeafPage*>(page_container->GetData());
+
+    bool duplicate = false;
+    int32_t insert_index = FindLeafIndex(key, leaf_page, &duplicate);
+
+    // the new value can be of another size, so the pair is replaced
+    if (duplicate) {
+        leaf_page->Remove(insert_index);
+    }
+
+    LOG(INFO) << "BplusTree::InsertIntoLeaf: inserting at index: "
+              << insert_index;
+
+    CHECK(leaf_page->Insert(insert_index, key, value, buffer_manager_));
+}
+
 bool BplusTree::IsPageFull(Page* page_container) {
     auto bplus_tree_page =
         reinterpret_cast<BplusTreePage*>(page_container->GetData());
@@ -309,165 +335,470 @@ absl::StatusOr<page_id_t> BplusTree::SplitChild(Page* parent_page_container,
         parent_page_container->GetData());
 
     auto status_or_second_child_page_container =
-        buffer_manager_->AllocateNewPage();
+        SplitPage(child_page_container);
     if (!status_or_second_child_page_container.ok()) {
-        LOG(ERROR) << "BplusTree::SplitChild: error while allocating second "
-                      "child page";
-
+        LOG(ERROR) << "BplusTree::SplitChild: error while splitting child page";
         return status_or_second_child_page_container.status();
     }
 
     auto second_child_page_container =
         status_or_second_child_page_container.value();
+    auto second_child_page_id = second_child_page_container->GetPageId();
 
-    second_child_page_container->AquireExclusiveLock();
+    LOG(INFO) << "BplusTree::SplitChild: Adding second_child_page as child "
+                 "in the parent page";
 
-    auto second_child_page_id = second_child_page_container->GetPageId();
-    bool is_leaf =
-        reinterpret_cast<BplusTreePage*>(child_page_container->GetData())
-            ->GetPageType() == PageType::PAGE_TYPE_BPLUS_LEAF;
+    // add second_child_page as child in the parent page. The high key of
+    // child_page separates it from second_child_page
+    auto child_page =
+        reinterpret_cast<BplusTreePage*>(child_page_container->GetData());
+    CHECK(parent_page->Insert(index, child_page->GetHighKey(buffer_manager_),
+                              second_child_page_id, buffer_manager_));
+
+    child_page->SetParentPageId(parent_page->GetPageId());
+    reinterpret_cast<BplusTreePage*>(second_child_page_container->GetData())
+        ->SetParentPageId(parent_page->GetPageId());
+
+    buffer_manager_->UnpinPage(second_child_page_container,
+                               /* is_dirty */ true);
+    second_child_page_container->ReleaseExclusiveLock();
+
+    return second_child_page_id;
+}
+
+absl::StatusOr<Page*> BplusTree::SplitPage(Page* page_container) {
+    CHECK_NOTNULL(page_container);
+
+    auto status_or_second_page_container = buffer_manager_->AllocateNewPage();
+    if (!status_or_second_page_container.ok()) {
+        LOG(ERROR) << "BplusTree::SplitPage: error while allocating second "
+                      "page";
+
+        return status_or_second_page_container.status();
+    }
+
+    auto second_page_container = status_or_second_page_container.value();
+    second_page_container->AquireExclusiveLock();
+
+    auto second_page_id = second_page_container->GetPageId();
+    bool is_leaf = reinterpret_cast<BplusTreePage*>(page_container->GetData())
+                       ->GetPageType() == PageType::PAGE_TYPE_BPLUS_LEAF;
     if (is_leaf) {
-        LOG(INFO) << "BplusTree::SplitChild: the child node is a leaf";
+        LOG(INFO) << "BplusTree::SplitPage: the page is a leaf";
+
+        auto page =
+            reinterpret_cast<BplusTreeLeafPage*>(page_container->GetData());
+        auto second_page = reinterpret_cast<BplusTreeLeafPage*>(
+            second_page_container->GetData());
+        second_page->InitPage(second_page_id, PageType::PAGE_TYPE_BPLUS_LEAF,
+                              page->GetParentPageId());
+
+        // move the upper half of the pairs by size to second_page. The
+        // separator of the two is the last key left in page, or rather the
+        // shortest key between it and the first key of second_page, which
+        // keeps the internal pages small.
+        auto start_right_half = page->GetSplitIndex();
+        auto separator = page->GetKey(start_right_half - 1, buffer_manager_);
+        if (comp_->IsBytewise()) {
+            separator = ShortestSeparator(
+                separator, page->GetKey(start_right_half, buffer_manager_));
+        }
+        page->MoveCellsTo(start_right_half, second_page);
+        page->CopyPrefixTo(second_page);
+        if (page->GetNextPageId() != INVALID_PAGE_ID) {
+            page->CopyHighKeyTo(second_page);
+        }
+        CHECK(page->SetHighKey(separator, buffer_manager_));
+        CHECK(second_page->SetLowKey(separator, buffer_manager_));
+
+        // link second_page into the leaf chain right after page
+        second_page->SetNextPageId(page->GetNextPageId());
+        page->SetNextPageId(second_page_id);
+
+        // the keys of both pages are closer together than before, and can
+        // share a longer prefix
+        if (comp_->IsBytewise()) {
+            page->UpdatePrefix(buffer_manager_);
+            second_page->UpdatePrefix(buffer_manager_);
+        }
+    } else {
+        LOG(INFO) << "BplusTree::SplitPage: the page is an internal page";
+
+        auto page =
+            reinterpret_cast<BplusTreeInternalPage*>(page_container->GetData());
+        auto second_page = reinterpret_cast<BplusTreeInternalPage*>(
+            second_page_container->GetData());
+        second_page->InitPage(second_page_id,
+                              PageType::PAGE_TYPE_BPLUS_INTERNAL,
+                              page->GetParentPageId());
+
+        // the median key by size moves up and becomes the high key. The
+        // keys right of it move to second_page, together with their
+        // children.
+        auto median_index = page->GetSplitIndex();
+        auto median_key = page->GetKey(median_index, buffer_manager_);
+        second_page->SetChild(0, page->GetChild(median_index + 1));
+        page->MoveCellsTo(median_index + 1, second_page);
+        page->CopyPrefixTo(second_page);
+        if (page->GetRightPageId() != INVALID_PAGE_ID) {
+            page->CopyHighKeyTo(second_page);
+        }
+
+        page->Remove(median_index);
+        CHECK(page->SetHighKey(median_key, buffer_manager_));
+        CHECK(second_page->SetLowKey(median_key, buffer_manager_));
+
+        second_page->SetRightPageId(page->GetRightPageId());
+        page->SetRightPageId(second_page_id);
+
+        if (comp_->IsBytewise()) {
+            page->UpdatePrefix(buffer_manager_);
+            second_page->UpdatePrefix(buffer_manager_);
+        }
+    }
+
+    LOG(INFO) << "BplusTree::SplitPage: split page "
+              << page_container->GetPageId() << " into it and page "
+              << second_page_id;
+
+    return second_page_container;
+}
+
+void BplusTree::InsertIntoInternal(absl::string_view separator,
+                                   page_id_t right_page_id,
+                                   Page* page_container) {
+    auto internal_page =
+        reinterpret_cast<BplusTreeInternalPage*>(page_container->GetData());
 
-        auto child_page = reinterpret_cast<BplusTreeLeafPage*>(
-            child_page_container->GetData());
-        auto second_child_page = reinterpret_cast<BplusTreeLeafPage*>(
-            second_child_page_container->GetData());
-        second_child_page->InitPage(second_child_page_container->GetPageId(),
-                                    PageType::PAGE_TYPE_BPLUS_LEAF,
-                                    parent_page_container->GetPageId());
+    int32_t insert_index = FindChildIndex(separator, internal_page);
 
-        auto total_key_count = BPLUS_LEAF_KEY_VALUE_SIZE;
-        auto start_right_half = total_key_count / 2;
+    CHECK(internal_page->Insert(insert_index, separator, right_page_id,
+                                buffer_manager_));
+}
+
+absl::Status BplusTree::InsertBlink(absl::string_view key,
+                                   absl::string_view value) {
+    std::vector<page_id_t> path;
+    auto page_container_or_status =
+        FindLeafBlink(key, /* exclusive */ true, &path);
+    if (!page_container_or_status.ok()) {
+        LOG(ERROR) << "BplusTree::InsertBlink: finding the leaf failed";
+        return page_container_or_status.status();
+    }
+
+    auto page_container = page_container_or_status.value();
+    if (!IsPageFull(page_container)) {
+        InsertIntoLeaf(key, value, page_container);
+
+        buffer_manager_->UnpinPage(page_container, /* is_dirty */ true);
+        page_container->ReleaseExclusiveLock();
+        return absl::OkStatus();
+    }
+
+    LOG(INFO) << "BplusTree::InsertBlink: leaf is full. splitting it";
+
+    auto second_page_container_or_status = SplitPage(page_container);
+    if (!second_page_container_or_status.ok()) {
+        LOG(ERROR) << "BplusTree::InsertBlink: error while splitting the leaf";
 
-        LOG(INFO) << "BplusTree::SplitChild: Moving half of keys from "
-                     "child_page to second_child_page";
+        buffer_manager_->UnpinPage(page_container);
+        page_container->ReleaseExclusiveLock();
+        return second_page_container_or_status.status();
+    }
+
+    auto second_page_container = second_page_container_or_status.value();
+    auto leaf_page =
+        reinterpret_cast<BplusTreeLeafPage*>(page_container->GetData());
+    auto separator = leaf_page->GetHighKey(buffer_manager_);
+    InsertIntoLeaf(key, value,
+                   comp_->Compare(key, separator) > 0 ? second_page_container
+                                                      : page_container);
+
+    // The key is in place, so the separator is added to the parent without
+    // holding the locks of the leaves.
+    auto left_page_id = page_container->GetPageId();
+    auto right_page_id = second_page_container->GetPageId();
+    buffer_manager_->UnpinPage(second_page_container, /* is_dirty */ true);
+    second_page_container->ReleaseExclusiveLock();
+    buffer_manager_->UnpinPage(page_container, /* is_dirty */ true);
+    page_container->ReleaseExclusiveLock();
+
+    return InsertSeparatorBlink(std::move(separator), left_page_id,
+                                right_page_id, std::move(path));
+}
+
+absl::Status BplusTree::InsertSeparatorBlink(std::string separator,
+                                             page_id_t left_page_id,
+                                             page_id_t right_page_id,
+                                             std::vector<page_id_t> path) {
+    // the level of the split pages, the leaves are at level 0
+    int level = 0;
+    while (true) {
+        if (path.empty()) {
+            auto grown_or_status =
+                GrowRootBlink(separator, left_page_id, right_page_id);
+            if (!grown_or_status.ok() || grown_or_status.value()) {
+                return grown_or_status.status();
+            }
+
+            // The tree grew above the split page since the path was found.
+            // Find the path again and drop the levels below the parent.
+            auto page_container_or_status =
+                FindLeafBlink(separator, /* exclusive */ false, &path);
+            if (!page_container_or_status.ok()) {
+                LOG(ERROR) << "BplusTree::InsertSeparatorBlink: finding the "
+                              "parent failed";
+                return page_container_or_status.status();
+            }
 
-        // move half of keys from child_page to second_child_page
-        for (auto idx = start_right_half; idx < total_key_count; idx++) {
-            second_child_page->data_[idx - start_right_half] =
-                child_page->data_[idx];
+            auto page_container = page_container_or_status.value();
+            buffer_manager_->UnpinPage(page_container);
+            page_container->ReleaseReadLock();
+
+            if (static_cast<int>(path.size()) <= level) {
+                // the writer which split the root didn't grow the tree yet
+                path.clear();
+                std::this_thread::yield();
+                continue;
+            }
+            path.resize(path.size() - level);
         }
 
-        LOG(INFO) << "BplusTree::SplitChild: Adding second_child_page as child "
-                     "in the parent page";
+        auto page_container_or_status =
+            buffer_manager_->GetPageWithId(path.back());
+        path.pop_back();
+        if (!page_container_or_status.ok()) {
+            LOG(ERROR) << "BplusTree::InsertSeparatorBlink: error in reading "
+                          "parent page from buffer pool";
+            return page_container_or_status.status();
+        }
 
-        // add second_child_page as child in the parent page
-        for (int32_t idx = parent_page->count_; idx >= (int32_t)index + 1;
-             idx--) {
-            parent_page->children_[idx + 1] = parent_page->children_[idx];
+        auto page_container = page_container_or_status.value();
+        page_container->AquireExclusiveLock();
+        page_container_or_status =
+            MoveRight(separator, page_container, /* exclusive */ true);
+        if (!page_container_or_status.ok()) {
+            return page_container_or_status.status();
         }
-        parent_page->children_[index + 1] =
-            second_child_page_container->GetPageId();
 
-        // add median key of child_page to parent page. Since the total key
-        // count is even for leaf, we use the lower median.
-        for (int32_t idx = parent_page->count_ - 1; idx >= (int32_t)index;
-             idx--) {
-            parent_page->keys_[idx + 1] = parent_page->keys_[idx];
+        page_container = page_container_or_status.value();
+        if (!IsPageFull(page_container)) {
+            InsertIntoInternal(separator, right_page_id, page_container);
+
+            buffer_manager_->UnpinPage(page_container, /* is_dirty */ true);
+            page_container->ReleaseExclusiveLock();
+            return absl::OkStatus();
         }
-        parent_page->keys_[index] = child_page->data_[start_right_half - 1].key;
 
-        child_page->count_ = total_key_count / 2;
-        second_child_page->count_ = total_key_count / 2;
-        parent_page->count_++;
+        LOG(INFO) << "BplusTree::InsertSeparatorBlink: parent page "
+                  << page_container->GetPageId() << " is full. splitting it";
 
-        LOG(INFO) << "BplusTree::SplitChild: Updating counts in all the three "
-                     "pages. New child_page count: "
-                  << child_page->count_
-                  << " second_child_page count: " << second_child_page->count_
-                  << " parent_page count: " << parent_page->count_;
+        auto second_page_container_or_status = SplitPage(page_container);
+        if (!second_page_container_or_status.ok()) {
+            LOG(ERROR) << "BplusTree::InsertSeparatorBlink: error while "
+                          "splitting the parent";
 
-        child_page->SetParentPageId(parent_page->GetPageId());
-        second_child_page->SetParentPageId(parent_page->GetPageId());
+            buffer_manager_->UnpinPage(page_container);
+            page_container->ReleaseExclusiveLock();
+            return second_page_container_or_status.status();
+        }
 
-        buffer_manager_->UnpinPage(second_child_page_container,
-                                   /* is_dirty */ true);
-    } else {
-        LOG(INFO)
-            << "BplusTree::SplitChild: the child node is an internal node";
+        auto second_page_container = second_page_container_or_status.value();
+        auto internal_page =
+            reinterpret_cast<BplusTreeInternalPage*>(page_container->GetData());
+        auto parent_separator = internal_page->GetHighKey(buffer_manager_);
+        InsertIntoInternal(separator, right_page_id,
+                           comp_->Compare(separator, parent_separator) > 0
+                               ? second_page_container
+                               : page_container);
+
+        separator = std::move(parent_separator);
+        left_page_id = page_container->GetPageId();
+        right_page_id = second_page_container->GetPageId();
+        level++;
+
+        buffer_manager_->UnpinPage(second_page_container, /* is_dirty */ true);
+        second_page_container->ReleaseExclusiveLock();
+        buffer_manager_->UnpinPage(page_container, /* is_dirty */ true);
+        page_container->ReleaseExclusiveLock();
+    }
+}
 
-        auto child_page = reinterpret_cast<BplusTreeInternalPage*>(
-            child_page_container->GetData());
-        auto second_child_page = reinterpret_cast<BplusTreeInternalPage*>(
-            second_child_page_container->GetData());
-        second_child_page->InitPage(second_child_page_container->GetPageId(),
-                                    PageType::PAGE_TYPE_BPLUS_INTERNAL,
-                                    parent_page_container->GetPageId());
+absl::StatusOr<bool> BplusTree::GrowRootBlink(absl::string_view separator,
+                                              page_id_t left_page_id,
+                                              page_id_t right_page_id) {
+    // the root is checked and replaced under mu_, so that only one of the
+    // writers which split the root grows the tree.
+    std::unique_lock l(mu_);
+    if (root_page_id_ != left_page_id) {
+        return false;
+    }
 
-        auto total_key_count = BPLUS_INTERNAL_KEY_PAGE_ID_SIZE;
-        auto start_right_half = total_key_count / 2 + 1;
+    LOG(INFO) << "BplusTree::GrowRootBlink: root page " << left_page_id
+              << " was split. creating new root";
 
-        LOG(INFO) << "BplusTree::SplitChild: Moving half of keys from "
-                     "child_page to second_child_page";
+    auto status_or_new_root_page_container =
+        buffer_manager_->AllocateNewPage();
+    if (!status_or_new_root_page_container.ok()) {
+        LOG(ERROR) << "BplusTree::GrowRootBlink: creating new root page failed";
+        return status_or_new_root_page_container.status();
+    }
+
+    auto new_root_page_container = status_or_new_root_page_container.value();
+    new_root_page_container->AquireExclusiveLock();
+
+    auto new_root_page = reinterpret_cast<BplusTreeInternalPage*>(
+        new_root_page_container->GetData());
+    new_root_page->InitPage(new_root_page_container->GetPageId(),
+                            PageType::PAGE_TYPE_BPLUS_INTERNAL,
+                            INVALID_PAGE_ID);
+    new_root_page->SetChild(0, left_page_id);
+    CHECK(new_root_page->Insert(0, separator, right_page_id, buffer_manager_));
+
+    auto new_root_id = new_root_page_container->GetPageId();
+    buffer_manager_->UnpinPage(new_root_page_container, /* is_dirty */ true);
+    new_root_page_container->ReleaseExclusiveLock();
+
+    auto s = UpdateRootLocked(new_root_id);
+    if (!s.ok()) {
+        return s;
+    }
+    return true;
+}
 
-        // move half of keys from child_page to second_child_page
-        for (auto idx = start_right_half; idx < total_key_count; idx++) {
-            second_child_page->keys_[idx - start_right_half] =
-                child_page->keys_[idx];
+absl::StatusOr<Page*> BplusTree::FindLeafBlink(absl::string_view key,
+                                               bool exclusive,
+                                               std::vector<page_id_t>* path) {
+    auto page_container_or_status = GetLatchedRootPage(/* exclusive */ false);
+    while (true) {
+        if (!page_container_or_status.ok()) {
+            LOG(ERROR) << "BplusTree::FindLeafBlink: error in reading page "
+                          "from buffer pool";
+            return page_container_or_status.status();
         }
 
-        // move half of the child page ids to the second_child_page
-        for (auto idx = start_right_half + 1; idx <= total_key_count; idx++) {
-            second_child_page->children_[idx - start_right_half - 1] =
-                child_page->children_[idx];
+        page_container_or_status = MoveRight(
+            key, page_container_or_status.value(), /* exclusive */ false);
+        if (!page_container_or_status.ok()) {
+            return page_container_or_status.status();
         }
 
-        LOG(INFO) << "BplusTree::SplitChild: Adding second_child_page as child "
-                     "in the parent page";
+        auto page_container = page_container_or_status.value();
+        if (reinterpret_cast<BplusTreePage*>(page_container->GetData())
+                ->GetPageType() != PageType::PAGE_TYPE_BPLUS_INTERNAL) {
+            break;
+        }
+
+        auto internal_page =
+            reinterpret_cast<BplusTreeInternalPage*>(page_container->GetData());
+        auto idx = FindChildIndex(key, internal_page);
 
-        // add second_child_page as child in the parent page
-        for (auto idx = parent_page->count_; idx >= index + 1; idx--) {
-            parent_page->children_[idx + 1] = parent_page->children_[idx];
+        if (path != nullptr) {
+            path->push_back(page_container->GetPageId());
         }
-        parent_page->children_[index] =
-            second_child_page_container->GetPageId();
 
-        // add median key of child_page to parent page
-        for (auto idx = parent_page->count_ - 1; idx >= index; idx--) {
-            parent_page->keys_[idx + 1] = parent_page->keys_[idx];
+        // The parent is let go before the child is locked. If the child is
+        // split in between, the key is found by moving right.
+        page_container_or_status = buffer_manager_->GetChildPage(
+            page_container, idx, internal_page->GetChild(idx));
+        buffer_manager_->UnpinPage(page_container);
+        page_container->ReleaseReadLock();
+        if (page_container_or_status.ok()) {
+            page_container_or_status.value()->AquireReadLock();
         }
-        parent_page->keys_[index] = child_page->keys_[start_right_half - 1];
+    }
 
-        LOG(INFO)
-            << "BplusTree::SplitChild: Updating counts in all the three pages";
+    auto page_container = page_container_or_status.value();
+    if (!exclusive) {
+        return page_container;
+    }
 
-        child_page->count_ = total_key_count / 2;
-        second_child_page->count_ = total_key_count / 2;
-        parent_page->count_++;
+    page_container->ReleaseReadLock();
+    page_container->AquireExclusiveLock();
+    return MoveRight(key, page_container, /* exclusive */ true);
+}
 
-        buffer_manager_->UnpinPage(second_child_page_container,
-                                   /* is_dirty */ true);
-    }
+absl::StatusOr<Page*> BplusTree::MoveRight(absl::string_view key,
+                                           Page* page_container,
+                                           bool exclusive) {
+    while (true) {
+        auto page = reinterpret_cast<BplusTreePage*>(page_container->GetData());
+        auto right_page_id = page->GetRightPageId();
+        if (right_page_id == INVALID_PAGE_ID ||
+            CompareHighKey(comp_, buffer_manager_, key, page) <= 0) {
+            return page_container;
+        }
 
-    second_child_page_container->ReleaseExclusiveLock();
+        LOG(INFO) << "BplusTree::MoveRight: moving right from page "
+                  << page_container->GetPageId() << " to page "
+                  << right_page_id;
+
+        auto right_page_container_or_status =
+            buffer_manager_->GetPageWithId(right_page_id);
+        buffer_manager_->UnpinPage(page_container);
+        if (exclusive) {
+            page_container->ReleaseExclusiveLock();
+        } else {
+            page_container->ReleaseReadLock();
+        }
 
-    return second_child_page_id;
+        if (!right_page_container_or_status.ok()) {
+            LOG(ERROR) << "BplusTree::MoveRight: error in reading right page "
+                          "from buffer pool";
+            return right_page_container_or_status.status();
+        }
+
+        page_container = right_page_container_or_status.value();
+        if (exclusive) {
+            page_container->AquireExclusiveLock();
+        } else {
+            page_container->AquireReadLock();
+        }
+    }
 }
 
 absl::Status BplusTree::Delete(const WriteOptions& options,
                                absl::string_view key) {
-    CHECK_NE(root_page_id_, INVALID_PAGE_ID);
+    CHECK_NE(root_page_id_.load(), INVALID_PAGE_ID);
     LOG(INFO) << "BplusTree::Delete: Init";
     LOG(INFO) << key;
 
+    for (int attempt = 0; attempt < OPTIMISTIC_WRITE_MAX_ATTEMPTS; attempt++) {
+        auto s = DeleteOptimistic(key);
+        if (absl::IsFailedPrecondition(s)) {
+            break;
+        }
+        if (!absl::IsAborted(s)) {
+            return s;
+        }
+    }
+
+    if (blink_) {
+        auto page_container_or_status =
+            FindLeafBlink(key, /* exclusive */ true, /* path */ nullptr);
+        if (!page_container_or_status.ok()) {
+            LOG(ERROR) << "BplusTree::Delete: finding the leaf failed";
+            return page_container_or_status.status();
+        }
+
+        auto page_container = page_container_or_status.value();
+        auto s = DeleteFromLeaf(key, page_container);
+        buffer_manager_->UnpinPage(page_container, /* is_dirty */ s.ok());
+        page_container->ReleaseExclusiveLock();
+        return s;
+    }
+
+    LOG(INFO) << "BplusTree::Delete: optimistic delete failed. crabbing "
+                 "down with exclusive locks";
+
     auto status_or_root_page_container =
-        buffer_manager_->GetPageWithId(root_page_id_);
+        GetLatchedRootPage(/* exclusive */ true);
     if (!status_or_root_page_container.ok()) {
         LOG(ERROR) << "BplusTree::Delete: getting root page id failed";
         return status_or_root_page_container.status();
     }
 
-    auto root_page_container = status_or_root_page_container.value();
-    CHECK_NOTNULL(root_page_container);
-
-    root_page_container->AquireExclusiveLock();
-
-    auto deletion_status = DeleteFromPage(key, root_page_container);
-
-    buffer_manager_->UnpinPage(root_page_container, /* is_dirty */ true);
-    root_page_container->ReleaseExclusiveLock();
-    return deletion_status;
+    return DeleteFromPage(key, status_or_root_page_container.value());
 }
 
 absl::Status BplusTree::DeleteFromPage(absl::string_view key,
@@ -476,104 +807,141 @@ absl::Status BplusTree::DeleteFromPage(absl::string_view key,
     LOG(INFO) << "BplusTree::DeleteFromPage: Init";
     LOG(INFO) << key;
 
-    auto bplus_tree_page =
-        reinterpret_cast<BplusTreePage*>(page_container->GetData());
-    auto page_type = bplus_tree_page->GetPageType();
-    LOG(INFO) << "BplusTree::DeleteFromPage: start for page id: "
-              << bplus_tree_page->GetPageId()
-              << " and page_type: " << page_type;
-
-    if (page_type == PageType::PAGE_TYPE_BPLUS_LEAF) {
-        LOG(INFO) << "BplusTree::DeleteFromPage: reached the leaf page";
-
-        auto leaf_page =
-            reinterpret_cast<BplusTreeLeafPage*>(page_container->GetData());
-
-        int32_t deletion_index = 0;
-        bool exists = false;
-        while (deletion_index < leaf_page->count_) {
-            int comp = comp_->Compare(
-                key, leaf_page->data_[deletion_index].key.GetStringData(
-                         buffer_manager_));
-            if (comp == 0) {
-                exists = true;
-                break;
-            } else if (comp == -1) {
-                break;
-            }
-
-            deletion_index++;
+    // Latch crabbing: the latched ancestors of the page which a rebalance
+    // after the deletion can reach, with the index of the child taken in
+    // each. They are released as soon as a child is safe, i.e. doesn't
+    // become underfull when an entry is removed from it.
+    std::vector<std::pair<Page*, int32_t>> path;
+    absl::Status s;
+    while (true) {
+        auto bplus_tree_page =
+            reinterpret_cast<BplusTreePage*>(page_container->GetData());
+        auto page_type = bplus_tree_page->GetPageType();
+        LOG(INFO) << "BplusTree::DeleteFromPage: start for page id: "
+                  << bplus_tree_page->GetPageId()
+                  << " and page_type: " << page_type;
+
+        if (page_type == PageType::PAGE_TYPE_BPLUS_LEAF) {
+            break;
         }
 
-        if (!exists) {
-            LOG(ERROR) << "BplusTree::DeleteFromPage: key - " << key
-                       << " not found in the database";
-            return absl::NotFoundError("Key not found in the database");
+        if (page_type != PageType::PAGE_TYPE_BPLUS_INTERNAL) {
+            LOG(ERROR) << "BplusTree::DeleteFromPage: unknown page type";
+            s = absl::InternalError(
+                "BplusTree::DeleteFromPage: unknown page type");
+            break;
         }
 
-        LOG(INFO) << "BplusTree::DeleteFromPage: deleting from index: "
-                  << deletion_index;
-
-        for (int idx = deletion_index; idx < leaf_page->count_ - 1; idx++) {
-            leaf_page->data_[idx] = leaf_page->data_[idx + 1];
-        }
-        leaf_page->count_--;
-    } else if (page_type == PageType::PAGE_TYPE_BPLUS_INTERNAL) {
         LOG(INFO) << "BplusTree::DeleteFromPage: an internal node";
 
         auto internal_page =
             reinterpret_cast<BplusTreeInternalPage*>(page_container->GetData());
 
-        int32_t deletion_index = 0;
-        for (; deletion_index < internal_page->count_ &&
-               comp_->Compare(
-                   key, internal_page->keys_[deletion_index].GetStringData(
-                            buffer_manager_)) > 0;
-             deletion_index++) {
-        }
+        int32_t deletion_index = FindChildIndex(key, internal_page);
 
         LOG(INFO)
             << "BplusTree::DeleteFromPage: deletion index in the internal "
                "node is "
             << deletion_index;
 
-        auto child_page_id = internal_page->children_[deletion_index];
-        auto child_page_container_or_status =
-            buffer_manager_->GetPageWithId(child_page_id);
+        auto child_page_id = internal_page->GetChild(deletion_index);
+        auto child_page_container_or_status = buffer_manager_->GetChildPage(
+            page_container, deletion_index, child_page_id);
         if (!child_page_container_or_status.ok()) {
             LOG(ERROR)
                 << "BplusTree::DeleteFromPage: error while getting child "
                    "page from buffer";
-            return child_page_container_or_status.status();
+            s = child_page_container_or_status.status();
+            break;
         }
 
         auto child_page_container = child_page_container_or_status.value();
         child_page_container->AquireExclusiveLock();
 
-        auto deletion_status = DeleteFromPage(key, child_page_container);
-        if (!deletion_status.ok()) {
-            return deletion_status;
+        path.emplace_back(page_container, deletion_index);
+        if (IsPageSafeForDelete(child_page_container)) {
+            for (auto [ancestor_page_container, index] : path) {
+                buffer_manager_->UnpinPage(ancestor_page_container);
+                ancestor_page_container->ReleaseExclusiveLock();
+            }
+            path.clear();
         }
+        page_container = child_page_container;
+    }
+
+    if (s.ok()) {
+        LOG(INFO) << "BplusTree::DeleteFromPage: reached the leaf page";
+        s = DeleteFromLeaf(key, page_container);
+    }
 
-        if (IsPageLessThanHalfFull(child_page_container)) {
-            auto borror_or_merge_status = BorrowOrMergeChild(
-                page_container, deletion_index, child_page_container);
-            if (!borror_or_merge_status.ok()) {
+    // rebalance the pages which became underfull, bottom up
+    bool is_dirty = s.ok();
+    while (!path.empty()) {
+        auto [parent_page_container, index] = path.back();
+        path.pop_back();
+
+        bool parent_is_dirty = false;
+        if (s.ok() && IsPageUnderfull(page_container)) {
+            s = BorrowOrMergeChild(parent_page_container, index,
+                                   page_container);
+            if (!s.ok()) {
                 LOG(ERROR)
                     << "BplusTree::DeleteFromPage: error while borrow_or_merge "
                        "operation";
-                return borror_or_merge_status;
             }
+            is_dirty = true;
+            parent_is_dirty = true;
         }
 
-        buffer_manager_->UnpinPage(child_page_container, /* is_dirty */ true);
-        child_page_container->ReleaseExclusiveLock();
-    } else {
-        LOG(ERROR) << "BplusTree::DeleteFromPage: unknown page type";
-        return absl::InternalError(
-            "BplusTree::DeleteFromPage: unknown page type");
+        buffer_manager_->UnpinPage(page_container, is_dirty);
+        page_container->ReleaseExclusiveLock();
+        page_container = parent_page_container;
+        is_dirty = parent_is_dirty;
+    }
+
+    // The root is left with a single child once its last two children were
+    // merged. The child becomes the root instead, which shrinks the tree.
+    // Writers waiting for the old root notice that it was replaced once they
+    // hold its latch, see GetLatchedRootPage.
+    auto top_page = reinterpret_cast<BplusTreeInternalPage*>(
+        page_container->GetData());
+    if (s.ok() && top_page->GetPageType() == PAGE_TYPE_BPLUS_INTERNAL &&
+        top_page->GetCount() == 0 &&
+        root_page_id_ == page_container->GetPageId()) {
+        LOG(INFO) << "BplusTree::DeleteFromPage: replacing the root by its "
+                     "only child";
+
+        s = UpdateRoot(top_page->GetChild(0));
+        if (s.ok()) {
+            FreePage(page_container);
+            is_dirty = true;
+        }
+    }
+
+    buffer_manager_->UnpinPage(page_container, is_dirty);
+    page_container->ReleaseExclusiveLock();
+    return s;
+}
+
+absl::Status BplusTree::DeleteFromLeaf(absl::string_view key,
+                                       Page* page_container) {
+    auto leaf_page =
+        reinterpret_cast<BplusTreeLeafPage*>(page_container->GetData());
+
+    bool exists = false;
+    int32_t deletion_index = FindLeafIndex(key, leaf_page, &exists);
+
+    if (!exists) {
+        LOG(ERROR) << "BplusTree::DeleteFromLeaf: key - " << key
+                   << " not found in the database";
+        return absl::NotFoundError("Key not found in the database");
     }
 
+    LOG(INFO) << "BplusTree::DeleteFromLeaf: deleting from index: "
+              << deletion_index;
+
+    leaf_page->Remove(deletion_index);
+
     return absl::OkStatus();
 }
 
@@ -589,50 +957,325 @@ absl::Status BplusTree::BorrowOrMergeChild(Page* parent_page_container,
 
     auto parent_page = reinterpret_cast<BplusTreeInternalPage*>(
         parent_page_container->GetData());
+    if (parent_page->GetCount() == 0) {
+        LOG(INFO) << "BplusTree::BorrowOrMergeChild: the child has no "
+                     "sibling";
+        return absl::OkStatus();
+    }
 
     bool is_leaf =
         reinterpret_cast<BplusTreePage*>(child_page_container->GetData())
             ->GetPageType() == PageType::PAGE_TYPE_BPLUS_LEAF;
 
-    Page* sibling_page_container = nullptr;
-    if (index > 0) {
-        auto status_or_left_sibling_page_container =
-            buffer_manager_->GetPageWithId(parent_page->children_[index - 1]);
-        if (!status_or_left_sibling_page_container.ok()) {
-            return status_or_left_sibling_page_container.status();
+    // Siblings are latched after the child while the parent is latched, so
+    // no other writer can reach them the other way around. Readers latch one
+    // leaf at a time.
+    int32_t sibling_index = index > 0 ? index - 1 : index + 1;
+    auto status_or_sibling_page_container = buffer_manager_->GetChildPage(
+        parent_page_container, sibling_index,
+        parent_page->GetChild(sibling_index));
+    if (!status_or_sibling_page_container.ok()) {
+        LOG(ERROR) << "BplusTree::BorrowOrMergeChild: error while getting "
+                      "sibling page from buffer";
+        return status_or_sibling_page_container.status();
+    }
+
+    auto sibling_page_container = status_or_sibling_page_container.value();
+    sibling_page_container->AquireExclusiveLock();
+
+    auto left_index = std::min(index, sibling_index);
+    auto left_page_container =
+        index > 0 ? sibling_page_container : child_page_container;
+    auto right_page_container =
+        index > 0 ? child_page_container : sibling_page_container;
+
+    // merge if the two fit into one page, which leaves room for inserts.
+    // Otherwise the sibling is full enough to share its entries.
+    bool is_dirty = true;
+    if (MergeChild(parent_page_container, left_index, left_page_container,
+                   right_page_container, is_leaf)) {
+        LOG(INFO) << "BplusTree::BorrowOrMergeChild: merged page "
+                  << right_page_container->GetPageId() << " into page "
+                  << left_page_container->GetPageId();
+    } else if (BorrowChild(parent_page_container, left_index,
+                           left_page_container, right_page_container,
+                           is_leaf)) {
+        LOG(INFO) << "BplusTree::BorrowOrMergeChild: redistributed pages "
+                  << left_page_container->GetPageId() << " and "
+                  << right_page_container->GetPageId();
+    } else {
+        LOG(INFO) << "BplusTree::BorrowOrMergeChild: unable to rebalance "
+                     "page "
+                  << child_page_container->GetPageId();
+        is_dirty = false;
+    }
+
+    buffer_manager_->UnpinPage(sibling_page_container, is_dirty);
+    sibling_page_container->ReleaseExclusiveLock();
+    return absl::OkStatus();
+}
+
+bool BplusTree::MergeChild(Page* parent_page_container, int32_t index,
+                           Page* left_child, Page* right_child, bool is_leaf) {
+    auto parent_page = reinterpret_cast<BplusTreeInternalPage*>(
+        parent_page_container->GetData());
+    auto left_page = reinterpret_cast<BplusTreePage*>(left_child->GetData());
+    auto right_page = reinterpret_cast<BplusTreePage*>(right_child->GetData());
+    auto separator = parent_page->GetKey(index, buffer_manager_);
+
+    // the merged page is built aside, since its keys can grow with the
+    // prefix of the wider fences
+    alignas(BplusTreePage) char data[PAGE_SIZE];
+    auto page = StartRebuiltPage(data, left_page);
+    left_page->CopyLowKeyTo(page);
+    page->SetRightPageId(right_page->GetRightPageId());
+    if (right_page->GetRightPageId() != INVALID_PAGE_ID) {
+        right_page->CopyHighKeyTo(page);
+    }
+    UpdatePagePrefix(page);
+
+    int32_t count =
+        left_page->GetCount() + right_page->GetCount() + (is_leaf ? 0 : 1);
+    if (!is_leaf) {
+        auto internal_page = reinterpret_cast<BplusTreeInternalPage*>(page);
+        internal_page->SetChild(
+            0,
+            reinterpret_cast<BplusTreeInternalPage*>(left_page)->GetChild(0));
+    }
+    if (!CopyEntries(page, left_page, right_page, separator, 0, count,
+                     is_leaf)) {
+        return false;
+    }
+
+    bool is_full =
+        is_leaf ? reinterpret_cast<BplusTreeLeafPage*>(page)->IsFull()
+                : reinterpret_cast<BplusTreeInternalPage*>(page)->IsFull();
+    if (is_full) {
+        return false;
+    }
+
+    memcpy(left_child->GetData(), data, PAGE_SIZE);
+    parent_page->Remove(index);
+    FreePage(right_child);
+    return true;
+}
+
+bool BplusTree::BorrowChild(Page* parent_page_container, int32_t index,
+                            Page* left_child, Page* right_child,
+                            bool is_leaf) {
+    auto parent_page = reinterpret_cast<BplusTreeInternalPage*>(
+        parent_page_container->GetData());
+    auto left_page = reinterpret_cast<BplusTreePage*>(left_child->GetData());
+    auto right_page = reinterpret_cast<BplusTreePage*>(right_child->GetData());
+    auto separator = parent_page->GetKey(index, buffer_manager_);
+
+    int32_t left_count = left_page->GetCount();
+    int32_t middle = is_leaf ? 0 : 1;
+    int32_t count = left_count + middle + right_page->GetCount();
+    auto entry_size = [&](int32_t idx) -> int {
+        if (idx < left_count) {
+            return left_page->Slots()[idx].size;
+        }
+        if (idx < left_count + middle) {
+            return sizeof(page_id_t) + BplusTreePage::GetStringSize(separator);
+        }
+        return right_page->Slots()[idx - left_count - middle].size;
+    };
+    auto entry_key = [&](int32_t idx) {
+        if (idx < left_count) {
+            return is_leaf ? reinterpret_cast<BplusTreeLeafPage*>(left_page)
+                                 ->GetKey(idx, buffer_manager_)
+                           : reinterpret_cast<BplusTreeInternalPage*>(
+                                 left_page)
+                                 ->GetKey(idx, buffer_manager_);
+        }
+        if (idx < left_count + middle) {
+            return separator;
         }
+        idx -= left_count + middle;
+        return is_leaf ? reinterpret_cast<BplusTreeLeafPage*>(right_page)
+                             ->GetKey(idx, buffer_manager_)
+                       : reinterpret_cast<BplusTreeInternalPage*>(right_page)
+                             ->GetKey(idx, buffer_manager_);
+    };
+
+    // the entries before split go to the left page. Both pages keep at
+    // least one entry, and an internal split entry moves up to the parent.
+    if (count < 2 + middle) {
+        return false;
+    }
+    int total = 0;
+    for (int32_t idx = 0; idx < count; idx++) {
+        total += entry_size(idx);
+    }
+    int32_t split = 0;
+    for (int size = 0; size < total / 2 && split < count - 1 - middle;) {
+        size += entry_size(split++);
+    }
+    split = std::max(split, 1);
 
-        sibling_page_container = status_or_left_sibling_page_container.value();
+    // the separator of two leaves is the shortest key between them, see
+    // SplitPage
+    std::string new_separator;
+    page_id_t right_first_child = INVALID_PAGE_ID;
+    if (is_leaf) {
+        new_separator = entry_key(split - 1);
+        if (comp_->IsBytewise()) {
+            new_separator = ShortestSeparator(new_separator, entry_key(split));
+        }
     } else {
-        auto status_or_right_sibling_page_container =
-            buffer_manager_->GetPageWithId(parent_page->children_[index + 1]);
-        if (!status_or_right_sibling_page_container.ok()) {
-            return status_or_right_sibling_page_container.status();
+        new_separator = entry_key(split);
+        right_first_child =
+            split < left_count
+                ? reinterpret_cast<BplusTreeInternalPage*>(left_page)
+                      ->GetChild(split + 1)
+                : reinterpret_cast<BplusTreeInternalPage*>(right_page)
+                      ->GetChild(split - left_count);
+    }
+
+    // the parent MUST fit the new separator in place of the old one
+    int grown_size = sizeof(page_id_t) +
+                     BplusTreePage::GetKeySize(
+                         new_separator, parent_page->GetPrefix().size()) -
+                     parent_page->Slots()[index].size;
+    if (grown_size > parent_page->GetFreeSpace()) {
+        return false;
+    }
+
+    alignas(BplusTreePage) char left_data[PAGE_SIZE];
+    auto new_left_page = StartRebuiltPage(left_data, left_page);
+    left_page->CopyLowKeyTo(new_left_page);
+    new_left_page->SetRightPageId(right_page->GetPageId());
+    CHECK(new_left_page->SetHighKey(new_separator, buffer_manager_));
+    UpdatePagePrefix(new_left_page);
+
+    alignas(BplusTreePage) char right_data[PAGE_SIZE];
+    auto new_right_page = StartRebuiltPage(right_data, right_page);
+    CHECK(new_right_page->SetLowKey(new_separator, buffer_manager_));
+    new_right_page->SetRightPageId(right_page->GetRightPageId());
+    if (right_page->GetRightPageId() != INVALID_PAGE_ID) {
+        right_page->CopyHighKeyTo(new_right_page);
+    }
+    UpdatePagePrefix(new_right_page);
+
+    if (!is_leaf) {
+        reinterpret_cast<BplusTreeInternalPage*>(new_left_page)
+            ->SetChild(0, reinterpret_cast<BplusTreeInternalPage*>(left_page)
+                              ->GetChild(0));
+        reinterpret_cast<BplusTreeInternalPage*>(new_right_page)
+            ->SetChild(0, right_first_child);
+    }
+    if (!CopyEntries(new_left_page, left_page, right_page, separator, 0,
+                     split, is_leaf) ||
+        !CopyEntries(new_right_page, left_page, right_page, separator,
+                     split + middle, count, is_leaf)) {
+        return false;
+    }
+
+    memcpy(left_child->GetData(), left_data, PAGE_SIZE);
+    memcpy(right_child->GetData(), right_data, PAGE_SIZE);
+    parent_page->Remove(index);
+    CHECK(parent_page->Insert(index, new_separator,
+                              right_child->GetPageId(), buffer_manager_));
+    return true;
+}
+
+bool BplusTree::CopyEntries(BplusTreePage* page, BplusTreePage* left_page,
+                            BplusTreePage* right_page,
+                            absl::string_view separator, int32_t start,
+                            int32_t end, bool is_leaf) {
+    int key_offset = is_leaf ? 0 : sizeof(page_id_t);
+    int32_t left_count = left_page->GetCount();
+    int32_t middle = is_leaf ? 0 : 1;
+
+    if (start < left_count &&
+        !page->CopyCellsFrom(left_page, start, std::min(end, left_count),
+                             key_offset, buffer_manager_)) {
+        return false;
+    }
+
+    if (!is_leaf && start <= left_count && left_count < end) {
+        auto right_first_child =
+            reinterpret_cast<BplusTreeInternalPage*>(right_page)->GetChild(0);
+        if (!reinterpret_cast<BplusTreeInternalPage*>(page)->Insert(
+                page->GetCount(), separator, right_first_child,
+                buffer_manager_)) {
+            return false;
         }
+    }
 
-        sibling_page_container = status_or_right_sibling_page_container.value();
+    auto right_start = std::max(start - left_count - middle, 0);
+    auto right_end = end - left_count - middle;
+    return right_start >= right_end ||
+           page->CopyCellsFrom(right_page, right_start, right_end, key_offset,
+                               buffer_manager_);
+}
+
+BplusTreePage* BplusTree::StartRebuiltPage(char* data, BplusTreePage* page) {
+    if (page->GetPageType() == PageType::PAGE_TYPE_BPLUS_LEAF) {
+        auto leaf_page = reinterpret_cast<BplusTreeLeafPage*>(data);
+        leaf_page->InitPage(page->GetPageId(), PageType::PAGE_TYPE_BPLUS_LEAF,
+                            page->GetParentPageId());
+        return leaf_page;
     }
-    sibling_page_container->AquireExclusiveLock();
 
-    // if sibling is also less than half full, time to merge
-    // otherwise borrow
-    bool should_merge = IsPageLessThanHalfFull(sibling_page_container);
-    if (should_merge) {
+    auto internal_page = reinterpret_cast<BplusTreeInternalPage*>(data);
+    internal_page->InitPage(page->GetPageId(),
+                            PageType::PAGE_TYPE_BPLUS_INTERNAL,
+                            page->GetParentPageId());
+    return internal_page;
+}
+
+void BplusTree::UpdatePagePrefix(BplusTreePage* page) {
+    if (!comp_->IsBytewise()) {
+        return;
+    }
+
+    // the page has no keys yet, so the prefix always fits
+    if (page->GetPageType() == PageType::PAGE_TYPE_BPLUS_LEAF) {
+        CHECK(reinterpret_cast<BplusTreeLeafPage*>(page)->UpdatePrefix(
+            buffer_manager_));
     } else {
+        CHECK(reinterpret_cast<BplusTreeInternalPage*>(page)->UpdatePrefix(
+            buffer_manager_));
     }
+}
 
-    buffer_manager_->UnpinPage(sibling_page_container, /* is_dirty */ true);
-    sibling_page_container->ReleaseExclusiveLock();
-    return absl::OkStatus();
+void BplusTree::FreePage(Page* page_container) {
+    auto page_id = page_container->GetPageId();
+    LOG(INFO) << "BplusTree::FreePage: page " << page_id
+              << " is removed from the tree";
+
+    reinterpret_cast<BplusTreePage*>(page_container->GetData())
+        ->InitPage(page_id, PageType::PAGE_TYPE_INVALID, INVALID_PAGE_ID,
+                   sizeof(BplusTreePage));
+
+    std::unique_lock l(freed_mu_);
+    freed_page_ids_.push_back(page_id);
 }
 
-absl::Status BplusTree::MergeChild(Page* parent_page, int32_t index,
-                                   Page* left_child, Page* right_child,
-                                   bool is_leaf) {
-    return absl::OkStatus();
+std::vector<page_id_t> BplusTree::TakeFreedPageIds() {
+    std::unique_lock l(freed_mu_);
+    std::vector<page_id_t> freed_page_ids;
+    freed_page_ids.swap(freed_page_ids_);
+    return freed_page_ids;
+}
+
+bool BplusTree::IsPageUnderfull(Page* page_container) {
+    auto bplus_tree_page =
+        reinterpret_cast<BplusTreePage*>(page_container->GetData());
+    auto page_type = bplus_tree_page->GetPageType();
+
+    if (page_type == PageType::PAGE_TYPE_BPLUS_INTERNAL) {
+        return reinterpret_cast<BplusTreeInternalPage*>(
+                   page_container->GetData())
+            ->IsUnderfull();
+    }
+    return reinterpret_cast<BplusTreeLeafPage*>(page_container->GetData())
+        ->IsUnderfull();
 }
 
-bool BplusTree::IsPageLessThanHalfFull(Page* page_container) {
+bool BplusTree::IsPageSafeForDelete(Page* page_container) {
     auto bplus_tree_page =
         reinterpret_cast<BplusTreePage*>(page_container->GetData());
     auto page_type = bplus_tree_page->GetPageType();
@@ -640,125 +1283,499 @@ bool BplusTree::IsPageLessThanHalfFull(Page* page_container) {
     if (page_type == PageType::PAGE_TYPE_BPLUS_INTERNAL) {
         return reinterpret_cast<BplusTreeInternalPage*>(
                    page_container->GetData())
-            ->IsLessThanHalfFull();
+            ->IsSafeForDelete();
     }
     return reinterpret_cast<BplusTreeLeafPage*>(page_container->GetData())
-        ->IsLessThanHalfFull();
+        ->IsSafeForDelete();
 }
 
-absl::StatusOr<absl::string_view> BplusTree::Get(const ReadOptions& options,
-                                                 absl::string_view key) {
-    CHECK_NE(root_page_id_, INVALID_PAGE_ID);
+absl::StatusOr<std::string> BplusTree::Get(const ReadOptions& options,
+                                           absl::string_view key) {
+    CHECK_NE(root_page_id_.load(), INVALID_PAGE_ID);
     LOG(INFO) << "BplusTree::Get: Init";
     LOG(INFO) << key;
 
+    for (int attempt = 0; attempt < OPTIMISTIC_READ_MAX_ATTEMPTS; attempt++) {
+        auto res = GetOptimistic(key);
+        if (!absl::IsAborted(res.status())) {
+            return res;
+        }
+    }
+
+    if (blink_) {
+        auto page_container_or_status =
+            FindLeafBlink(key, /* exclusive */ false, /* path */ nullptr);
+        if (!page_container_or_status.ok()) {
+            LOG(ERROR) << "BplusTree::Get: finding the leaf failed";
+            return page_container_or_status.status();
+        }
+
+        auto page_container = page_container_or_status.value();
+        auto res = GetFromLeaf(key, page_container);
+        buffer_manager_->UnpinPage(page_container);
+        page_container->ReleaseReadLock();
+        return res;
+    }
+
+    LOG(INFO) << "BplusTree::Get: optimistic reads failed. read locking the "
+                 "path";
+
     auto status_or_root_page_container =
-        buffer_manager_->GetPageWithId(root_page_id_);
+        GetLatchedRootPage(/* exclusive */ false);
     if (!status_or_root_page_container.ok()) {
         LOG(ERROR) << "BplusTree::Get: getting root page id failed";
         return status_or_root_page_container.status();
     }
 
-    auto root_page_container = status_or_root_page_container.value();
-    CHECK_NOTNULL(root_page_container);
+    return GetFromPage(key, status_or_root_page_container.value());
+}
 
-    auto res = GetFromPage(key, root_page_container);
+absl::StatusOr<Page*> BplusTree::FindLeafOptimistic(absl::string_view key,
+                                                    uint64_t* version) {
+    auto aborted =
+        absl::AbortedError("BplusTree::FindLeafOptimistic: restart");
+
+    page_id_t page_id = root_page_id_;
+    Page* parent_page_container = nullptr;
+    uint64_t parent_version = 0;
+    int parent_slot = 0;
+
+    Page* page_container = nullptr;
+    bool pinned = false;
+    bool moved_right = false;
+    while (true) {
+        // pin the page if it isn't cached to read it from disk, but still
+        // read it optimistically.
+        pinned = false;
+        page_container =
+            parent_page_container == nullptr || moved_right
+                ? buffer_manager_->GetPageForOptimisticRead(page_id)
+                : buffer_manager_->GetChildPageForOptimisticRead(
+                      parent_page_container, parent_slot, page_id);
+        if (page_container == nullptr) {
+            auto page_container_or_status =
+                buffer_manager_->GetPageWithId(page_id);
+            if (!page_container_or_status.ok()) {
+                LOG(ERROR) << "BplusTree::FindLeafOptimistic: error in "
+                              "reading page from buffer pool";
+                return page_container_or_status.status();
+            }
 
-    buffer_manager_->UnpinPage(root_page_container);
+            page_container = page_container_or_status.value();
+            pinned = true;
+        }
+
+        // The parent must be unchanged since the child id was read from it
+        // and the root must still be the root. Both are checked after the
+        // read of the child started, which couples the two reads. After
+        // moving right, the left page takes the place of the parent.
+        bool valid = page_container->StartOptimisticRead(version) &&
+                     page_container->GetPageId() == page_id;
+        if (parent_page_container == nullptr) {
+            valid = valid && root_page_id_ == page_id;
+        } else {
+            valid = valid && parent_page_container->ValidateOptimisticRead(
+                                 parent_version);
+        }
+
+        // In a B-link tree, the key may have moved to the right page by a
+        // split which isn't in the parent yet.
+        moved_right = false;
+        auto page = reinterpret_cast<BplusTreePage*>(page_container->GetData());
+        if (valid && blink_) {
+            auto right_page_id = page->GetRightPageId();
+            absl::string_view stored_key;
+            if (right_page_id != INVALID_PAGE_ID) {
+                valid = page->GetInlineHighKey(&stored_key);
+                moved_right = valid && comp_->Compare(key, stored_key) > 0;
+                valid =
+                    valid && page_container->ValidateOptimisticRead(*version);
+            }
+            if (valid && moved_right) {
+                if (pinned) {
+                    buffer_manager_->UnpinPage(page_container);
+                }
+
+                parent_page_container = page_container;
+                parent_version = *version;
+                page_id = right_page_id;
+                continue;
+            }
+        }
+
+        auto page_type = page->GetPageType();
+        if (valid && page_type == PageType::PAGE_TYPE_BPLUS_LEAF) {
+            break;
+        }
+
+        // the keys are compared as they are read, but nothing is used before
+        // the read is validated.
+        auto internal_page =
+            reinterpret_cast<BplusTreeInternalPage*>(page_container->GetData());
+        auto count = internal_page->GetCount();
+        valid = valid && page_type == PageType::PAGE_TYPE_BPLUS_INTERNAL &&
+                internal_page->HasValidSlots() &&
+                count < BPLUS_INTERNAL_KEY_PAGE_ID_SIZE;
+
+        // keys in overflow pages can't be read optimistically
+        int32_t idx = 0;
+        valid = valid &&
+                LowerBoundInlineKey(comp_, key, internal_page, count, &idx);
+
+        page_id_t child_page_id =
+            valid ? internal_page->GetChild(idx) : INVALID_PAGE_ID;
+        valid = valid && page_container->ValidateOptimisticRead(*version);
+
+        if (pinned) {
+            buffer_manager_->UnpinPage(page_container);
+        }
+
+        if (!valid) {
+            return aborted;
+        }
+
+        parent_page_container = page_container;
+        parent_version = *version;
+        parent_slot = idx;
+        page_id = child_page_id;
+    }
+
+    // The leaf is pinned so that the caller can lock it. It is still the
+    // right leaf if it didn't change since its read started.
+    if (!pinned) {
+        auto page_container_or_status = buffer_manager_->GetPageWithId(page_id);
+        if (!page_container_or_status.ok()) {
+            LOG(ERROR) << "BplusTree::FindLeafOptimistic: error in reading "
+                          "leaf page from buffer pool";
+            return page_container_or_status.status();
+        }
+
+        // the page was evicted and read into another frame in the meantime
+        if (page_container_or_status.value() != page_container) {
+            buffer_manager_->UnpinPage(page_container_or_status.value());
+            return aborted;
+        }
+    }
+
+    return page_container;
+}
+
+absl::StatusOr<std::string> BplusTree::GetOptimistic(absl::string_view key) {
+    uint64_t version = 0;
+    auto page_container_or_status = FindLeafOptimistic(key, &version);
+    if (!page_container_or_status.ok()) {
+        return page_container_or_status.status();
+    }
+
+    // The values can be in overflow pages, so the leaf is read locked
+    auto page_container = page_container_or_status.value();
+    page_container->AquireReadLock();
+
+    absl::StatusOr<std::string> res =
+        absl::AbortedError("BplusTree::GetOptimistic: restart");
+    if (page_container->ValidateOptimisticRead(version)) {
+        res = GetFromLeaf(key, page_container);
+    }
+
+    buffer_manager_->UnpinPage(page_container);
+    page_container->ReleaseReadLock();
     return res;
 }
 
-absl::StatusOr<absl::string_view> BplusTree::GetFromPage(absl::string_view key,
-                                                         Page* page_container) {
+absl::Status BplusTree::InsertOptimistic(absl::string_view key,
+                                         absl::string_view value) {
+    uint64_t version = 0;
+    auto page_container_or_status = FindLeafOptimistic(key, &version);
+    if (!page_container_or_status.ok()) {
+        return page_container_or_status.status();
+    }
+
+    auto page_container = page_container_or_status.value();
+    if (!page_container->UpgradeOptimisticRead(version)) {
+        buffer_manager_->UnpinPage(page_container);
+        return absl::AbortedError("BplusTree::InsertOptimistic: restart");
+    }
+
+    // a full leaf needs its parent for the split
+    if (IsPageFull(page_container)) {
+        buffer_manager_->UnpinPage(page_container);
+        page_container->ReleaseExclusiveLock();
+        return absl::FailedPreconditionError(
+            "BplusTree::InsertOptimistic: leaf is full");
+    }
+
+    InsertIntoLeaf(key, value, page_container);
+
+    buffer_manager_->UnpinPage(page_container, /* is_dirty */ true);
+    page_container->ReleaseExclusiveLock();
+    return absl::OkStatus();
+}
+
+absl::Status BplusTree::DeleteOptimistic(absl::string_view key) {
+    uint64_t version = 0;
+    auto page_container_or_status = FindLeafOptimistic(key, &version);
+    if (!page_container_or_status.ok()) {
+        return page_container_or_status.status();
+    }
+
+    auto page_container = page_container_or_status.value();
+    if (!page_container->UpgradeOptimisticRead(version)) {
+        buffer_manager_->UnpinPage(page_container);
+        return absl::AbortedError("BplusTree::DeleteOptimistic: restart");
+    }
+
+    // a leaf which can become underfull needs its parent for the
+    // rebalance, unless it is the root. The root is only replaced after it
+    // was changed, so it is still the root if it is the root now. The pages
+    // of a B-link tree are never rebalanced.
+    if (!blink_ && root_page_id_ != page_container->GetPageId() &&
+        !IsPageSafeForDelete(page_container)) {
+        buffer_manager_->UnpinPage(page_container);
+        page_container->ReleaseExclusiveLock();
+        return absl::FailedPreconditionError(
+            "BplusTree::DeleteOptimistic: leaf can become underfull");
+    }
+
+    auto s = DeleteFromLeaf(key, page_container);
+
+    buffer_manager_->UnpinPage(page_container, /* is_dirty */ s.ok());
+    page_container->ReleaseExclusiveLock();
+    return s;
+}
+
+absl::StatusOr<std::string> BplusTree::GetFromLeaf(absl::string_view key,
+                                                   Page* page_container) {
+    auto leaf_page =
+        reinterpret_cast<BplusTreeLeafPage*>(page_container->GetData());
+
+    bool found = false;
+    auto idx = FindLeafIndex(key, leaf_page, &found);
+    if (found) {
+        LOG(INFO) << "BplusTree::GetFromLeaf: Found the value";
+
+        return leaf_page->GetValue(idx, buffer_manager_);
+    }
+
+    return absl::NotFoundError("key not found in b-tree");
+}
+
+int32_t BplusTree::FindChildIndex(absl::string_view key,
+                                  BplusTreeInternalPage* internal_page) {
+    return LowerBoundKeyInPage(comp_, buffer_manager_, key, internal_page);
+}
+
+int32_t BplusTree::FindLeafIndex(absl::string_view key,
+                                 BplusTreeLeafPage* leaf_page, bool* found) {
+    return LowerBoundKeyInPage(comp_, buffer_manager_, key, leaf_page, found);
+}
+
+absl::StatusOr<std::string> BplusTree::GetFromPage(absl::string_view key,
+                                                   Page* page_container) {
     CHECK_NOTNULL(page_container);
     LOG(INFO) << "BplusTree::GetFromPage: Init for page id: "
               << page_container->GetPageId();
 
-    page_container->AquireReadLock();
+    while (reinterpret_cast<BplusTreePage*>(page_container->GetData())
+               ->GetPageType() == PageType::PAGE_TYPE_BPLUS_INTERNAL) {
+        auto internal_page =
+            reinterpret_cast<BplusTreeInternalPage*>(page_container->GetData());
+        auto idx = FindChildIndex(key, internal_page);
 
-    bool is_leaf = reinterpret_cast<BplusTreePage*>(page_container->GetData())
-                       ->GetPageType() == PageType::PAGE_TYPE_BPLUS_LEAF;
-    if (is_leaf) {
-        LOG(INFO) << "BplusTree::GetFromPage: Reached the leaf node";
+        auto child_page_container_or_status = buffer_manager_->GetChildPage(
+            page_container, idx, internal_page->GetChild(idx));
+        if (!child_page_container_or_status.ok()) {
+            LOG(ERROR) << "BplusTree::GetFromPage: error in reading child page "
+                          "from buffer pool";
 
-        auto leaf_page =
-            reinterpret_cast<BplusTreeLeafPage*>(page_container->GetData());
+            buffer_manager_->UnpinPage(page_container);
+            page_container->ReleaseReadLock();
+            return child_page_container_or_status.status();
+        }
+
+        // lock the child before letting go of the parent
+        auto child_page_container = child_page_container_or_status.value();
+        child_page_container->AquireReadLock();
 
-        for (auto idx = 0; idx < leaf_page->count_; idx++) {
-            LOG(INFO) << "BplusTree::GetFromPage: query key: " << key
-                      << ". stored key: "
-                      << leaf_page->data_[idx].key.GetStringData(
-                             buffer_manager_);
+        buffer_manager_->UnpinPage(page_container);
+        page_container->ReleaseReadLock();
+        page_container = child_page_container;
+    }
 
-            if (comp_->Compare(key, leaf_page->data_[idx].key.GetStringData(
-                                        buffer_manager_)) == 0) {
-                LOG(INFO) << "BplusTree::GetFromPage: Found the value";
+    LOG(INFO) << "BplusTree::GetFromPage: Reached the leaf node";
 
-                page_container->ReleaseReadLock();
-                return leaf_page->data_[idx].value.GetStringData(
-                    buffer_manager_);
-            }
+    auto res = GetFromLeaf(key, page_container);
+    buffer_manager_->UnpinPage(page_container);
+    page_container->ReleaseReadLock();
+    return res;
+}
+
+std::unique_ptr<BplusTreeIterator> BplusTree::NewIterator() {
+    return std::make_unique<BplusTreeIterator>(this);
+}
+
+absl::StatusOr<Page*> BplusTree::GetLatchedRootPage(bool exclusive) {
+    while (true) {
+        page_id_t root_page_id = root_page_id_;
+        auto page_container_or_status =
+            buffer_manager_->GetPageWithId(root_page_id);
+        if (!page_container_or_status.ok()) {
+            return page_container_or_status.status();
         }
 
-        page_container->ReleaseReadLock();
-        return absl::NotFoundError("key not found in b-tree");
+        auto page_container = page_container_or_status.value();
+        if (exclusive) {
+            page_container->AquireExclusiveLock();
+        } else {
+            page_container->AquireReadLock();
+        }
+
+        if (root_page_id_ == root_page_id) {
+            return page_container;
+        }
+
+        LOG(INFO) << "BplusTree::GetLatchedRootPage: root page " << root_page_id
+                  << " was split. retrying";
+
+        buffer_manager_->UnpinPage(page_container);
+        if (exclusive) {
+            page_container->ReleaseExclusiveLock();
+        } else {
+            page_container->ReleaseReadLock();
+        }
     }
+}
 
-    auto internal_page =
-        reinterpret_cast<BplusTreeInternalPage*>(page_container->GetData());
-    auto idx = 0;
-    while (idx < internal_page->count_ &&
-           comp_->Compare(key, internal_page->keys_[idx].GetStringData(
-                                   buffer_manager_)) > 0) {
-        idx++;
+absl::Status BplusTree::BulkLoad(
+    const BulkLoadOptions& options,
+    absl::FunctionRef<absl::StatusOr<bool>(std::string*, std::string*)>
+        next) {
+    CHECK_NE(root_page_id_.load(), INVALID_PAGE_ID);
+    LOG(INFO) << "BplusTree::BulkLoad: start with fill factor "
+              << options.fill_factor;
+
+    if (!(options.fill_factor > 0 && options.fill_factor <= 1)) {
+        return absl::InvalidArgumentError(
+            "BplusTree::BulkLoad: fill factor must be in (0, 1]");
     }
 
-    CHECK(idx <= internal_page->count_)
-        << "BplusTree::GetFromPage: programming error. idx > "
-           "internal_page->count_";
+    std::unique_lock l(mu_);
 
-    auto child_page_container_or_status =
-        buffer_manager_->GetPageWithId(internal_page->children_[idx]);
-    if (!child_page_container_or_status.ok()) {
-        LOG(ERROR) << "BplusTree::GetFromPage: error in reading child page "
-                      "from buffer pool";
+    auto status_or_root_page_container =
+        buffer_manager_->GetPageWithId(root_page_id_);
+    if (!status_or_root_page_container.ok()) {
+        LOG(ERROR) << "BplusTree::BulkLoad: getting root page failed";
+        return status_or_root_page_container.status();
+    }
 
-        page_container->ReleaseReadLock();
-        return child_page_container_or_status.status();
+    auto root_page_container = status_or_root_page_container.value();
+    root_page_container->AquireReadLock();
+    auto root_page =
+        reinterpret_cast<BplusTreePage*>(root_page_container->GetData());
+    bool is_empty = root_page->GetPageType() == PAGE_TYPE_BPLUS_LEAF &&
+                    root_page->GetCount() == 0;
+    buffer_manager_->UnpinPage(root_page_container);
+    root_page_container->ReleaseReadLock();
+    if (!is_empty) {
+        LOG(ERROR) << "BplusTree::BulkLoad: the tree isn't empty";
+        return absl::FailedPreconditionError(
+            "BplusTree::BulkLoad: the tree isn't empty");
     }
 
-    auto child_page_container = child_page_container_or_status.value();
-    auto res = GetFromPage(key, child_page_container);
+    BplusTreeBulkLoader loader(comp_, buffer_manager_, disk_manager_,
+                               options);
+    std::string key, value;
+    while (true) {
+        auto status_or_has_next = next(&key, &value);
+        if (!status_or_has_next.ok()) {
+            LOG(ERROR) << "BplusTree::BulkLoad: error while reading the pairs";
+            return status_or_has_next.status();
+        }
+        if (!status_or_has_next.value()) {
+            break;
+        }
 
-    // TODO: This is inefficient. Implement latch crabbing - release parent lock
-    // after locking child.
-    page_container->ReleaseReadLock();
-    buffer_manager_->UnpinPage(child_page_container);
-    return res;
+        auto s = loader.Add(key, value);
+        if (!s.ok()) {
+            return s;
+        }
+    }
+
+    auto status_or_new_root_id = loader.Finish();
+    if (!status_or_new_root_id.ok()) {
+        LOG(ERROR) << "BplusTree::BulkLoad: error while writing the pages";
+        return status_or_new_root_id.status();
+    }
+
+    // the pages were allocated without logging, so the entry which makes
+    // them the tree also covers their ids. See RecoveryManager::Recover.
+    auto new_root_id = status_or_new_root_id.value();
+    absl::StatusOr<std::unique_ptr<LogEntry>> sOrLogEntry =
+        log_manager_->PrepareLogEntry(
+            BULK_LOAD_KEY, absl::StrCat(new_root_id, " ",
+                                        buffer_manager_->GetNextPageId()));
+    if (!sOrLogEntry.ok() || *sOrLogEntry == nullptr) {
+        LOG(ERROR) << "BplusTree::BulkLoad: unable to prepare the log entry "
+                      "of the load";
+        return sOrLogEntry.status();
+    }
+
+    absl::Status s = log_manager_->WriteLogEntry(*sOrLogEntry);
+    if (!s.ok()) {
+        LOG(ERROR) << "BplusTree::BulkLoad: unable to write the log entry of "
+                      "the load";
+        return s;
+    }
+
+    LOG(INFO) << "BplusTree::BulkLoad: wrote " << loader.GetPageCount()
+              << " pages. updating root page id to " << new_root_id;
+
+    auto old_root_id = root_page_id_.load();
+    root_page_id_ = new_root_id;
+    buffer_manager_->SetIndexRootPageId(new_root_id);
+
+    // the empty root was replaced, it isn't part of the tree anymore
+    status_or_root_page_container = buffer_manager_->GetPageWithId(old_root_id);
+    if (!status_or_root_page_container.ok()) {
+        LOG(ERROR) << "BplusTree::BulkLoad: getting the replaced root page "
+                      "failed, it isn't reported as freed";
+        return absl::OkStatus();
+    }
+
+    root_page_container = status_or_root_page_container.value();
+    root_page_container->AquireExclusiveLock();
+    FreePage(root_page_container);
+    buffer_manager_->UnpinPage(root_page_container, /* is_dirty */ true);
+    root_page_container->ReleaseExclusiveLock();
+    return absl::OkStatus();
 }
 
 absl::Status BplusTree::UpdateRoot(page_id_t new_root_id) {
-    LOG(INFO) << "BplusTree::UpdateRoot: updating root_page_id_ to "
+    std::unique_lock l(mu_);
+    return UpdateRootLocked(new_root_id);
+}
+
+absl::Status BplusTree::UpdateRootLocked(page_id_t new_root_id) {
+    LOG(INFO) << "BplusTree::UpdateRootLocked: updating root_page_id_ to "
               << new_root_id;
 
     absl::StatusOr<std::unique_ptr<LogEntry>> sOrLogEntry =
         log_manager_->PrepareLogEntry(INDEX_ROOT_PAGE_ID_KEY,
                                       std::to_string(new_root_id));
     if (!sOrLogEntry.ok() || *sOrLogEntry == nullptr) {
-        LOG(ERROR) << "BplusTree::UpdateRoot: unable to update the root of the "
-                      "bplus tree";
+        LOG(ERROR) << "BplusTree::UpdateRootLocked: unable to update the root "
+                      "of the bplus tree";
         return sOrLogEntry.status();
     }
 
     absl::Status s = log_manager_->WriteLogEntry(*sOrLogEntry);
     if (!s.ok()) {
-        LOG(ERROR) << "BplusTree::UpdateRoot: unable to write log for "
+        LOG(ERROR) << "BplusTree::UpdateRootLocked: unable to write log for "
                       "updating the root of the bplus tree";
         return s;
     }
 
-    std::unique_lock l(mu_);
     root_page_id_ = new_root_id;
+    buffer_manager_->SetIndexRootPageId(new_root_id);
 
     return absl::OkStatus();
 }
@@ -783,12 +1800,9 @@ void BplusTree::PrintNode(page_id_t page_id, std::string indentation) {
 
         std::cout << indentation;
         for (int32_t idx = 0; idx < leaf_page->count_; idx++) {
-            std::cout
-                << "key: "
-                << leaf_page->data_[idx].key.GetStringData(buffer_manager_)
-                << " value: "
-                << leaf_page->data_[idx].value.GetStringData(buffer_manager_)
-                << " ------ ";
+            std::cout << "key: " << leaf_page->GetKey(idx, buffer_manager_)
+                      << " value: " << leaf_page->GetValue(idx, buffer_manager_)
+                      << " ------ ";
         }
         std::cout << std::endl;
     } else {
@@ -804,20 +1818,18 @@ void BplusTree::PrintNode(page_id_t page_id, std::string indentation) {
 
         for (int32_t idx = 0; idx < internal_page->count_; idx++) {
             std::cout << new_indentation
-                      << "page_id: " << internal_page->children_[idx]
-                      << " key: "
-                      << internal_page->keys_[idx].GetStringData(
-                             buffer_manager_)
+                      << "page_id: " << internal_page->GetChild(idx)
+                      << " key: " << internal_page->GetKey(idx, buffer_manager_)
                       << std::endl;
 
-            PrintNode(internal_page->children_[idx], new_indentation);
+            PrintNode(internal_page->GetChild(idx), new_indentation);
             std::cout << std::endl;
         }
 
         std::cout << new_indentation << "page_id: "
-                  << internal_page->children_[internal_page->count_]
+                  << internal_page->GetChild(internal_page->count_)
                   << " key: no key. last child of internal value" << std::endl;
-        PrintNode(internal_page->children_[internal_page->count_],
+        PrintNode(internal_page->GetChild(internal_page->count_),
                   new_indentation);
         std::cout << std::endl;
     }
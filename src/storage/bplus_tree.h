@@ -3,11 +3,18 @@
 
 #include <gtest/gtest_prod.h>
 
+#include <atomic>
+#include <memory>
+#include <mutex>
 #include <shared_mutex>
+#include <string>
+#include <vector>
 
+#include "absl/functional/function_ref.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "bplus_tree_page_internal.h"
+#include "bplus_tree_page_leaf.h"
 #include "buffer_manager.h"
 #include "disk_manager.h"
 #include "key_comparator.h"
@@ -17,16 +24,54 @@
 
 namespace graphchaindb {
 
+class BplusTreeIterator;
+
 // BplusTree which stores the key-value pairs at leaf pages.
 //
 // Both the keys and values are variable length strings.
+//
+// Concurrent operations are coupled with latch crabbing. A page is latched
+// before the latch of its parent is released. Readers release the parent
+// right away. Writers latch exclusively and keep the ancestors latched only
+// while the child is unsafe, i.e. an insert or delete further down could
+// split or rebalance it. Inserts split full children on the way down, so they
+// hold at most two latches. The root is checked to still be the root once it
+// is latched, since a concurrent split of the root replaces it.
+//
+// Most writes don't need the crabbing though. Writers first descend
+// optimistically like readers and only upgrade the leaf to an exclusive
+// latch, validating that it didn't change since it was read. If the leaf
+// turns out to be unsafe the write falls back to crabbing.
+//
+// With Options::blink_tree it is a B-link tree instead. Every page knows its
+// right page and its high key, so a page can be split on its own and the
+// separator is added to the parent afterwards. Until then, an operation which
+// reaches the left page from the stale parent moves right to the page which
+// holds the key. Operations lock only one page at a time then, apart from
+// the new page of a split. Deletes don't merge pages, which would break
+// moving right.
+//
+// Otherwise a page which becomes underfull after a delete, i.e. less than
+// BPLUS_MIN_FILL_PERCENT of it is used, is merged with a sibling if both fit
+// into one page, or takes entries from the sibling so that both are about
+// equally full. The root is replaced by its only child once its last two
+// children were merged. The pages which are removed from the tree are
+// reported by TakeFreedPageIds.
+//
 // It is thread safe
 class BplusTree {
+    friend class BplusTreeIterator;
+
    public:
     BplusTree(BufferManager* buffer_manager, DiskManager* disk_manager,
               LogManager* log_manager);
     BplusTree(BufferManager* buffer_manager, DiskManager* disk_manager,
               LogManager* log_manager, KeyComparator* comp);
+    BplusTree(BufferManager* buffer_manager, DiskManager* disk_manager,
+              LogManager* log_manager, const Options& options);
+    BplusTree(BufferManager* buffer_manager, DiskManager* disk_manager,
+              LogManager* log_manager, KeyComparator* comp,
+              const Options& options);
 
     BplusTree(const BplusTree&) = delete;
     BplusTree& operator=(const BplusTree&) = delete;
@@ -39,18 +84,53 @@ class BplusTree {
 
     // Insert the given value corresponding to the given key.
     //
-    // overwrites the existing value if it exists.
+    // overwrites the existing value if it exists. Only locks the leaf unless
+    // it is full, in which case the path is locked for the split.
     absl::Status Insert(const WriteOptions& options, absl::string_view key,
                         absl::string_view value);
 
     // Delete the given key and it's corresponding value.
     //
-    // Returns NotFoundError if the key is not found.
+    // Returns NotFoundError if the key is not found. Only locks the leaf
+    // unless it can become underfull.
     absl::Status Delete(const WriteOptions& options, absl::string_view key);
 
     // Gets the latest value corresponding to the given key.
-    absl::StatusOr<absl::string_view> Get(const ReadOptions& options,
-                                          absl::string_view key);
+    //
+    // Descends the internal pages optimistically without locking them and
+    // only read locks the leaf. Falls back to read locking the whole path
+    // after OPTIMISTIC_READ_MAX_ATTEMPTS failed descents.
+    absl::StatusOr<std::string> Get(const ReadOptions& options,
+                                    absl::string_view key);
+
+    // Load the key-value pairs of the sorted stream into the empty tree,
+    // building it bottom up, see BplusTreeBulkLoader. next sets the next
+    // pair and returns true, or returns false at the end of the stream. The
+    // keys MUST be sorted and unique.
+    //
+    // The pages are written to disk directly and only a single log entry is
+    // written once they are, which makes their root the root of the tree.
+    // The empty root it replaces is freed, see TakeFreedPageIds.
+    // MUST NOT run concurrently with other writes.
+    //
+    // Returns FailedPreconditionError if the tree isn't empty and
+    // InvalidArgumentError if the keys aren't sorted or the fill factor is
+    // invalid.
+    absl::Status BulkLoad(
+        const BulkLoadOptions& options,
+        absl::FunctionRef<absl::StatusOr<bool>(std::string*, std::string*)>
+            next);
+
+    // Get the ids of the pages which were removed from the tree by merges or
+    // a bulk load since the last call. They aren't reachable from the tree
+    // anymore and are marked as invalid pages, so that an operation which
+    // still reaches one of them notices it.
+    std::vector<page_id_t> TakeFreedPageIds();
+
+    // Get an iterator over the key-value pairs in the order of the keys.
+    //
+    // The iterator is unpositioned. Call one of its seek methods first.
+    std::unique_ptr<BplusTreeIterator> NewIterator();
 
     // Print the tree for debugging purposes
     // Only for Debugging. Doesn't lock and handle errors.
@@ -58,14 +138,35 @@ class BplusTree {
 
    private:
     FRIEND_TEST(BplusTreeTest, SplitChildLeafSucceeds);
+    FRIEND_TEST(BplusTreeTest, SplitChildLeafTruncatesSeparatorSucceeds);
+    FRIEND_TEST(BplusTreeTest, PrefixCompressedInsertGetScanSucceeds);
+    FRIEND_TEST(BplusTreeTest, DeleteMergesPagesAndShrinksTreeSucceeds);
+    FRIEND_TEST(BplusTreeTest, BorrowOrMergeChildLeafSucceeds);
+    FRIEND_TEST(BplusTreeTest, BulkLoadGetScanInsertDeleteSucceeds);
 
-    // IMPORTANT: Doesn't unpin the page passed to it
+    // Insert into the subtree of the non-full page. is_dirty indicates if the
+    // page was modified by the caller.
+    //
+    // IMPORTANT: Unpins the page passed to it and releases its lock
     // ASSUMES: Exclusive lock is held on the page
     absl::Status InsertNonFull(absl::string_view key, absl::string_view value,
-                               Page* page);
+                               Page* page, bool is_dirty);
+
+    // Insert the key-value pair into the leaf page, which MUST not be full
+    // ASSUMES: Exclusive lock is held on the leaf page
+    void InsertIntoLeaf(absl::string_view key, absl::string_view value,
+                        Page* page_container);
+
+    // Insert into the leaf found by an optimistic descent, locking only the
+    // leaf.
+    //
+    // Returns AbortedError if a page changed during the descent and
+    // FailedPreconditionError if the leaf is full.
+    absl::Status InsertOptimistic(absl::string_view key,
+                                  absl::string_view value);
 
     // Split the given child page into two pages. The index (0 based) denotes
-    // where the child page is in the parents children_ array
+    // where the child page is among the children of the parent
     //
     // Returns the newly created child page id
     //
@@ -75,17 +176,131 @@ class BplusTree {
     absl::StatusOr<page_id_t> SplitChild(Page* parent_page, int32_t index,
                                          Page* child_page);
 
-    // IMPORTANT: Doesn't unpin the page passed to it
+    // Split the page into two by moving the upper half of it to a new page,
+    // which becomes the right page of the given page. The high key of the
+    // page is the separator of the two afterwards. The separator of two
+    // leaves is the shortest key between them if the keys are ordered byte
+    // by byte.
+    //
+    // Returns the new page. It is pinned and exclusively locked.
+    // ASSUMES: Exclusive lock is held on the page
+    absl::StatusOr<Page*> SplitPage(Page* page);
+
+    // Insert the separator and the page id right of it into the internal
+    // page, which MUST not be full
+    // ASSUMES: Exclusive lock is held on the internal page
+    void InsertIntoInternal(absl::string_view separator,
+                            page_id_t right_page_id, Page* page_container);
+
+    // Insert into the B-link tree, splitting the full leaf on its own.
+    absl::Status InsertBlink(absl::string_view key, absl::string_view value);
+
+    // Add the separator of a split to the parent of the split page, which
+    // is the last page of the path. Splits the full parents on the way up
+    // and grows the tree if the root was split.
+    absl::Status InsertSeparatorBlink(std::string separator,
+                                      page_id_t left_page_id,
+                                      page_id_t right_page_id,
+                                      std::vector<page_id_t> path);
+
+    // Make a new root with the two halves of the split root as children.
+    //
+    // Returns false if the left page isn't the root anymore.
+    absl::StatusOr<bool> GrowRootBlink(absl::string_view separator,
+                                       page_id_t left_page_id,
+                                       page_id_t right_page_id);
+
+    // Find the leaf of the key in the B-link tree, locking one page at a time
+    // and moving right where needed. The ids of the internal pages on the way
+    // are appended to path from the root down, if it is given.
+    //
+    // Returns the leaf pinned and locked, exclusively if asked for.
+    absl::StatusOr<Page*> FindLeafBlink(absl::string_view key, bool exclusive,
+                                        std::vector<page_id_t>* path);
+
+    // Move right from the page until the page which holds the key.
+    //
+    // Returns the page which holds the key, pinned and locked like the given
+    // page.
+    // IMPORTANT: Unpins the page passed to it and releases its lock if it
+    // moves right
+    absl::StatusOr<Page*> MoveRight(absl::string_view key, Page* page,
+                                    bool exclusive);
+
+    // Delete from the subtree of the page and rebalance the pages which
+    // become underfull. Replaces the root by its only child if it is left
+    // with one.
+    //
+    // IMPORTANT: Unpins the page passed to it and releases its lock
     // ASSUMES: Exclusive lock is held on the page
     absl::Status DeleteFromPage(absl::string_view key, Page* page_container);
 
+    // Delete the key from the leaf page.
+    //
+    // Returns NotFoundError if the key is not found.
+    // ASSUMES: Exclusive lock is held on the leaf page
+    absl::Status DeleteFromLeaf(absl::string_view key, Page* page_container);
+
+    // Delete from the leaf found by an optimistic descent, locking only the
+    // leaf.
+    //
+    // Returns AbortedError if a page changed during the descent and
+    // FailedPreconditionError if the leaf can become underfull.
+    absl::Status DeleteOptimistic(absl::string_view key);
+
+    // Get the value of the key from the subtree of the page, crabbing down
+    // with read locks.
+    //
+    // IMPORTANT: Unpins the page passed to it and releases its lock
     // ASSUMES: Shared lock is held on the page container
-    absl::StatusOr<absl::string_view> GetFromPage(absl::string_view key,
-                                                  Page* page_container);
+    absl::StatusOr<std::string> GetFromPage(absl::string_view key,
+                                            Page* page_container);
+
+    // Pin the root page and lock it, exclusively or shared. Retries if the
+    // root is replaced before the lock is held.
+    absl::StatusOr<Page*> GetLatchedRootPage(bool exclusive);
+
+    // Find the leaf of the key by reading the internal pages optimistically,
+    // coupling the read of every page with the validation of its parent.
+    // Returns the leaf pinned but not locked, together with the version at
+    // which its read started.
+    //
+    // Returns AbortedError if a page changed during the descent.
+    absl::StatusOr<Page*> FindLeafOptimistic(absl::string_view key,
+                                             uint64_t* version);
 
-    // The child page is half full. Borrow entries from siblings or merge with
-    // them. The index (0 based) denotes where the child page is in the parents
-    // children_ array
+    // Get the value of the key by reading the internal pages optimistically.
+    //
+    // Returns AbortedError if a page changed during the descent.
+    absl::StatusOr<std::string> GetOptimistic(absl::string_view key);
+
+    // Find the value of the key in the leaf page.
+    //
+    // ASSUMES: Shared lock is held on the leaf page
+    absl::StatusOr<std::string> GetFromLeaf(absl::string_view key,
+                                            Page* page_container);
+
+    // Get the index of the child of the internal page which holds the key.
+    // Binary searches the keys of the page.
+    //
+    // ASSUMES: locks are held on the page
+    int32_t FindChildIndex(absl::string_view key,
+                           BplusTreeInternalPage* internal_page);
+
+    // Get the index of the first pair of the leaf page whose key isn't
+    // smaller than the key. found is set if the key is at the index.
+    // Binary searches the keys of the page.
+    //
+    // ASSUMES: locks are held on the page
+    int32_t FindLeafIndex(absl::string_view key, BplusTreeLeafPage* leaf_page,
+                          bool* found);
+
+    // The child page is underfull. Merge it with a sibling or borrow entries
+    // from the sibling, which is the left one unless the child is the first
+    // child. Nothing is done if the parent has no other child, or neither
+    // is possible because the keys grow with the shorter prefixes of the
+    // rebuilt pages. The index (0 based) denotes where the child page is
+    // among the children of the parent
     //
     // IMPORTANT: Doesn't unpin the parent_page and child_page
     // ASSUMES: Exclusive locks are held on the parent and child page by
@@ -93,25 +308,69 @@ class BplusTree {
     absl::Status BorrowOrMergeChild(Page* parent_page, int32_t index,
                                     Page* child_page);
 
-    // Merge the left and right child into one and remove the corresponding key
-    // in the parent. The index (0 based) denotes where the child page is in the
-    // parents children_ array. is_leaf indicates if the child nodes are at the
-    // leaf
+    // Merge the right child into the left child and remove the key between
+    // them from the parent. The index (0 based) denotes where the left child
+    // is among the children of the parent. is_leaf indicates if the child
+    // nodes are at the leaf. The right child is freed, see FreePage.
+    //
+    // Returns false and changes nothing if the merged page would be full.
+    // IMPORTANT: Doesn't unpin the parent_page and child pages
+    // ASSUMES: Exclusive locks are held on the parent and child pages by
+    // the caller
+    bool MergeChild(Page* parent_page, int32_t index, Page* left_child,
+                    Page* right_child, bool is_leaf);
+
+    // Move entries between the left and right child so that both are about
+    // equally full, and replace the key between them in the parent by their
+    // new separator. An internal separator moves down into the children and
+    // another key moves up instead, like the median key of a split.
     //
+    // Returns false and changes nothing if a page can't fit its new entries.
     // IMPORTANT: Doesn't unpin the parent_page and child pages
     // ASSUMES: Exclusive locks are held on the parent and child pages by
     // the caller
-    absl::Status MergeChild(Page* parent_page, int32_t index, Page* left_child,
-                            Page* right_child, bool is_leaf);
+    bool BorrowChild(Page* parent_page, int32_t index, Page* left_child,
+                     Page* right_child, bool is_leaf);
+
+    // Copy the entries from start to end of the two children to the end of
+    // the page. The entries of leaves are the pairs of the left child
+    // followed by the ones of the right child. The entries of internal pages
+    // have the separator of the two with the first child of the right child
+    // in between.
+    //
+    // Returns false if they don't fit.
+    bool CopyEntries(BplusTreePage* page, BplusTreePage* left_page,
+                     BplusTreePage* right_page, absl::string_view separator,
+                     int32_t start, int32_t end, bool is_leaf);
+
+    // Init the page which is rebuilt in data to replace the given page. It
+    // keeps the id, type and parent of the page but nothing else.
+    BplusTreePage* StartRebuiltPage(char* data, BplusTreePage* page);
+
+    // Strip the prefix of the fences from the keys of the page if the keys
+    // are ordered byte by byte, see BplusTreePage::UpdatePrefix
+    void UpdatePagePrefix(BplusTreePage* page);
+
+    // Mark the page removed from the tree as invalid and report it, see
+    // TakeFreedPageIds.
+    // ASSUMES: Exclusive lock is held on the page
+    void FreePage(Page* page);
 
     // ASSUMES: locks are held on the page
     bool IsPageFull(Page* page);
 
     // ASSUMES: locks are held on the page
-    bool IsPageLessThanHalfFull(Page* page);
+    bool IsPageUnderfull(Page* page);
+
+    // Returns if the page doesn't become underfull when an entry is removed
+    // ASSUMES: locks are held on the page
+    bool IsPageSafeForDelete(Page* page);
 
     absl::Status UpdateRoot(page_id_t new_root_id);
 
+    // ASSUMES: mu_ is held exclusively
+    absl::Status UpdateRootLocked(page_id_t new_root_id);
+
     // Only for Debugging. Doesn't lock and handle errors.
     void PrintNode(page_id_t page_id, std::string indentation = "");
 
@@ -119,9 +378,13 @@ class BplusTree {
     BufferManager* buffer_manager_;
     DiskManager* disk_manager_;
     LogManager* log_manager_;
+    const bool blink_;
 
-    std::shared_mutex mu_;
-    page_id_t root_page_id_{INVALID_PAGE_ID};
+    std::shared_mutex mu_;  // serializes the updates of the root
+    std::atomic<page_id_t> root_page_id_{INVALID_PAGE_ID};  // loaded without
+                                                            // mu_ by readers
+    std::mutex freed_mu_;  // protects freed_page_ids_
+    std::vector<page_id_t> freed_page_ids_;
 };
 
 }  // namespace graphchaindb
@@ -0,0 +1,195 @@
+#include "bplus_tree_bulk_loader.h"
+
+#include <glog/logging.h>
+
+#include <cstring>
+
+#include "bplus_tree_page_internal.h"
+#include "bplus_tree_page_leaf.h"
+#include "bplus_tree_search.h"
+
+namespace graphchaindb {
+
+BplusTreeBulkLoader::BplusTreeBulkLoader(KeyComparator* comp,
+                                         BufferManager* buffer_manager,
+                                         DiskManager* disk_manager,
+                                         const BulkLoadOptions& options)
+    : comp_{CHECK_NOTNULL(comp)},
+      buffer_manager_{CHECK_NOTNULL(buffer_manager)},
+      disk_manager_{CHECK_NOTNULL(disk_manager)},
+      fill_factor_{options.fill_factor},
+      leaf_{std::make_unique<PageBuffer>()} {
+    CHECK(fill_factor_ > 0 && fill_factor_ <= 1);
+
+    auto leaf_page = reinterpret_cast<BplusTreeLeafPage*>(leaf_->data);
+    leaf_page->InitPage(buffer_manager_->AllocatePageId(),
+                        PageType::PAGE_TYPE_BPLUS_LEAF, INVALID_PAGE_ID);
+}
+
+absl::Status BplusTreeBulkLoader::Add(absl::string_view key,
+                                      absl::string_view value) {
+    if (!empty_ && comp_->Compare(last_key_, key) >= 0) {
+        LOG(ERROR) << "BplusTreeBulkLoader::Add: the key isn't larger than "
+                      "the previous key";
+        return absl::InvalidArgumentError(
+            "BplusTreeBulkLoader::Add: keys are not sorted");
+    }
+
+    auto leaf_page = reinterpret_cast<BplusTreeLeafPage*>(leaf_->data);
+    auto cell_size = BplusTreePage::GetStringSize(key) +
+                     BplusTreePage::GetStringSize(value);
+    if (!fits(leaf_page, cell_size)) {
+        // the separator of the leaves is the shortest key between them, like
+        // the one of a split, see BplusTree::SplitPage
+        auto separator = last_key_;
+        if (comp_->IsBytewise()) {
+            separator = ShortestSeparator(separator, key);
+        }
+
+        auto left_page_id = leaf_page->GetPageId();
+        auto right_page_id = buffer_manager_->AllocatePageId();
+        auto s = finishPage(leaf_page, separator, right_page_id);
+        if (!s.ok()) {
+            return s;
+        }
+
+        s = addSeparator(0, separator, left_page_id, right_page_id);
+        if (!s.ok()) {
+            return s;
+        }
+    }
+
+    CHECK(leaf_page->Insert(leaf_page->GetCount(), key, value,
+                            buffer_manager_));
+    last_key_ = std::string(key);
+    empty_ = false;
+    return absl::OkStatus();
+}
+
+absl::StatusOr<page_id_t> BplusTreeBulkLoader::Finish() {
+    LOG(INFO) << "BplusTreeBulkLoader::Finish: writing the last pages of "
+              << levels_.size() + 1 << " levels";
+
+    auto leaf_page = reinterpret_cast<BplusTreePage*>(leaf_->data);
+    auto s = writePage(leaf_page);
+    if (!s.ok()) {
+        return s;
+    }
+
+    auto root_page_id = leaf_page->GetPageId();
+    for (auto& level : levels_) {
+        auto page = reinterpret_cast<BplusTreePage*>(level->data);
+        s = writePage(page);
+        if (!s.ok()) {
+            return s;
+        }
+        root_page_id = page->GetPageId();
+    }
+
+    return root_page_id;
+}
+
+bool BplusTreeBulkLoader::fits(BplusTreePage* page, int cell_size) {
+    // a high key is at most as large as an inline string
+    static constexpr int HIGH_KEY_SIZE =
+        sizeof(uint16_t) + BPLUS_MAX_INLINE_STRING_SIZE;
+
+    auto size = cell_size + BplusTreePage::DIRECTORY_ENTRY_SIZE;
+    if (page->GetFreeSpace() < size + HIGH_KEY_SIZE) {
+        return false;
+    }
+
+    // the first entry of a page is added regardless of the fill factor
+    return page->GetCount() == 0 ||
+           page->GetUsedSpace() + size <= page->GetCapacity() * fill_factor_;
+}
+
+absl::Status BplusTreeBulkLoader::addSeparator(size_t level,
+                                               absl::string_view separator,
+                                               page_id_t left_page_id,
+                                               page_id_t right_page_id) {
+    if (level == levels_.size()) {
+        LOG(INFO) << "BplusTreeBulkLoader::addSeparator: starting level "
+                  << level + 1;
+
+        levels_.push_back(std::make_unique<PageBuffer>());
+        auto page = reinterpret_cast<BplusTreeInternalPage*>(
+            levels_.back()->data);
+        page->InitPage(buffer_manager_->AllocatePageId(),
+                       PageType::PAGE_TYPE_BPLUS_INTERNAL, INVALID_PAGE_ID);
+        page->SetChild(0, left_page_id);
+    }
+
+    auto page = reinterpret_cast<BplusTreeInternalPage*>(levels_[level]->data);
+    auto cell_size =
+        sizeof(page_id_t) + BplusTreePage::GetStringSize(separator);
+    if (fits(page, cell_size)) {
+        CHECK(page->Insert(page->GetCount(), separator, right_page_id,
+                           buffer_manager_));
+        return absl::OkStatus();
+    }
+
+    // the separator moves up instead, like the median key of a split. It
+    // separates the page from the next page, whose first child is the right
+    // page.
+    auto page_id = page->GetPageId();
+    auto next_page_id = buffer_manager_->AllocatePageId();
+    auto s = finishPage(page, separator, next_page_id);
+    if (!s.ok()) {
+        return s;
+    }
+    page->SetChild(0, right_page_id);
+
+    return addSeparator(level + 1, separator, page_id, next_page_id);
+}
+
+absl::Status BplusTreeBulkLoader::finishPage(BplusTreePage* page,
+                                             absl::string_view high_key,
+                                             page_id_t right_page_id) {
+    page->SetRightPageId(right_page_id);
+    CHECK(page->SetHighKey(high_key, buffer_manager_));
+
+    bool is_leaf = page->GetPageType() == PageType::PAGE_TYPE_BPLUS_LEAF;
+    if (comp_->IsBytewise()) {
+        if (is_leaf) {
+            reinterpret_cast<BplusTreeLeafPage*>(page)->UpdatePrefix(
+                buffer_manager_);
+        } else {
+            reinterpret_cast<BplusTreeInternalPage*>(page)->UpdatePrefix(
+                buffer_manager_);
+        }
+    }
+
+    auto s = writePage(page);
+    if (!s.ok()) {
+        return s;
+    }
+
+    memset(reinterpret_cast<char*>(page), 0, PAGE_SIZE);
+    if (is_leaf) {
+        reinterpret_cast<BplusTreeLeafPage*>(page)->InitPage(
+            right_page_id, PageType::PAGE_TYPE_BPLUS_LEAF, INVALID_PAGE_ID);
+    } else {
+        reinterpret_cast<BplusTreeInternalPage*>(page)->InitPage(
+            right_page_id, PageType::PAGE_TYPE_BPLUS_INTERNAL,
+            INVALID_PAGE_ID);
+    }
+    CHECK(page->SetLowKey(high_key, buffer_manager_));
+    return absl::OkStatus();
+}
+
+absl::Status BplusTreeBulkLoader::writePage(BplusTreePage* page) {
+    auto s = disk_manager_->WritePage(page->GetPageId(),
+                                      reinterpret_cast<char*>(page));
+    if (!s.ok()) {
+        LOG(ERROR) << "BplusTreeBulkLoader::writePage: error while writing "
+                      "page "
+                   << page->GetPageId();
+        return s;
+    }
+
+    page_count_++;
+    return absl::OkStatus();
+}
+
+}  // namespace graphchaindb
@@ -0,0 +1,103 @@
+#ifndef STORAGE_BPLUS_TREE_BULK_LOADER_H
+#define STORAGE_BPLUS_TREE_BULK_LOADER_H
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/string_view.h"
+#include "bplus_tree_page.h"
+#include "buffer_manager.h"
+#include "disk_manager.h"
+#include "key_comparator.h"
+#include "option.h"
+#include "src/common/config.h"
+
+namespace graphchaindb {
+
+// BplusTreeBulkLoader builds a B+ tree bottom up from key value pairs in the
+// order of their keys, instead of inserting them one by one.
+//
+// The leaves are filled from left to right up to the fill factor. Once a
+// leaf is done, its separator from the next leaf is added to the last page
+// of the level above, which is filled the same way and adds its own
+// separator a level further up once it is done. So only the last page of
+// every level is kept in memory. The pages are written to disk through the
+// DiskManager as soon as they are done, so the leaves are written in the
+// order of their ids, without the buffer pool and without logging them.
+// They aren't part of any tree until the caller logs the root, see
+// BplusTree::BulkLoad.
+//
+// The pages are like the pages of a tree grown by splits: they are linked to
+// their right pages and have high and low keys and prefixes, but no parent
+// page ids.
+//
+// Not thread safe
+class BplusTreeBulkLoader {
+   public:
+    BplusTreeBulkLoader(KeyComparator* comp, BufferManager* buffer_manager,
+                        DiskManager* disk_manager,
+                        const BulkLoadOptions& options);
+
+    BplusTreeBulkLoader(const BplusTreeBulkLoader&) = delete;
+    BplusTreeBulkLoader& operator=(const BplusTreeBulkLoader&) = delete;
+
+    ~BplusTreeBulkLoader() = default;
+
+    // Add the pair to the tree. The key MUST be larger than the keys added
+    // before.
+    //
+    // Returns InvalidArgumentError if it isn't.
+    absl::Status Add(absl::string_view key, absl::string_view value);
+
+    // Write the last page of every level. No pair can be added afterwards.
+    //
+    // Returns the id of the root page.
+    absl::StatusOr<page_id_t> Finish();
+
+    // Get the number of pages written to disk so far
+    int64_t GetPageCount() { return page_count_; }
+
+   private:
+    // A page which is being filled
+    struct PageBuffer {
+        alignas(BplusTreePage) char data[PAGE_SIZE];
+    };
+
+    // Returns if the cell of the given size fits into the page below the
+    // fill factor, leaving room for the high key
+    bool fits(BplusTreePage* page, int cell_size);
+
+    // Add the separator of the two pages to the level above their level,
+    // which is 0 for the leaves. Starts the level if it has no page yet.
+    absl::Status addSeparator(size_t level, absl::string_view separator,
+                              page_id_t left_page_id,
+                              page_id_t right_page_id);
+
+    // Set the high key of the page and link it to the page right of it.
+    // Then write it and start the right page in its buffer, with the high
+    // key as its low key.
+    absl::Status finishPage(BplusTreePage* page, absl::string_view high_key,
+                            page_id_t right_page_id);
+
+    // Write the page to disk
+    absl::Status writePage(BplusTreePage* page);
+
+    KeyComparator* comp_;
+    BufferManager* buffer_manager_;
+    DiskManager* disk_manager_;
+    const double fill_factor_;
+
+    std::unique_ptr<PageBuffer> leaf_;
+    // the last internal page of every level above the leaves, bottom up
+    std::vector<std::unique_ptr<PageBuffer>> levels_;
+    std::string last_key_;
+    bool empty_{true};
+    int64_t page_count_{0};
+};
+
+}  // namespace graphchaindb
+
+#endif  // STORAGE_BPLUS_TREE_BULK_LOADER_H
@@ -26,6 +26,16 @@ BplusTreeIndex::BplusTreeIndex(BufferManager* buffer_manager,
         new BplusTree(buffer_manager_, disk_manager, log_manager, comp);
 }
 
+BplusTreeIndex::BplusTreeIndex(BufferManager* buffer_manager,
+                               DiskManager* disk_manager,
+                               LogManager* log_manager, const Options& options)
+    : buffer_manager_{CHECK_NOTNULL(buffer_manager)},
+      disk_manager_{CHECK_NOTNULL(disk_manager)},
+      log_manager_{CHECK_NOTNULL(log_manager)} {
+    bplus_tree_ =
+        new BplusTree(buffer_manager_, disk_manager, log_manager, options);
+}
+
 absl::Status BplusTreeIndex::Init(page_id_t root_page_id) {
     return bplus_tree_->Init(root_page_id);
 }
@@ -45,14 +55,15 @@ absl::Status BplusTreeIndex::Delete(const WriteOptions& options,
 absl::StatusOr<std::string> BplusTreeIndex::Get(const ReadOptions& options,
                                                 absl::string_view key) {
     LOG(INFO) << "BplusTreeIndex::Get: start";
-    auto status_or_value = bplus_tree_->Get(options, key);
-    if (!status_or_value.ok()) {
-        return status_or_value.status();
-    }
-
-    std::string value{status_or_value.value().data(),
-                      status_or_value.value().length()};
-    return std::move(value);
+    return bplus_tree_->Get(options, key);
+}
+
+absl::Status BplusTreeIndex::BulkLoad(
+    const BulkLoadOptions& options,
+    absl::FunctionRef<absl::StatusOr<bool>(std::string*, std::string*)>
+        next) {
+    LOG(INFO) << "BplusTreeIndex::BulkLoad: start";
+    return bplus_tree_->BulkLoad(options, next);
 }
 
 }  // namespace graphchaindb
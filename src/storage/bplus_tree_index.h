@@ -3,6 +3,7 @@
 
 #include <gmock/gmock.h>
 
+#include "absl/functional/function_ref.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/string_view.h"
@@ -25,6 +26,8 @@ class BplusTreeIndex {
                    LogManager* log_manager);
     BplusTreeIndex(BufferManager* buffer_manager, DiskManager* disk_manager,
                    LogManager* log_manager, KeyComparator* comp);
+    BplusTreeIndex(BufferManager* buffer_manager, DiskManager* disk_manager,
+                   LogManager* log_manager, const Options& options);
 
     BplusTreeIndex(const BplusTreeIndex&) = delete;
     BplusTreeIndex& operator=(const BplusTreeIndex&) = delete;
@@ -46,6 +49,13 @@ class BplusTreeIndex {
     absl::StatusOr<std::string> Get(const ReadOptions& options,
                                     absl::string_view key);
 
+    // Loads the sorted key value pairs into the empty index, see
+    // BplusTree::BulkLoad.
+    absl::Status BulkLoad(
+        const BulkLoadOptions& options,
+        absl::FunctionRef<absl::StatusOr<bool>(std::string*, std::string*)>
+            next);
+
    private:
     BufferManager* buffer_manager_;
     DiskManager* disk_manager_;
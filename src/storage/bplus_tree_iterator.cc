@@ -0,0 +1,214 @@
+#include "bplus_tree_iterator.h"
+
+#include <glog/logging.h>
+
+#include <algorithm>
+
+#include "bplus_tree_page_internal.h"
+#include "bplus_tree_page_leaf.h"
+
+namespace graphchaindb {
+
+BplusTreeIterator::BplusTreeIterator(BplusTree* tree)
+    : tree_{CHECK_NOTNULL(tree)}, buffer_manager_{tree->buffer_manager_} {}
+
+bool BplusTreeIterator::IsValid() { return valid_; }
+
+absl::Status BplusTreeIterator::SeekToFirst() {
+    valid_ = false;
+
+    auto leaf_or_status = FindLeaf(nullptr);
+    if (!leaf_or_status.ok()) {
+        LOG(ERROR) << "BplusTreeIterator::SeekToFirst: unable to find the "
+                      "first leaf";
+        return leaf_or_status.status();
+    }
+
+    LoadLeaf(leaf_or_status.value());
+    index_ = 0;
+    if (!entries_.empty()) {
+        valid_ = true;
+        return absl::OkStatus();
+    }
+
+    return LoadNextNonEmptyLeaf();
+}
+
+absl::Status BplusTreeIterator::SeekEqOrGreaterTo(BplusTreeEntry* item) {
+    CHECK_NOTNULL(item);
+    valid_ = false;
+
+    absl::string_view key = item->key;
+    auto leaf_or_status = FindLeaf(&key);
+    if (!leaf_or_status.ok()) {
+        LOG(ERROR) << "BplusTreeIterator::SeekEqOrGreaterTo: unable to find "
+                      "the leaf";
+        return leaf_or_status.status();
+    }
+
+    LoadLeaf(leaf_or_status.value());
+    index_ = std::lower_bound(entries_.begin(), entries_.end(), key,
+                              [this](const BplusTreeEntry& entry,
+                                     absl::string_view key) {
+                                  return tree_->comp_->Compare(entry.key,
+                                                               key) < 0;
+                              }) -
+             entries_.begin();
+
+    if (index_ < static_cast<int>(entries_.size())) {
+        valid_ = true;
+        return absl::OkStatus();
+    }
+
+    return LoadNextNonEmptyLeaf();
+}
+
+absl::Status BplusTreeIterator::Next() {
+    CHECK(valid_) << "BplusTreeIterator::Next: iterator is not valid";
+
+    index_++;
+    if (index_ < static_cast<int>(entries_.size())) {
+        return absl::OkStatus();
+    }
+
+    valid_ = false;
+    return LoadNextNonEmptyLeaf();
+}
+
+absl::StatusOr<std::unique_ptr<BplusTreeEntry>>
+BplusTreeIterator::GetCurrent() {
+    CHECK(valid_) << "BplusTreeIterator::GetCurrent: iterator is not valid";
+    return std::make_unique<BplusTreeEntry>(entries_[index_]);
+}
+
+absl::StatusOr<Page*> BplusTreeIterator::FindLeaf(
+    const absl::string_view* key) {
+    CHECK_NE(tree_->root_page_id_.load(), INVALID_PAGE_ID);
+
+    // the leaf found by crabbing can be left of the key in a B-link tree, and
+    // the leaves after it can still hold smaller keys.
+    if (key != nullptr && tree_->blink_) {
+        return tree_->FindLeafBlink(*key, /* exclusive */ false,
+                                    /* path */ nullptr);
+    }
+
+    auto page_container_or_status =
+        tree_->GetLatchedRootPage(/* exclusive */ false);
+    if (!page_container_or_status.ok()) {
+        return page_container_or_status.status();
+    }
+
+    auto page_container = page_container_or_status.value();
+
+    while (reinterpret_cast<BplusTreePage*>(page_container->GetData())
+               ->GetPageType() == PageType::PAGE_TYPE_BPLUS_INTERNAL) {
+        auto internal_page =
+            reinterpret_cast<BplusTreeInternalPage*>(page_container->GetData());
+
+        auto idx = key != nullptr ? tree_->FindChildIndex(*key, internal_page)
+                                  : 0;
+
+        auto child_page_container_or_status = buffer_manager_->GetChildPage(
+            page_container, idx, internal_page->GetChild(idx));
+        if (!child_page_container_or_status.ok()) {
+            LOG(ERROR) << "BplusTreeIterator::FindLeaf: error in reading "
+                          "child page from buffer pool";
+
+            buffer_manager_->UnpinPage(page_container);
+            page_container->ReleaseReadLock();
+            return child_page_container_or_status.status();
+        }
+
+        // lock the child before letting go of the parent
+        auto child_page_container = child_page_container_or_status.value();
+        child_page_container->AquireReadLock();
+
+        buffer_manager_->UnpinPage(page_container);
+        page_container->ReleaseReadLock();
+        page_container = child_page_container;
+    }
+
+    return page_container;
+}
+
+void BplusTreeIterator::LoadLeaf(Page* page_container) {
+    auto leaf_page =
+        reinterpret_cast<BplusTreeLeafPage*>(page_container->GetData());
+
+    entries_.clear();
+    entries_.reserve(leaf_page->GetCount());
+    for (int32_t idx = 0; idx < leaf_page->GetCount(); idx++) {
+        entries_.push_back({leaf_page->GetKey(idx, buffer_manager_),
+                            leaf_page->GetValue(idx, buffer_manager_)});
+    }
+    next_page_id_ = leaf_page->GetNextPageId();
+    high_key_ = next_page_id_ != INVALID_PAGE_ID
+                    ? leaf_page->GetHighKey(buffer_manager_)
+                    : std::string();
+
+    auto page_id = page_container->GetPageId();
+    buffer_manager_->UnpinPage(page_container);
+    page_container->ReleaseReadLock();
+
+    buffer_manager_->RecordLeafAccess(page_id, next_page_id_,
+                                      /* sequential_hint */ true);
+}
+
+absl::Status BplusTreeIterator::LoadNextNonEmptyLeaf() {
+    while (next_page_id_ != INVALID_PAGE_ID) {
+        auto page_container_or_status =
+            buffer_manager_->GetPageWithId(next_page_id_);
+        if (!page_container_or_status.ok()) {
+            LOG(ERROR) << "BplusTreeIterator::LoadNextNonEmptyLeaf: error in "
+                          "reading leaf page "
+                       << next_page_id_;
+            return page_container_or_status.status();
+        }
+
+        auto page_container = page_container_or_status.value();
+        page_container->AquireReadLock();
+
+        auto leaf_page =
+            reinterpret_cast<BplusTreeLeafPage*>(page_container->GetData());
+        if (leaf_page->GetPageType() == PageType::PAGE_TYPE_BPLUS_LEAF &&
+            leaf_page->HasLowKey() &&
+            leaf_page->GetLowKey(buffer_manager_) == high_key_) {
+            LoadLeaf(page_container);
+        } else {
+            LOG(INFO) << "BplusTreeIterator::LoadNextNonEmptyLeaf: leaf "
+                      << next_page_id_ << " changed. seeking again";
+
+            buffer_manager_->UnpinPage(page_container);
+            page_container->ReleaseReadLock();
+
+            auto key = high_key_;
+            absl::string_view key_view = key;
+            auto leaf_or_status = FindLeaf(&key_view);
+            if (!leaf_or_status.ok()) {
+                LOG(ERROR) << "BplusTreeIterator::LoadNextNonEmptyLeaf: "
+                              "unable to find the leaf";
+                return leaf_or_status.status();
+            }
+
+            LoadLeaf(leaf_or_status.value());
+            entries_.erase(
+                entries_.begin(),
+                std::upper_bound(entries_.begin(), entries_.end(), key_view,
+                                 [this](absl::string_view key,
+                                        const BplusTreeEntry& entry) {
+                                     return tree_->comp_->Compare(
+                                                key, entry.key) < 0;
+                                 }));
+        }
+
+        index_ = 0;
+        if (!entries_.empty()) {
+            valid_ = true;
+            return absl::OkStatus();
+        }
+    }
+
+    return absl::OkStatus();
+}
+
+}  // namespace graphchaindb
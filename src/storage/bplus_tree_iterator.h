@@ -0,0 +1,94 @@
+#ifndef STORAGE_BPLUS_TREE_ITERATOR_H
+#define STORAGE_BPLUS_TREE_ITERATOR_H
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "bplus_tree.h"
+#include "iterator.h"
+#include "src/common/config.h"
+
+namespace graphchaindb {
+
+// A key-value pair of the B+ tree
+struct BplusTreeEntry {
+    std::string key;
+    std::string value;
+};
+
+// BplusTreeIterator iterates over the key-value pairs of a B+ tree in the
+// order of the keys by following the leaf chain.
+//
+// The entries of the current leaf are copied under its read latch, so no
+// latch or pin is held between the calls. Every leaf read is reported to the
+// buffer manager as part of a sequential scan which lets the following
+// leaves be read ahead.
+//
+// Entries move between neighbouring leaves when they are rebalanced after a
+// delete, and a leaf is removed from the chain when it is merged. The next
+// leaf only continues the current one if its low key is still the high key
+// the current leaf had. Otherwise the iterator descends again to the leaf
+// of the keys after that high key.
+//
+// It is not thread safe.
+class BplusTreeIterator : public Iterator<BplusTreeEntry> {
+   public:
+    explicit BplusTreeIterator(BplusTree* tree);
+
+    BplusTreeIterator(const BplusTreeIterator&) = delete;
+    BplusTreeIterator& operator=(const BplusTreeIterator&) = delete;
+
+    // Returns if the current position of the iterator is valid
+    bool IsValid() override;
+
+    // Seek to the entry with the smallest key
+    // Call IsValid() to ensure that the iterator is valid after the seek.
+    absl::Status SeekToFirst() override;
+
+    // Seek to the first entry whose key is equal or greater than the key of
+    // the given item. The value of the item is ignored.
+    // Call IsValid() to ensure that the iterator is valid after the seek.
+    absl::Status SeekEqOrGreaterTo(BplusTreeEntry* item) override;
+
+    // Move the iterator to the next position. The next position could be
+    // invalid, the caller must verify the validity by calling IsValid().
+    //
+    // REQUIRES: current position of the iterator must be valid.
+    absl::Status Next() override;
+
+    // Get the item at the current position
+    // REQUIRES: current position of the iterator must be valid.
+    absl::StatusOr<std::unique_ptr<BplusTreeEntry>> GetCurrent() override;
+
+   private:
+    // Descend from the root to the leaf which could contain the given key.
+    // The left most leaf is returned if key is nullptr.
+    //
+    // Returns the leaf pinned and read latched.
+    absl::StatusOr<Page*> FindLeaf(const absl::string_view* key);
+
+    // Copy the entries of the leaf, release its latch and unpin it.
+    //
+    // ASSUMES: read latch is held on the leaf page
+    void LoadLeaf(Page* page_container);
+
+    // Load the leaves following the current one until a non-empty leaf or
+    // the end of the chain is reached. Skips the entries up to the high key
+    // of the current leaf if the leaves changed in between.
+    absl::Status LoadNextNonEmptyLeaf();
+
+    BplusTree* tree_;
+    BufferManager* buffer_manager_;
+    std::vector<BplusTreeEntry> entries_;  // entries of the current leaf
+    page_id_t next_page_id_{INVALID_PAGE_ID};
+    std::string high_key_;  // of the current leaf if it has a next leaf
+    int index_{0};
+    bool valid_{false};
+};
+
+}  // namespace graphchaindb
+
+#endif  // STORAGE_BPLUS_TREE_ITERATOR_H
@@ -1,21 +1,78 @@
 #ifndef STORAGE_BPLUS_TREE_PAGE_H
 #define STORAGE_BPLUS_TREE_PAGE_H
 
+#include <glog/logging.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <string>
+
+#include "absl/strings/match.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/string_view.h"
 #include "page.h"
 #include "src/common/config.h"
 #include "string_container.h"
 
 namespace graphchaindb {
 
+class BufferManager;
+
+// A slot of the slot directory of a B+ tree page. It locates a cell.
+struct BplusTreeSlot {
+    uint16_t offset;  // from the start of the page
+    uint16_t size;
+};
+
 // A common page interface for the B+ tree.
 //
-// It contains the common header fields which all the
-// B+ tree page types have.
+// It contains the common header fields which all the B+ tree page types
+// have, and manages the cells of the page. The pages are slotted pages: the
+// slot directory follows the header of the page type and grows towards the
+// end of the page, while the cells it points to are packed from the end of
+// the page towards the start. The slots are in the order of the keys, the
+// cells in no particular order. A removed cell leaves a hole which is
+// reclaimed by compacting the cells once the free space in between runs out.
 //
 // Format (size in bytes)
-// -------------------------------------------------------------
+// ----------------------------------------------------------------------
+// | Header | Key Head 1 (4) | .. | Key Head N (4) | Slot 1 (4) | .. |
+// ----------------------------------------------------------------------
+// | Slot N (4) | Free | Cell N | .. | Cell 1 |
+// ----------------------------------------------------------------------
+//
+// The key heads are the first bytes of the key of each slot as an integer,
+// see GetKeyHead. They are kept apart from the slots so that a search scans
+// a contiguous array of integers, and only reads the keys whose heads are
+// equal to the head of the searched key.
+//
+// Header
+// ----------------------------------------------------------------------
 // | PageType (4) | PageId (4) | Parent PageId (4) | Count (4) |
-// -------------------------------------------------------------
+// ----------------------------------------------------------------------
+// | Right PageId (4) | High Key Slot (4) | Low Key Slot (4) |
+// ----------------------------------------------------------------------
+// | Prefix Slot (4) | Slots Offset (2) | Cells Offset (2) |
+// ----------------------------------------------------------------------
+// | Fragmented Bytes (2) | Padding (2) |
+// ----------------------------------------------------------------------
+//
+// The right page is the next page on the same level. The high key is the
+// largest key which belongs to the page, it is only valid if the page has a
+// right page. The low key is the high key of the page on the left, if there
+// is one. Every key of the page is larger than it. Both are stored in cells
+// of their own.
+//
+// The keys of the page all start with the common prefix of the low and high
+// key if the keys are ordered byte by byte. The prefix is stored once in a
+// cell of its own and stripped from the keys in the cells, see UpdatePrefix.
+//
+// Strings are stored in the cells as a length (2) followed by the data. The
+// strings longer than BPLUS_MAX_INLINE_STRING_SIZE are stored in a
+// StringContainer instead, which keeps the most of it in an overflow page.
+// Such a key is kept whole, prefix included, so that its cell stays valid
+// when the prefix of the page changes, see GetKeySize.
 //
 class BplusTreePage {
     friend class BplusTree;
@@ -28,15 +85,23 @@ class BplusTreePage {
 
     ~BplusTreePage() = default;
 
-    // init the page.
+    // init the page. slots_offset is the size of the header of the page
+    // type, where the slot directory starts.
     //
     // MUST be called after allocating the page and before doing anything useful
     void InitPage(page_id_t page_id, PageType page_type,
-                  page_id_t parent_page_id, int32_t count) {
+                  page_id_t parent_page_id, int32_t slots_offset) {
         page_id_ = page_id;
         page_type_ = page_type;
         parent_page_id_ = parent_page_id;
-        count_ = count;
+        count_ = 0;
+        right_page_id_ = INVALID_PAGE_ID;
+        high_key_ = {0, 0};
+        low_key_ = {0, 0};
+        prefix_ = {0, 0};
+        slots_offset_ = slots_offset;
+        cells_offset_ = PAGE_SIZE;
+        fragmented_bytes_ = 0;
     }
 
     // Get the page type
@@ -56,13 +121,585 @@ class BplusTreePage {
     // Get the count of keys written in the page
     int32_t GetCount() { return count_; }
 
+    // Get the right page id
+    page_id_t GetRightPageId() { return right_page_id_; }
+
+    // Set the right page id
+    void SetRightPageId(page_id_t right_page_id) {
+        right_page_id_ = right_page_id;
+    }
+
+    // Get the number of bytes available for the slots and cells
+    int GetCapacity() { return PAGE_SIZE - slots_offset_; }
+
+    // Get the number of free bytes, including the holes between the cells
+    int GetFreeSpace() {
+        return cells_offset_ - slotsEnd() + fragmented_bytes_;
+    }
+
+    // Get the number of bytes used by the slots and cells
+    int GetUsedSpace() { return GetCapacity() - GetFreeSpace(); }
+
+    // Get the high key
+    std::string GetHighKey(BufferManager* buffer_manager) {
+        return readString(PageData() + high_key_.offset, buffer_manager);
+    }
+
+    // Get the high key if it is stored in the page. Returns false if it is
+    // in an overflow page or the page is inconsistent.
+    //
+    // Safe to call while reading the page optimistically.
+    bool GetInlineHighKey(absl::string_view* key) {
+        return validCell(high_key_) &&
+               readInlineString(PageData() + high_key_.offset, high_key_.size,
+                                key);
+    }
+
+    // Set the high key. Returns false if there is no space for it.
+    bool SetHighKey(absl::string_view key, BufferManager* buffer_manager) {
+        return setKeyCell(&high_key_, key, buffer_manager);
+    }
+
+    // Returns if the page has a low key
+    bool HasLowKey() { return low_key_.size != 0; }
+
+    // Get the low key
+    // ASSUMES: The page has a low key
+    std::string GetLowKey(BufferManager* buffer_manager) {
+        return readString(PageData() + low_key_.offset, buffer_manager);
+    }
+
+    // Set the low key. Returns false if there is no space for it.
+    bool SetLowKey(absl::string_view key, BufferManager* buffer_manager) {
+        return setKeyCell(&low_key_, key, buffer_manager);
+    }
+
+    // Get the prefix which is stripped from the keys of the page
+    absl::string_view GetPrefix() {
+        return absl::string_view(PageData() + prefix_.offset, prefix_.size);
+    }
+
+    // Get the prefix which is stripped from the keys of the page. Returns
+    // false if the page is inconsistent.
+    //
+    // Safe to call while reading the page optimistically.
+    bool GetInlinePrefix(absl::string_view* prefix) {
+        if (prefix_.size != 0 && !validCell(prefix_)) {
+            return false;
+        }
+
+        *prefix = GetPrefix();
+        return true;
+    }
+
+    // Get the key head of the key, which is made of its first bytes in the
+    // order of an unsigned integer. The heads of two keys are ordered like
+    // the keys if the keys are ordered byte by byte, apart from the heads
+    // which are equal.
+    static uint32_t GetKeyHead(absl::string_view key) {
+        uint32_t head = 0;
+        for (size_t idx = 0; idx < sizeof(head); idx++) {
+            head <<= 8;
+            if (idx < key.size()) {
+                head |= static_cast<uint8_t>(key[idx]);
+            }
+        }
+        return head;
+    }
+
+    // Get the key heads of the keys of the page, without its prefix
+    const uint32_t* GetKeyHeads() { return KeyHeads(); }
+
+    // Get the first count key heads of the page. Returns nullptr if they
+    // aren't all in the page, i.e. the page is inconsistent.
+    //
+    // Safe to call while reading the page optimistically.
+    const uint32_t* GetInlineKeyHeads(int32_t count) {
+        if (count < 0 ||
+            slots_offset_ + count * sizeof(uint32_t) > PAGE_SIZE) {
+            return nullptr;
+        }
+        return KeyHeads();
+    }
+
+    // Get the number of bytes a string takes in a cell
+    static int GetStringSize(absl::string_view value) {
+        return sizeof(uint16_t) + (value.size() > BPLUS_MAX_INLINE_STRING_SIZE
+                                       ? sizeof(StringContainer)
+                                       : value.size());
+    }
+
+    // Get the number of bytes the key takes in a cell of a page whose prefix
+    // has the given size. Whether the key is stored in a StringContainer
+    // depends on its whole length, so no prefix moves it in or out of one.
+    static int GetKeySize(absl::string_view key, int prefix_size) {
+        return sizeof(uint16_t) + (key.size() > BPLUS_MAX_INLINE_STRING_SIZE
+                                       ? sizeof(StringContainer)
+                                       : key.size() - prefix_size);
+    }
+
+    // Returns if the slot directory lies within the page, which only fails
+    // for a page read optimistically.
+    bool HasValidSlots() {
+        return slots_offset_ <= PAGE_SIZE && count_ >= 0 &&
+               count_ <= PAGE_SIZE / DIRECTORY_ENTRY_SIZE &&
+               slotsEnd() <= PAGE_SIZE;
+    }
+
+    // the bytes a key takes in the slot directory
+    static constexpr int DIRECTORY_ENTRY_SIZE =
+        sizeof(uint32_t) + sizeof(BplusTreeSlot);
+
+   protected:
+    // the length of a string which is stored in a StringContainer
+    static constexpr uint16_t CONTAINER_STRING_LENGTH = UINT16_MAX;
+
+    char* PageData() { return reinterpret_cast<char*>(this); }
+
+    uint32_t* KeyHeads() {
+        return reinterpret_cast<uint32_t*>(PageData() + slots_offset_);
+    }
+
+    BplusTreeSlot* Slots() {
+        return reinterpret_cast<BplusTreeSlot*>(
+            PageData() + slots_offset_ + count_ * sizeof(uint32_t));
+    }
+
+    // Get the cell of the slot at the index, or nullptr if the slot points
+    // outside of the page, which only happens to a page read optimistically.
+    char* GetCell(int32_t index, int* size) {
+        auto slot = Slots()[index];
+        if (!validCell(slot)) {
+            return nullptr;
+        }
+
+        *size = slot.size;
+        return PageData() + slot.offset;
+    }
+
+    // Add a cell of the given size at the index of the slot directory, with
+    // the head of its key. Returns the cell, or nullptr if it doesn't fit in
+    // the page.
+    char* InsertCell(int32_t index, int size, uint32_t key_head) {
+        auto cell = allocateCell(size, DIRECTORY_ENTRY_SIZE);
+        if (cell == nullptr) {
+            return nullptr;
+        }
+
+        // the slots make room for the new key head first
+        auto slots = Slots();
+        auto new_slots = reinterpret_cast<BplusTreeSlot*>(
+            reinterpret_cast<char*>(slots) + sizeof(uint32_t));
+        memmove(new_slots + index + 1, slots + index,
+                (count_ - index) * sizeof(BplusTreeSlot));
+        memmove(new_slots, slots, index * sizeof(BplusTreeSlot));
+        new_slots[index] = {static_cast<uint16_t>(cell - PageData()),
+                            static_cast<uint16_t>(size)};
+
+        auto key_heads = KeyHeads();
+        memmove(key_heads + index + 1, key_heads + index,
+                (count_ - index) * sizeof(uint32_t));
+        key_heads[index] = key_head;
+        count_++;
+        return cell;
+    }
+
+    // Remove the cell of the slot at the index
+    void RemoveCell(int32_t index) {
+        auto slots = Slots();
+        freeCell(slots[index]);
+
+        auto key_heads = KeyHeads();
+        memmove(key_heads + index, key_heads + index + 1,
+                (count_ - index - 1) * sizeof(uint32_t));
+
+        // the slots take the place of the removed key head
+        auto new_slots = reinterpret_cast<BplusTreeSlot*>(
+            reinterpret_cast<char*>(slots) - sizeof(uint32_t));
+        memmove(new_slots, slots, index * sizeof(BplusTreeSlot));
+        memmove(new_slots + index, slots + index + 1,
+                (count_ - index - 1) * sizeof(BplusTreeSlot));
+        count_--;
+    }
+
+    // Move the cells from the index on to the end of the other page, which
+    // MUST have space for them
+    void MoveCellsTo(int32_t start, BplusTreePage* other) {
+        auto slots = Slots();
+        auto key_heads = KeyHeads();
+        for (int32_t idx = start; idx < count_; idx++) {
+            auto cell = other->InsertCell(other->count_, slots[idx].size,
+                                          key_heads[idx]);
+            memcpy(cell, PageData() + slots[idx].offset, slots[idx].size);
+            freeCell(slots[idx]);
+        }
+
+        // the slots follow the key heads which are left
+        memmove(key_heads + start, slots, start * sizeof(BplusTreeSlot));
+        count_ = start;
+    }
+
+    // Copy the high key of the page to the other page, which MUST have space
+    // for it
+    void CopyHighKeyTo(BplusTreePage* other) {
+        copyCellTo(high_key_, other, &other->high_key_);
+    }
+
+    // Copy the low key of the page to the other page, which MUST have space
+    // for it
+    void CopyLowKeyTo(BplusTreePage* other) {
+        copyCellTo(low_key_, other, &other->low_key_);
+    }
+
+    // Copy the prefix of the page to the other page, which MUST have space
+    // for it. The cells moved from the page to the other page are read with
+    // the prefix of the page.
+    void CopyPrefixTo(BplusTreePage* other) {
+        copyCellTo(prefix_, other, &other->prefix_);
+    }
+
+    // Copy the cells from start to end of the other page to the end of the
+    // page. The keys are read with the prefix of the other page and written
+    // without the prefix of the page. key_offset is where the key starts in
+    // the cells. The strings in overflow pages are shared with the other
+    // page, none are written.
+    //
+    // Returns false if they don't fit, after copying the cells which do.
+    // ASSUMES: The keys start with the prefix of the page
+    bool CopyCellsFrom(BplusTreePage* other, int32_t start, int32_t end,
+                       int key_offset, BufferManager* buffer_manager) {
+        auto other_prefix = other->GetPrefix();
+        auto other_slots = other->Slots();
+        auto other_key_heads = other->KeyHeads();
+        std::string prefix(GetPrefix());
+        for (int32_t idx = start; idx < end; idx++) {
+            auto other_cell = other->PageData() + other_slots[idx].offset;
+            auto other_key = other_cell + key_offset;
+
+            // the cell is copied as is if the prefixes are the same, or if
+            // the key is kept whole in a container
+            bool is_container =
+                readLength(other_key) == CONTAINER_STRING_LENGTH;
+            if (other_prefix == prefix || is_container) {
+                auto key_head = other_key_heads[idx];
+                if (other_prefix != prefix) {
+                    auto key = absl::StrCat(
+                        other_prefix,
+                        other->readKeySuffix(other_key, buffer_manager));
+                    key_head = GetKeyHead(
+                        absl::string_view(key).substr(prefix.size()));
+                }
+
+                auto cell = InsertCell(count_, other_slots[idx].size,
+                                       key_head);
+                if (cell == nullptr) {
+                    return false;
+                }
+                memcpy(cell, other_cell, other_slots[idx].size);
+                continue;
+            }
+
+            auto other_key_size = stringSize(other_key);
+            auto tail_size =
+                other_slots[idx].size - key_offset - other_key_size;
+
+            auto key = absl::StrCat(other_prefix,
+                                    readString(other_key, buffer_manager));
+            CHECK(absl::StartsWith(key, prefix));
+            auto suffix = absl::string_view(key).substr(prefix.size());
+
+            auto cell = InsertCell(
+                count_, key_offset + GetKeySize(key, prefix.size()) + tail_size,
+                GetKeyHead(suffix));
+            if (cell == nullptr) {
+                return false;
+            }
+
+            memcpy(cell, other_cell, key_offset);
+            auto tail = writeKey(cell + key_offset, key, buffer_manager);
+            memcpy(tail, other_key + other_key_size, tail_size);
+        }
+        return true;
+    }
+
+    // Strip the common prefix of the low and high key from the keys of the
+    // page. key_offset is where the key starts in the cells. The prefix is
+    // empty if the page lacks one of them.
+    //
+    // Returns false and keeps the current prefix if the keys don't fit in
+    // the page with the new prefix.
+    // ASSUMES: The keys are ordered byte by byte
+    bool UpdatePrefix(int key_offset, BufferManager* buffer_manager) {
+        std::string prefix;
+        if (HasLowKey() && right_page_id_ != INVALID_PAGE_ID) {
+            auto low_key = GetLowKey(buffer_manager);
+            auto high_key = GetHighKey(buffer_manager);
+            auto length = std::min({low_key.size(), high_key.size(),
+                                    static_cast<size_t>(
+                                        BPLUS_MAX_INLINE_STRING_SIZE)});
+            auto mismatch = std::mismatch(low_key.begin(),
+                                          low_key.begin() + length,
+                                          high_key.begin());
+            prefix = low_key.substr(0, mismatch.first - low_key.begin());
+        }
+
+        if (prefix == GetPrefix()) {
+            return true;
+        }
+        return replacePrefix(prefix, key_offset, buffer_manager);
+    }
+
+    // Get the index which splits the cells into two halves of about the same
+    // number of bytes. Both halves have at least one cell.
+    //
+    // ASSUMES: The page has at least two cells
+    int32_t GetSplitIndex() {
+        auto slots = Slots();
+        int total = 0;
+        for (int32_t idx = 0; idx < count_; idx++) {
+            total += slots[idx].size;
+        }
+
+        int32_t split_index = 0;
+        for (int left = 0; left < total / 2 && split_index < count_ - 1;) {
+            left += slots[split_index++].size;
+        }
+        return std::max(split_index, 1);
+    }
+
+    // Write the string to the cell. Returns where the string ends.
+    //
+    // A container is set up aside and copied into the cell, since cells
+    // aren't aligned.
+    static char* writeString(char* cell, absl::string_view value,
+                             BufferManager* buffer_manager) {
+        if (value.size() > BPLUS_MAX_INLINE_STRING_SIZE) {
+            writeLength(cell, CONTAINER_STRING_LENGTH);
+            StringContainer container;
+            container.SetStringData(buffer_manager, value);
+            memcpy(cell + sizeof(uint16_t), &container,
+                   sizeof(StringContainer));
+            return cell + sizeof(uint16_t) + sizeof(StringContainer);
+        }
+
+        writeLength(cell, value.size());
+        memcpy(cell + sizeof(uint16_t), value.data(), value.size());
+        return cell + sizeof(uint16_t) + value.size();
+    }
+
+    // Read the string written at the cell
+    static std::string readString(char* cell, BufferManager* buffer_manager) {
+        auto length = readLength(cell);
+        if (length == CONTAINER_STRING_LENGTH) {
+            StringContainer container;
+            memcpy(&container, cell + sizeof(uint16_t),
+                   sizeof(StringContainer));
+            return container.GetStringData(buffer_manager);
+        }
+        return std::string(cell + sizeof(uint16_t), length);
+    }
+
+    // Write the key to the cell of a key of the page, whole if it is kept in
+    // a container and else without the prefix, see GetKeySize. Returns
+    // where the key ends.
+    //
+    // ASSUMES: The key starts with the prefix of the page
+    char* writeKey(char* cell, absl::string_view key,
+                   BufferManager* buffer_manager) {
+        if (key.size() > BPLUS_MAX_INLINE_STRING_SIZE) {
+            return writeString(cell, key, buffer_manager);
+        }
+        return writeString(cell, key.substr(prefix_.size), buffer_manager);
+    }
+
+    // Read the key written at the cell of a key of the page without the
+    // prefix, see writeKey
+    std::string readKeySuffix(char* cell, BufferManager* buffer_manager) {
+        auto key = readString(cell, buffer_manager);
+        if (readLength(cell) == CONTAINER_STRING_LENGTH) {
+            key.erase(0, prefix_.size);
+        }
+        return key;
+    }
+
+    // Read the string written at the cell if it is stored inline and fits
+    // in the given number of bytes.
+    static bool readInlineString(char* cell, int size,
+                                 absl::string_view* value) {
+        if (size < static_cast<int>(sizeof(uint16_t))) {
+            return false;
+        }
+
+        auto length = readLength(cell);
+        if (length == CONTAINER_STRING_LENGTH ||
+            length + static_cast<int>(sizeof(uint16_t)) > size) {
+            return false;
+        }
+
+        *value = absl::string_view(cell + sizeof(uint16_t), length);
+        return true;
+    }
+
+    // Get the number of bytes the string written at the cell takes
+    static int stringSize(char* cell) {
+        auto length = readLength(cell);
+        return sizeof(uint16_t) + (length == CONTAINER_STRING_LENGTH
+                                       ? sizeof(StringContainer)
+                                       : length);
+    }
+
    private:
+    static uint16_t readLength(char* cell) {
+        uint16_t length;
+        memcpy(&length, cell, sizeof(length));
+        return length;
+    }
+
+    static void writeLength(char* cell, uint16_t length) {
+        memcpy(cell, &length, sizeof(length));
+    }
+
+    // Write the key to a cell of its own, which the slot locates
+    bool setKeyCell(BplusTreeSlot* slot, absl::string_view key,
+                    BufferManager* buffer_manager) {
+        freeCell(*slot);
+        *slot = {0, 0};
+
+        auto size = GetStringSize(key);
+        auto cell = allocateCell(size);
+        if (cell == nullptr) {
+            return false;
+        }
+
+        writeString(cell, key, buffer_manager);
+        *slot = {static_cast<uint16_t>(cell - PageData()),
+                 static_cast<uint16_t>(size)};
+        return true;
+    }
+
+    // Copy the cell without a slot in the directory to the other page, which
+    // MUST have space for it
+    void copyCellTo(BplusTreeSlot slot, BplusTreePage* other,
+                    BplusTreeSlot* other_slot) {
+        other->freeCell(*other_slot);
+        *other_slot = {0, 0};
+        if (slot.size == 0) {
+            return;
+        }
+
+        auto cell = other->allocateCell(slot.size);
+        memcpy(cell, PageData() + slot.offset, slot.size);
+        *other_slot = {static_cast<uint16_t>(cell - other->PageData()),
+                       slot.size};
+    }
+
+    // Write the cells again with the keys stripped of the given prefix
+    // instead of the current one
+    bool replacePrefix(absl::string_view prefix, int key_offset,
+                       BufferManager* buffer_manager) {
+        alignas(BplusTreePage) char old_data[PAGE_SIZE];
+        memcpy(old_data, PageData(), PAGE_SIZE);
+        auto old_page = reinterpret_cast<BplusTreePage*>(old_data);
+        auto old_count = count_;
+
+        count_ = 0;
+        cells_offset_ = PAGE_SIZE;
+        fragmented_bytes_ = 0;
+        high_key_ = {0, 0};
+        low_key_ = {0, 0};
+        old_page->copyCellTo(old_page->high_key_, this, &high_key_);
+        old_page->copyCellTo(old_page->low_key_, this, &low_key_);
+        prefix_ = {0, 0};
+        if (!prefix.empty()) {
+            auto cell = allocateCell(prefix.size());
+            memcpy(cell, prefix.data(), prefix.size());
+            prefix_ = {static_cast<uint16_t>(cell - PageData()),
+                       static_cast<uint16_t>(prefix.size())};
+        }
+
+        if (!CopyCellsFrom(old_page, 0, old_count, key_offset,
+                           buffer_manager)) {
+            memcpy(PageData(), old_data, PAGE_SIZE);
+            return false;
+        }
+        return true;
+    }
+
+    int slotsEnd() {
+        return slots_offset_ + count_ * DIRECTORY_ENTRY_SIZE;
+    }
+
+    bool validCell(BplusTreeSlot slot) {
+        return slot.offset >= slots_offset_ &&
+               slot.offset + slot.size <= PAGE_SIZE;
+    }
+
+    // Take the bytes for a cell from the free space, leaving the given
+    // number of bytes for the slot directory to grow. Compacts the cells if
+    // needed. Returns nullptr if there isn't enough free space.
+    char* allocateCell(int size, int slot_size = 0) {
+        if (GetFreeSpace() < size + slot_size) {
+            return nullptr;
+        }
+        if (cells_offset_ - slotsEnd() < size + slot_size) {
+            compact();
+        }
+
+        cells_offset_ -= size;
+        return PageData() + cells_offset_;
+    }
+
+    void freeCell(BplusTreeSlot slot) {
+        if (slot.size == 0) {
+            return;
+        }
+
+        if (slot.offset == cells_offset_) {
+            cells_offset_ += slot.size;
+        } else {
+            fragmented_bytes_ += slot.size;
+        }
+    }
+
+    // Pack the cells at the end of the page again, which merges the holes
+    // left by the removed cells into the free space.
+    void compact() {
+        char cells[PAGE_SIZE];
+        int offset = PAGE_SIZE;
+        auto move_cell = [&](BplusTreeSlot* slot) {
+            offset -= slot->size;
+            memcpy(cells + offset, PageData() + slot->offset, slot->size);
+            slot->offset = offset;
+        };
+
+        auto slots = Slots();
+        for (int32_t idx = 0; idx < count_; idx++) {
+            move_cell(&slots[idx]);
+        }
+        for (auto slot : {&high_key_, &low_key_, &prefix_}) {
+            if (slot->size != 0) {
+                move_cell(slot);
+            }
+        }
+
+        memcpy(PageData() + offset, cells + offset, PAGE_SIZE - offset);
+        cells_offset_ = offset;
+        fragmented_bytes_ = 0;
+    }
+
     PageType page_type_;
     page_id_t page_id_;
     page_id_t parent_page_id_;
     int32_t count_{0};
+    page_id_t right_page_id_;
+    BplusTreeSlot high_key_;
+    BplusTreeSlot low_key_;
+    BplusTreeSlot prefix_;
+    uint16_t slots_offset_;
+    uint16_t cells_offset_;
+    uint16_t fragmented_bytes_;
 };
 
 }  // namespace graphchaindb
 
-#endif  // STORAGE_BPLUS_TREE_PAGE_H
\ No newline at end of file
+#endif  // STORAGE_BPLUS_TREE_PAGE_H
@@ -3,30 +3,55 @@
 
 #include <gtest/gtest_prod.h>
 
+#include <cstring>
+#include <string>
+
+#include "absl/strings/str_cat.h"
+#include "absl/strings/string_view.h"
 #include "bplus_tree_page.h"
 #include "src/common/config.h"
 
 namespace graphchaindb {
 
-// TODO: update this offset once the header format is decided.
-#define BPLUS_TREE_INTERNAL_PAGE_DATA_OFFSET 24
-
 // The internal page of a B+ tree which stores the key and child page ids.
 //
+// Every key is a cell of the slotted page together with the child right of
+// it, see BplusTreePage. The child left of the first key is in the header.
+//
 // Format (size in bytes):
-// -----------------------------------------------
-// | Headers (16) | PageId (4) | Key 1 (64) | .. |
-// -----------------------------------------------
+// -------------------------------------------------------------------
+// | Headers (44) | Key Head 1 (4) | .. | Slot 1 (4) | .. | Free | .. |
+// -------------------------------------------------------------------
+// | Key 1 Cell | .. |
+// -------------------------------------------------------------------
 //
 // Header
-// -------------------------------------------------------------
+// ----------------------------------------------------------------------
 // | PageType (4) | PageId (4) | Parent PageId (4) | Count (4) |
-// -------------------------------------------------------------
+// ----------------------------------------------------------------------
+// | Right PageId (4) | High Key Slot (4) | Low Key Slot (4) |
+// ----------------------------------------------------------------------
+// | Prefix Slot (4) | Slots Offset (2) | Cells Offset (2) |
+// ----------------------------------------------------------------------
+// | Fragmented Bytes (2) | Padding (2) | PageId (4) |
+// ----------------------------------------------------------------------
+//
+// Cell
+// -----------------------------------------------------
+// | PageId (4) | Key Suffix Length (2) | Key Suffix |
+// -----------------------------------------------------
+//
+// The key suffix is the key without the prefix of the page.
 //
 class BplusTreeInternalPage : public BplusTreePage {
     friend class BplusTree;
+    friend class BplusTreeIterator;
 
    public:
+    // the largest cell of a key and child
+    static constexpr int MAX_CELL_SIZE = sizeof(page_id_t) + sizeof(uint16_t) +
+                                         BPLUS_MAX_INLINE_STRING_SIZE;
+
     BplusTreeInternalPage() = default;
 
     BplusTreeInternalPage(const BplusTreeInternalPage&) = delete;
@@ -39,29 +64,115 @@ class BplusTreeInternalPage : public BplusTreePage {
     // MUST be called after allocating the page and before doing anything useful
     void InitPage(page_id_t page_id, PageType page_type,
                   page_id_t parent_page_id) {
-        BplusTreePage::InitPage(page_id, page_type, parent_page_id, 0);
-
-        // TODO: set all children to invalid page id
+        BplusTreePage::InitPage(page_id, page_type, parent_page_id,
+                                sizeof(BplusTreeInternalPage));
+        first_child_ = INVALID_PAGE_ID;
     }
 
-    // Returns if the page is full
+    // Returns if the page is full, i.e. a key might not fit in it anymore
     bool IsFull() {
-        return BplusTreePage::GetCount() + 1 == BPLUS_INTERNAL_KEY_PAGE_ID_SIZE;
+        return GetFreeSpace() < MAX_CELL_SIZE + DIRECTORY_ENTRY_SIZE;
     }
 
-    // Returns if the page is less than half full
-    bool IsLessThanHalfFull() {
-        // TODO: implement
-        return BplusTreePage::GetCount() + 1 == BPLUS_INTERNAL_KEY_PAGE_ID_SIZE;
+    // Returns if less than BPLUS_MIN_FILL_PERCENT of the page is used
+    bool IsUnderfull() {
+        return GetUsedSpace() * 100 < GetCapacity() * BPLUS_MIN_FILL_PERCENT;
+    }
+
+    // Returns if the page doesn't become underfull when a key is removed
+    bool IsSafeForDelete() {
+        return (GetUsedSpace() - MAX_CELL_SIZE - DIRECTORY_ENTRY_SIZE) * 100 >=
+               GetCapacity() * BPLUS_MIN_FILL_PERCENT;
+    }
+
+    // Get the key at the index
+    std::string GetKey(int32_t index, BufferManager* buffer_manager) {
+        return absl::StrCat(GetPrefix(), GetKeySuffix(index, buffer_manager));
+    }
+
+    // Get the key at the index without the prefix of the page
+    std::string GetKeySuffix(int32_t index, BufferManager* buffer_manager) {
+        auto cell = PageData() + Slots()[index].offset;
+        return readKeySuffix(cell + sizeof(page_id_t), buffer_manager);
+    }
+
+    // Get the key at the index without the prefix of the page if it is
+    // stored in the page. Returns false if it is in an overflow page or the
+    // page is inconsistent.
+    //
+    // Safe to call while reading the page optimistically.
+    bool GetInlineKeySuffix(int32_t index, absl::string_view* suffix) {
+        int size;
+        auto cell = GetCell(index, &size);
+        return cell != nullptr && size >= static_cast<int>(sizeof(page_id_t)) &&
+               readInlineString(cell + sizeof(page_id_t),
+                                size - sizeof(page_id_t), suffix);
+    }
+
+    // Get the child at the index (0 based), which is left of the key at the
+    // index. Returns INVALID_PAGE_ID if the page is inconsistent.
+    //
+    // Safe to call while reading the page optimistically.
+    page_id_t GetChild(int32_t index) {
+        if (index == 0) {
+            return first_child_;
+        }
+
+        int size;
+        auto cell = GetCell(index - 1, &size);
+        if (cell == nullptr || size < static_cast<int>(sizeof(page_id_t))) {
+            return INVALID_PAGE_ID;
+        }
+
+        page_id_t child;
+        memcpy(&child, cell, sizeof(child));
+        return child;
+    }
+
+    // Set the child at the index (0 based)
+    void SetChild(int32_t index, page_id_t child) {
+        if (index == 0) {
+            first_child_ = child;
+            return;
+        }
+        memcpy(PageData() + Slots()[index - 1].offset, &child, sizeof(child));
+    }
+
+    // Insert the key at the index with the child right of it. Returns false
+    // if it doesn't fit.
+    //
+    // ASSUMES: The key starts with the prefix of the page
+    bool Insert(int32_t index, absl::string_view key, page_id_t right_child,
+                BufferManager* buffer_manager) {
+        auto suffix = key.substr(GetPrefix().size());
+        auto cell = InsertCell(
+            index, sizeof(page_id_t) + GetKeySize(key, GetPrefix().size()),
+            GetKeyHead(suffix));
+        if (cell == nullptr) {
+            return false;
+        }
+
+        memcpy(cell, &right_child, sizeof(right_child));
+        writeKey(cell + sizeof(page_id_t), key, buffer_manager);
+        return true;
+    }
+
+    // Remove the key at the index together with the child right of it
+    void Remove(int32_t index) { RemoveCell(index); }
+
+    // Strip the common prefix of the low and high key from the keys, see
+    // BplusTreePage::UpdatePrefix
+    bool UpdatePrefix(BufferManager* buffer_manager) {
+        return BplusTreePage::UpdatePrefix(
+            /* key_offset */ sizeof(page_id_t), buffer_manager);
     }
 
    private:
     FRIEND_TEST(BplusTreeTest, SplitChildLeafSucceeds);
 
-    StringContainer keys_[BPLUS_INTERNAL_KEY_PAGE_ID_SIZE];
-    page_id_t children_[BPLUS_INTERNAL_KEY_PAGE_ID_SIZE + 1];
+    page_id_t first_child_;
 };
 
 }  // namespace graphchaindb
 
-#endif  // STORAGE_BPLUS_TREE_PAGE_INTERNAL_H
\ No newline at end of file
+#endif  // STORAGE_BPLUS_TREE_PAGE_INTERNAL_H
@@ -4,39 +4,54 @@
 #include <glog/logging.h>
 #include <gtest/gtest_prod.h>
 
+#include <string>
+
+#include "absl/strings/str_cat.h"
+#include "absl/strings/string_view.h"
 #include "bplus_tree_page.h"
 #include "src/common/config.h"
 
 namespace graphchaindb {
 
-// TODO: update this offset once the header format is decided.
-#define BPLUS_TREE_LEAF_PAGE_DATA_OFFSET 24
-
-// A container for holding string key and value pairs.
-// Both the key and value are fixed sized.
-//
-// Total size: 128 bytes
-struct BplusTreeKeyValuePair {
-    StringContainer key;
-    StringContainer value;
-};
-
 // The leaf page of a B+ tree which stores the actual key value pair.
 //
+// Every pair is a cell of the slotted page, see BplusTreePage.
+//
 // Format (size in bytes):
-// ----------------------------------------------
-// | Headers (20) | Key 1 + Value 1 (128) | ... |
-// ----------------------------------------------
+// -------------------------------------------------------------------------
+// | Headers (40) | Key Head 1 (4) | .. | Slot 1 (4) | .. | Free | .. |
+// -------------------------------------------------------------------------
+// | Key 1 + Value 1 Cell | .. |
+// -------------------------------------------------------------------------
 //
 // Header
-// --------------------------------------------------------------------------
+// ----------------------------------------------------------------------
 // | PageType(4) | PageId(4) | Parent PageId(4) | Count(4) | Next PageId(4) |
-// --------------------------------------------------------------------------
+// ----------------------------------------------------------------------
+// | High Key Slot (4) | Low Key Slot (4) | Prefix Slot (4) |
+// ----------------------------------------------------------------------
+// | Slots Offset (2) | Cells Offset (2) | Fragmented Bytes (2) |
+// ----------------------------------------------------------------------
+// | Padding (2) |
+// ----------------------------------------------------------------------
+//
+// Cell
+// -------------------------------------------------------------------
+// | Key Suffix Length (2) | Key Suffix | Value Length (2) | Value |
+// -------------------------------------------------------------------
+//
+// The next page is the right page of the leaf. The key suffix is the key
+// without the prefix of the page.
 //
 class BplusTreeLeafPage : public BplusTreePage {
     friend class BplusTree;
+    friend class BplusTreeIterator;
 
    public:
+    // the largest cell of a pair
+    static constexpr int MAX_CELL_SIZE =
+        2 * (sizeof(uint16_t) + BPLUS_MAX_INLINE_STRING_SIZE);
+
     BplusTreeLeafPage() = default;
 
     BplusTreeLeafPage(const BplusTreeLeafPage&) = delete;
@@ -50,34 +65,92 @@ class BplusTreeLeafPage : public BplusTreePage {
     void InitPage(page_id_t page_id, PageType page_type,
                   page_id_t parent_page_id,
                   page_id_t next_page_id = INVALID_PAGE_ID) {
-        BplusTreePage::InitPage(page_id, page_type, parent_page_id, 0);
-        next_page_id_ = next_page_id;
+        BplusTreePage::InitPage(page_id, page_type, parent_page_id,
+                                sizeof(BplusTreeLeafPage));
+        SetNextPageId(next_page_id);
     }
 
     // set the next page id
-    void SetNextPageId(page_id_t next_page_id);
+    void SetNextPageId(page_id_t next_page_id) { SetRightPageId(next_page_id); }
 
-    page_id_t GetNextPageId() { return next_page_id_; }
+    page_id_t GetNextPageId() { return GetRightPageId(); }
 
-    // Returns if the page is full
+    // Returns if the page is full, i.e. a pair might not fit in it anymore
     bool IsFull() {
-        return BplusTreePage::GetCount() == BPLUS_LEAF_KEY_VALUE_SIZE;
+        return GetFreeSpace() < MAX_CELL_SIZE + DIRECTORY_ENTRY_SIZE;
+    }
+
+    // Returns if less than BPLUS_MIN_FILL_PERCENT of the page is used
+    bool IsUnderfull() {
+        return GetUsedSpace() * 100 < GetCapacity() * BPLUS_MIN_FILL_PERCENT;
     }
 
-    // Returns if the page is less than half full
-    bool IsLessThanHalfFull() {
-        // TODO: implement
-        return BplusTreePage::GetCount() == BPLUS_LEAF_KEY_VALUE_SIZE;
+    // Returns if the page doesn't become underfull when a pair is removed
+    bool IsSafeForDelete() {
+        return (GetUsedSpace() - MAX_CELL_SIZE - DIRECTORY_ENTRY_SIZE) * 100 >=
+               GetCapacity() * BPLUS_MIN_FILL_PERCENT;
+    }
+
+    // Get the key of the pair at the index
+    std::string GetKey(int32_t index, BufferManager* buffer_manager) {
+        return absl::StrCat(GetPrefix(), GetKeySuffix(index, buffer_manager));
+    }
+
+    // Get the key of the pair at the index without the prefix of the page
+    std::string GetKeySuffix(int32_t index, BufferManager* buffer_manager) {
+        return readKeySuffix(PageData() + Slots()[index].offset,
+                             buffer_manager);
+    }
+
+    // Get the key of the pair at the index without the prefix of the page if
+    // it is stored in the page. Returns false if it is in an overflow page or
+    // the page is inconsistent.
+    //
+    // Safe to call while reading the page optimistically.
+    bool GetInlineKeySuffix(int32_t index, absl::string_view* suffix) {
+        int size;
+        auto cell = GetCell(index, &size);
+        return cell != nullptr && readInlineString(cell, size, suffix);
+    }
+
+    // Get the value of the pair at the index
+    std::string GetValue(int32_t index, BufferManager* buffer_manager) {
+        auto cell = PageData() + Slots()[index].offset;
+        return readString(cell + stringSize(cell), buffer_manager);
+    }
+
+    // Insert the pair at the index. Returns false if it doesn't fit.
+    //
+    // ASSUMES: The key starts with the prefix of the page
+    bool Insert(int32_t index, absl::string_view key, absl::string_view value,
+                BufferManager* buffer_manager) {
+        auto suffix = key.substr(GetPrefix().size());
+        auto cell = InsertCell(
+            index,
+            GetKeySize(key, GetPrefix().size()) + GetStringSize(value),
+            GetKeyHead(suffix));
+        if (cell == nullptr) {
+            return false;
+        }
+
+        cell = writeKey(cell, key, buffer_manager);
+        writeString(cell, value, buffer_manager);
+        return true;
+    }
+
+    // Remove the pair at the index
+    void Remove(int32_t index) { RemoveCell(index); }
+
+    // Strip the common prefix of the low and high key from the keys, see
+    // BplusTreePage::UpdatePrefix
+    bool UpdatePrefix(BufferManager* buffer_manager) {
+        return BplusTreePage::UpdatePrefix(/* key_offset */ 0, buffer_manager);
     }
 
    private:
     FRIEND_TEST(BplusTreeTest, SplitChildLeafSucceeds);
-
-    page_id_t next_page_id_;
-    BplusTreeKeyValuePair
-        data_[BPLUS_LEAF_KEY_VALUE_SIZE];  // array of key value pairs
 };
 
 }  // namespace graphchaindb
 
-#endif  // STORAGE_BPLUS_TREE_PAGE_LEAF_H
\ No newline at end of file
+#endif  // STORAGE_BPLUS_TREE_PAGE_LEAF_H
@@ -0,0 +1,223 @@
+#ifndef STORAGE_BPLUS_TREE_SEARCH_H
+#define STORAGE_BPLUS_TREE_SEARCH_H
+
+#include <cstdint>
+#include <string>
+
+#include "absl/strings/match.h"
+#include "absl/strings/string_view.h"
+#include "bplus_tree_page.h"
+#include "key_comparator.h"
+#include "key_head_search.h"
+#include "string_container.h"
+
+namespace graphchaindb {
+
+class BufferManager;
+
+// Compare the key with the key stored in the container. The stored key is
+// only copied out of the container if a part of it is in an overflow page.
+inline int CompareStoredKey(KeyComparator* comp, BufferManager* buffer_manager,
+                            absl::string_view key,
+                            StringContainer* stored_key) {
+    absl::string_view inline_key;
+    if (stored_key->GetInlineStringData(&inline_key)) {
+        return comp->Compare(key, inline_key);
+    }
+    return comp->Compare(key, stored_key->GetStringData(buffer_manager));
+}
+
+// Compare the suffix of a key with the key suffix at the index of the B+
+// tree page, see BplusTreePage::GetPrefix. The stored suffix is only copied
+// out of the page if it is in an overflow page.
+template <typename BplusTreePageType>
+int CompareKeySuffixAt(KeyComparator* comp, BufferManager* buffer_manager,
+                       absl::string_view suffix, BplusTreePageType* page,
+                       int32_t index) {
+    absl::string_view inline_suffix;
+    if (page->GetInlineKeySuffix(index, &inline_suffix)) {
+        return comp->Compare(suffix, inline_suffix);
+    }
+    return comp->Compare(suffix, page->GetKeySuffix(index, buffer_manager));
+}
+
+// Compare the key with the key at the index of the B+ tree page.
+template <typename BplusTreePageType>
+int CompareKeyAt(KeyComparator* comp, BufferManager* buffer_manager,
+                 absl::string_view key, BplusTreePageType* page,
+                 int32_t index) {
+    // all the keys of the page start with the prefix, so a key which
+    // doesn't compares with all of them as it compares with the prefix.
+    auto prefix = page->GetPrefix();
+    if (!absl::StartsWith(key, prefix)) {
+        return comp->Compare(key, prefix);
+    }
+    return CompareKeySuffixAt(comp, buffer_manager,
+                              key.substr(prefix.size()), page, index);
+}
+
+// Compare the head of a key with a key head, see BplusTreePage::GetKeyHead.
+// Returns 0 if the heads are equal, which doesn't mean the keys are.
+inline int CompareKeyHead(uint32_t key_head, uint32_t stored_key_head) {
+    if (key_head == stored_key_head) {
+        return 0;
+    }
+    return key_head < stored_key_head ? -1 : 1;
+}
+
+// Compare the key with the high key of the B+ tree page, which MUST have a
+// right page.
+inline int CompareHighKey(KeyComparator* comp, BufferManager* buffer_manager,
+                          absl::string_view key, BplusTreePage* page) {
+    absl::string_view inline_key;
+    if (page->GetInlineHighKey(&inline_key)) {
+        return comp->Compare(key, inline_key);
+    }
+    return comp->Compare(key, page->GetHighKey(buffer_manager));
+}
+
+// Get the shortest key which isn't smaller than the left key and is smaller
+// than the right key, in byte order. It is a prefix of the right key unless
+// that only fits the left key itself.
+//
+// ASSUMES: left < right
+inline std::string ShortestSeparator(absl::string_view left,
+                                     absl::string_view right) {
+    size_t common = 0;
+    while (common < left.size() && common < right.size() &&
+           left[common] == right[common]) {
+        common++;
+    }
+
+    // the prefix of the right key up to the first differing byte is larger
+    // than the left key, and smaller than the right key if it is shorter.
+    if (common + 1 < right.size()) {
+        return std::string(right.substr(0, common + 1));
+    }
+    return std::string(left);
+}
+
+// Binary search for the first of the count sorted keys which isn't smaller
+// than the key. compare_at(idx) compares the key with the key at idx, like
+// KeyComparator::Compare.
+//
+// Returns count if all of the keys are smaller. found is set if the key at
+// the returned index is equal to the key.
+template <typename CompareAt>
+int32_t LowerBoundKey(int32_t count, CompareAt compare_at,
+                      bool* found = nullptr) {
+    int32_t low = 0;
+    int32_t high = count;
+    bool equal = false;
+    while (low < high) {
+        int32_t mid = low + (high - low) / 2;
+        int comp_result = compare_at(mid);
+        if (comp_result > 0) {
+            low = mid + 1;
+        } else {
+            high = mid;
+            equal = comp_result == 0;
+        }
+    }
+
+    if (found != nullptr) {
+        *found = equal;
+    }
+    return low;
+}
+
+// Binary search for the first key of the B+ tree page which isn't smaller
+// than the key. The prefix of the page is compared only once. For a
+// bytewise comparator the key heads are searched first, see SearchKeyHeads,
+// and only the keys whose heads are equal to the head of the key compared.
+//
+// Returns the count of the page if all of the keys are smaller. found is set
+// if the key at the returned index is equal to the key.
+template <typename BplusTreePageType>
+int32_t LowerBoundKeyInPage(KeyComparator* comp, BufferManager* buffer_manager,
+                            absl::string_view key, BplusTreePageType* page,
+                            bool* found = nullptr) {
+    auto prefix = page->GetPrefix();
+    if (!absl::StartsWith(key, prefix)) {
+        if (found != nullptr) {
+            *found = false;
+        }
+        return comp->Compare(key, prefix) < 0 ? 0 : page->GetCount();
+    }
+
+    auto suffix = key.substr(prefix.size());
+    if (!comp->IsBytewise()) {
+        return LowerBoundKey(
+            page->GetCount(),
+            [&](int32_t idx) {
+                return CompareKeySuffixAt(comp, buffer_manager, suffix, page,
+                                          idx);
+            },
+            found);
+    }
+
+    auto range = SearchKeyHeads(page->GetKeyHeads(), page->GetCount(),
+                                BplusTreePage::GetKeyHead(suffix));
+    auto index = LowerBoundKey(
+        range.upper - range.lower,
+        [&](int32_t idx) {
+            return CompareKeySuffixAt(comp, buffer_manager, suffix, page,
+                                      range.lower + idx);
+        },
+        found);
+    return range.lower + index;
+}
+
+// LowerBoundKeyInPage for a page which is read optimistically, with the
+// count read from it. Never follows the overflow pages, so it may compare
+// garbage but never reads outside of the page.
+//
+// Returns false if one of the compared keys isn't stored inline.
+template <typename BplusTreePageType>
+bool LowerBoundInlineKey(KeyComparator* comp, absl::string_view key,
+                         BplusTreePageType* page, int32_t count,
+                         int32_t* index) {
+    absl::string_view prefix;
+    if (!page->GetInlinePrefix(&prefix)) {
+        return false;
+    }
+    if (!absl::StartsWith(key, prefix)) {
+        *index = comp->Compare(key, prefix) < 0 ? 0 : count;
+        return true;
+    }
+
+    auto suffix = key.substr(prefix.size());
+    int32_t low = 0;
+    int32_t high = count;
+    if (comp->IsBytewise()) {
+        auto key_heads = page->GetInlineKeyHeads(count);
+        if (key_heads == nullptr) {
+            return false;
+        }
+        auto range = SearchKeyHeads(key_heads, count,
+                                    BplusTreePage::GetKeyHead(suffix));
+        low = range.lower;
+        high = range.upper;
+    }
+
+    absl::string_view stored_suffix;
+    while (low < high) {
+        int32_t mid = low + (high - low) / 2;
+        if (!page->GetInlineKeySuffix(mid, &stored_suffix)) {
+            return false;
+        }
+
+        if (comp->Compare(suffix, stored_suffix) > 0) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+
+    *index = low;
+    return true;
+}
+
+}  // namespace graphchaindb
+
+#endif  // STORAGE_BPLUS_TREE_SEARCH_H
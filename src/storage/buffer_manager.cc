@@ -2,14 +2,67 @@
 
 #include <glog/logging.h>
 
-#include <chrono>
-#include <thread>
+#include <algorithm>
+#include <cstring>
+#include <functional>
+#include <tuple>
+#include <vector>
 
 namespace graphchaindb {
 
+namespace {
+
+// Get the type of the page from its header
+// REQUIRES: a latch on the page to be held by the caller
+PageType ReadPageType(Page* page) {
+    PageType page_type;
+    memcpy(&page_type, page->GetData(), sizeof(page_type));
+    if (page_type < PAGE_TYPE_INVALID || page_type >= PAGE_TYPE_COUNT) {
+        return PAGE_TYPE_INVALID;
+    }
+    return page_type;
+}
+
+}  // namespace
+
+BufferManager::Partition::Partition() {
+    for (int i = 0; i < FRAMES_PER_PARTITION; i++) {
+        free_frames.push_back(i);
+    }
+}
+
 BufferManager::BufferManager(DiskManager* disk_manager, LogManager* log_manager)
+    : BufferManager(CHECK_NOTNULL(disk_manager), CHECK_NOTNULL(log_manager),
+                    Options()) {}
+
+BufferManager::BufferManager(DiskManager* disk_manager, LogManager* log_manager,
+                             const Options& options)
     : disk_manager_{CHECK_NOTNULL(disk_manager)},
-      log_manager_{CHECK_NOTNULL(log_manager)} {}
+      log_manager_{CHECK_NOTNULL(log_manager)},
+      background_writer_{
+          std::make_unique<BackgroundWriter>(this, log_manager_)},
+      readahead_{std::make_unique<Readahead>(this)},
+      warmup_{std::make_unique<Warmup>(this, disk_manager_)} {
+    if (options.compressed_cache_size > 0) {
+        compressed_cache_ =
+            std::make_unique<CompressedPageCache>(options.compressed_cache_size);
+    }
+    for (int p = 0; p < PAGE_BUFFER_PARTITIONS; p++) {
+        auto& partition = partitions_[p];
+        partition.policy = NewReplacementPolicy(options.replacement_policy,
+                                                FRAMES_PER_PARTITION);
+        for (int i = 0; i < FRAMES_PER_PARTITION; i++) {
+            partition.frames[i].data_ =
+                arena_.GetPageData(p * FRAMES_PER_PARTITION + i);
+        }
+    }
+}
+
+BufferManager::~BufferManager() {
+    warmup_->Stop();
+    background_writer_->Stop();
+    readahead_->Stop();
+}
 
 absl::Status BufferManager::Init(page_id_t next_page_id) {
     LOG(INFO) << "BufferManager::Init: Start with next_page_id "
@@ -17,8 +70,9 @@ absl::Status BufferManager::Init(page_id_t next_page_id) {
 
     next_page_id_ = next_page_id;
 
-    std::thread background_flusher(flushRoutine, this);
-    background_flusher.detach();
+    background_writer_->Start();
+    readahead_->Start();
+    warmup_->Start();
 
     return absl::OkStatus();
 }
@@ -26,44 +80,231 @@ absl::Status BufferManager::Init(page_id_t next_page_id) {
 absl::StatusOr<Page*> BufferManager::GetPageWithId(page_id_t page_id) {
     LOG(INFO) << "BufferManager::GetPageWithId: Start with page_id " << page_id;
 
-    std::unique_lock l(mu_);
+    auto partition = GetPartition(page_id);
 
-    auto cache_itr = page_id_to_cache_index_.find(page_id);
-    if (cache_itr != page_id_to_cache_index_.end()) {
-        int cache_index = cache_itr->second;
+    // hits only need the shared partition lock
+    {
+        std::shared_lock l(partition->mu);
+        auto page = pinCachedPage(partition, page_id, l);
+        if (page != nullptr) {
+            return page;
+        }
+    }
+
+    // the page could have been read in between, look it up again
+    std::unique_lock l(partition->mu);
+    auto page = pinCachedPage(partition, page_id, l);
+    if (page != nullptr) {
+        return page;
+    }
+
+    LOG(INFO) << "BufferManager::GetPageWithId: Page not found in cache";
 
-        LOG(INFO)
-            << "BufferManager::GetPageWithId: Found page in cache at index: "
-            << cache_index;
+    return readPage(partition, page_id, l);
+}
 
-        cache_[cache_index].AquireExclusiveLock();
-        cache_[cache_index].pin_count_++;
-        cache_[cache_index].ReleaseExclusiveLock();
+absl::StatusOr<bool> BufferManager::PrefetchPage(page_id_t page_id) {
+    {
+        std::unique_lock l(allocation_mu_);
+        if (page_id < FREE_SPACE_MAP_PAGE_ID || page_id >= next_page_id_) {
+            return false;
+        }
+    }
 
-        return &cache_[cache_index];
+    auto partition = GetPartition(page_id);
+    std::unique_lock l(partition->mu);
+    if (partition->page_table.find(page_id) != partition->page_table.end() ||
+        partition->free_frames.empty()) {
+        return false;
     }
 
-    LOG(INFO) << "BufferManager::GetPageWithId: Page not found in cache";
+    auto page_or_status = readPage(partition, page_id, l);
+    if (!page_or_status.ok()) {
+        return page_or_status.status();
+    }
 
-    auto index_or_status = findIndexToEvict(page_id);
+    l.unlock();
+    UnpinPage(page_or_status.value());
+    return true;
+}
+
+absl::StatusOr<Page*> BufferManager::readPage(
+    Partition* partition, page_id_t page_id,
+    std::unique_lock<std::shared_mutex>& l) {
+    auto index_or_status = findIndexToEvict(partition, page_id, l);
     if (!index_or_status.ok()) {
-        LOG(ERROR) << "BufferManager::GetPageWithId: error while finding index "
+        LOG(ERROR) << "BufferManager::readPage: error while finding index "
                       "to evict";
         return index_or_status.status();
     }
 
+    // the frame is reserved for page_id, marked as being under io and
+    // exclusively latched. Nobody else can touch it, so the read happens
+    // without holding the partition lock.
     int cache_index = index_or_status.value();
-    auto page = &cache_[cache_index];
-    page->AquireExclusiveLock();
-
-    page->page_id_ = page_id;
-    disk_manager_->ReadPage(page_id, page->GetData());
-    page->pin_count_++;
-    page->is_page_dirty_ = false;
+    auto page = &partition->frames[cache_index];
+    l.unlock();
+
+    bool compressed_hit = compressed_cache_ != nullptr &&
+                          compressed_cache_->Take(page_id, page->GetData());
+    absl::Status read_status;
+    if (!compressed_hit) {
+        read_status = disk_manager_->ReadPage(page_id, page->GetData());
+    }
+    auto page_type =
+        read_status.ok() ? ReadPageType(page) : PAGE_TYPE_INVALID;
+
+    l.lock();
+    page->io_in_progress_ = false;
+    page->page_type_ = page_type;
+    recordStats(partition, page_id, page_type, BUFFER_MISS);
+    if (compressed_hit) {
+        recordStats(partition, page_id, page_type, BUFFER_COMPRESSED_HIT);
+    }
+    if (!read_status.ok()) {
+        LOG(ERROR) << "BufferManager::readPage: error while reading page "
+                      "from disk";
+
+        partition->page_table.erase(page_id);
+        partition->policy->Remove(cache_index);
+        partition->free_frames.push_back(cache_index);
+        page->page_id_ = INVALID_PAGE_ID;
+        page->ReleaseExclusiveLock();
+        partition->io_done.notify_all();
+        return read_status;
+    }
 
     page->ReleaseExclusiveLock();
+    page->pin_count_.fetch_add(1, std::memory_order_relaxed);
+    partition->io_done.notify_all();
 
-    return &cache_[cache_index];
+    return page;
+}
+
+template <typename Lock>
+Page* BufferManager::pinCachedPage(Partition* partition, page_id_t page_id,
+                                   Lock& l) {
+    auto cache_itr = partition->page_table.find(page_id);
+    while (cache_itr != partition->page_table.end()) {
+        int cache_index = cache_itr->second;
+        auto page = &partition->frames[cache_index];
+
+        // the page is being read from or written back to disk. Wait for it
+        // and look it up again since the frame could have been reassigned.
+        if (page->io_in_progress_) {
+            LOG(INFO) << "BufferManager::pinCachedPage: waiting for io on "
+                         "frame at index: "
+                      << cache_index;
+
+            recordStats(partition, page_id, page->page_type_, BUFFER_PIN_WAIT);
+            partition->io_done.wait(l);
+            cache_itr = partition->page_table.find(page_id);
+            continue;
+        }
+
+        LOG(INFO) << "BufferManager::pinCachedPage: Found page in cache at "
+                     "index: "
+                  << cache_index;
+
+        // The frame can only be evicted under the exclusive partition lock
+        // and only while it is unpinned, so a single increment pins it.
+        // Taking the page latch here would deadlock with a thread unpinning
+        // the page while holding its latch.
+        page->pin_count_.fetch_add(1, std::memory_order_relaxed);
+        partition->accessed[cache_index].store(true,
+                                               std::memory_order_relaxed);
+        partition->hits[cache_index].fetch_add(1, std::memory_order_relaxed);
+        recordStats(partition, page_id, page->page_type_, BUFFER_HIT);
+
+        return page;
+    }
+
+    return nullptr;
+}
+
+absl::StatusOr<Page*> BufferManager::GetChildPage(Page* parent, int slot,
+                                                  page_id_t child_page_id) {
+    auto swizzled_child = getSwizzledChild(parent, slot);
+    auto page = swizzled_child->load(std::memory_order_relaxed);
+    if (page != nullptr && pinSwizzledPage(page, child_page_id)) {
+        return page;
+    }
+
+    auto page_or_status = GetPageWithId(child_page_id);
+    if (page_or_status.ok()) {
+        swizzled_child->store(page_or_status.value(),
+                              std::memory_order_relaxed);
+    }
+    return page_or_status;
+}
+
+Page* BufferManager::GetChildPageForOptimisticRead(Page* parent, int slot,
+                                                   page_id_t child_page_id) {
+    auto swizzled_child = getSwizzledChild(parent, slot);
+    auto page = swizzled_child->load(std::memory_order_relaxed);
+    if (page != nullptr && page->GetPageId() == child_page_id &&
+        !page->io_in_progress_) {
+        recordSwizzledHit(page, child_page_id);
+        return page;
+    }
+
+    page = GetPageForOptimisticRead(child_page_id);
+    if (page != nullptr) {
+        swizzled_child->store(page, std::memory_order_relaxed);
+    }
+    return page;
+}
+
+bool BufferManager::pinSwizzledPage(Page* page, page_id_t page_id) {
+    // The frame can't be claimed for eviction while it is pinned, and it
+    // only holds the page once the claim ends. Check both after pinning.
+    int pin_count = page->pin_count_.load(std::memory_order_relaxed);
+    do {
+        if (pin_count == Page::PIN_COUNT_EVICTING) {
+            return false;
+        }
+    } while (!page->pin_count_.compare_exchange_weak(
+        pin_count, pin_count + 1, std::memory_order_acquire,
+        std::memory_order_relaxed));
+
+    if (page->page_id_.load(std::memory_order_acquire) != page_id ||
+        page->io_in_progress_) {
+        page->pin_count_.fetch_sub(1, std::memory_order_release);
+        return false;
+    }
+
+    recordSwizzledHit(page, page_id);
+    return true;
+}
+
+void BufferManager::recordSwizzledHit(Page* page, page_id_t page_id) {
+    // frames never move between partitions, so this is the partition of the
+    // frame even if it holds another page by now.
+    auto partition = GetPartition(page_id);
+    int frame_index = page - partition->frames;
+    partition->accessed[frame_index].store(true, std::memory_order_relaxed);
+    partition->hits[frame_index].fetch_add(1, std::memory_order_relaxed);
+    recordStats(partition, page_id, page->page_type_, BUFFER_HIT);
+    recordStats(partition, page_id, page->page_type_, BUFFER_SWIZZLED_HIT);
+}
+
+Page* BufferManager::GetPageForOptimisticRead(page_id_t page_id) {
+    auto partition = GetPartition(page_id);
+    std::shared_lock l(partition->mu);
+
+    auto cache_itr = partition->page_table.find(page_id);
+    if (cache_itr == partition->page_table.end() ||
+        partition->frames[cache_itr->second].io_in_progress_) {
+        return nullptr;
+    }
+
+    auto page = &partition->frames[cache_itr->second];
+    partition->accessed[cache_itr->second].store(true,
+                                                 std::memory_order_relaxed);
+    partition->hits[cache_itr->second].fetch_add(1,
+                                                 std::memory_order_relaxed);
+    recordStats(partition, page_id, page->page_type_, BUFFER_HIT);
+    return page;
 }
 
 absl::StatusOr<Page*> BufferManager::GetOverflowPageWithCapacity(
@@ -72,67 +313,143 @@ absl::StatusOr<Page*> BufferManager::GetOverflowPageWithCapacity(
                  "required_capacity: "
               << required_capacity;
 
-    Page* result = nullptr;
-    for (auto page_id : overflow_pages_) {
+    int required_space = required_capacity + sizeof(int32_t);
+    if (required_space > OverflowPage::DATA_SIZE) {
+        LOG(ERROR) << "BufferManager::GetOverflowPageWithCapacity: "
+                      "required_capacity doesn't fit in a page";
+        return absl::InvalidArgumentError(
+            "required capacity doesn't fit in an overflow page");
+    }
+
+    while (true) {
+        int entry = FreeSpaceMapPage::NO_ENTRY;
+        page_id_t page_id = INVALID_PAGE_ID;
+        auto s = updateFreeSpaceMap([&](FreeSpaceMapPage* free_space_map) {
+            entry = free_space_map->Allocate(required_space);
+            if (entry == FreeSpaceMapPage::NO_ENTRY) {
+                return false;
+            }
+
+            page_id = free_space_map->GetEntryPageId(entry);
+            return true;
+        });
+        if (!s.ok()) {
+            LOG(ERROR) << "BufferManager::GetOverflowPageWithCapacity: error "
+                          "while searching the free space map";
+            return s;
+        }
+
+        if (page_id == INVALID_PAGE_ID) {
+            break;
+        }
+
         auto page_status = GetPageWithId(page_id);
         if (!page_status.ok()) {
+            LOG(ERROR) << "BufferManager::GetOverflowPageWithCapacity: error "
+                          "while getting the overflow page "
+                       << page_id;
+            return page_status.status();
         }
 
         auto page = page_status.value();
+        page->AquireExclusiveLock();
         auto overflow_page = reinterpret_cast<OverflowPage*>(page->GetData());
-        if (overflow_page->RemainingCapacity() >= required_capacity + 4) {
-            result = page;
-            break;
+        auto remaining_capacity = overflow_page->RemainingCapacity();
+        if (remaining_capacity >= required_space) {
+            return page;
         }
 
+        // The map claimed more space than the page has, e.g. because it was
+        // written to disk and the page wasn't before a crash. Correct it and
+        // look again.
+        LOG(INFO) << "BufferManager::GetOverflowPageWithCapacity: free space "
+                     "map is behind the overflow page "
+                  << page_id;
+        s = updateFreeSpaceMap([&](FreeSpaceMapPage* free_space_map) {
+            free_space_map->SetFreeSpace(entry, remaining_capacity);
+            return true;
+        });
         UnpinPage(page, false);
-    }
-
-    if (result == nullptr) {
-        auto page_status = AllocateNewPage();
-        if (!page_status.ok()) {
+        page->ReleaseExclusiveLock();
+        if (!s.ok()) {
+            return s;
         }
+    }
 
-        auto page = page_status.value();
-        auto overflow_page = reinterpret_cast<OverflowPage*>(page->GetData());
-        overflow_page->InitPage(page->GetPageId());
-        disk_manager_->WritePage(page->GetPageId(),
-                                 reinterpret_cast<char*>(overflow_page),
-                                 /* flush */ true);
+    auto page_status = AllocateNewPage();
+    if (!page_status.ok()) {
+        LOG(ERROR) << "BufferManager::GetOverflowPageWithCapacity: error while "
+                      "allocating an overflow page";
+        return page_status.status();
+    }
 
-        overflow_pages_.emplace_back(page->GetPageId());
-        result = page;
+    auto page = page_status.value();
+    page->AquireExclusiveLock();
+    auto overflow_page = reinterpret_cast<OverflowPage*>(page->GetData());
+    overflow_page->InitPage(page->GetPageId());
+    auto s = disk_manager_->WritePage(page->GetPageId(),
+                                      reinterpret_cast<char*>(overflow_page),
+                                      /* flush */ true);
+    if (s.ok()) {
+        s = updateFreeSpaceMap([&](FreeSpaceMapPage* free_space_map) {
+            if (free_space_map->Add(page->GetPageId(),
+                                    overflow_page->RemainingCapacity() -
+                                        required_space) ==
+                FreeSpaceMapPage::NO_ENTRY) {
+                LOG(INFO) << "BufferManager::GetOverflowPageWithCapacity: free "
+                             "space map is full, not tracking the page "
+                          << page->GetPageId();
+                return false;
+            }
+            return true;
+        });
+    }
+    if (!s.ok()) {
+        LOG(ERROR) << "BufferManager::GetOverflowPageWithCapacity: error while "
+                      "setting up the overflow page "
+                   << page->GetPageId();
+        UnpinPage(page, false);
+        page->ReleaseExclusiveLock();
+        return s;
     }
 
-    return result;
+    return page;
 }
 
 absl::StatusOr<Page*> BufferManager::AllocateNewPage() {
     LOG(INFO) << "BufferManager::AllocateNewPage: Start";
 
-    std::unique_lock l(mu_);
+    page_id_t page_id = INVALID_PAGE_ID;
+    {
+        std::unique_lock l(allocation_mu_);
+
+        absl::StatusOr<std::unique_ptr<LogEntry>> sOrLogEntry =
+            log_manager_->PrepareLogEntry(NEXT_PAGE_ID_KEY,
+                                          std::to_string(next_page_id_ + 1));
+        if (!sOrLogEntry.ok() || *sOrLogEntry == nullptr) {
+            LOG(ERROR)
+                << "BufferManager::AllocateNewPage: unable to prepare log "
+                   "entry for updating next page id";
+            return sOrLogEntry.status();
+        }
 
-    absl::StatusOr<std::unique_ptr<LogEntry>> sOrLogEntry =
-        log_manager_->PrepareLogEntry(NEXT_PAGE_ID_KEY,
-                                      std::to_string(next_page_id_ + 1));
-    if (!sOrLogEntry.ok() || *sOrLogEntry == nullptr) {
-        LOG(ERROR) << "BufferManager::AllocateNewPage: unable to prepare log "
-                      "entry for updating next page id";
-        return sOrLogEntry.status();
-    }
+        absl::Status s = log_manager_->WriteLogEntry(*sOrLogEntry);
+        if (!s.ok()) {
+            LOG(ERROR)
+                << "BufferManager::AllocateNewPage: unable to write log for "
+                   "updating next page id"
+                   "entry for set operation";
+            return s;
+        }
 
-    absl::Status s = log_manager_->WriteLogEntry(*sOrLogEntry);
-    if (!s.ok()) {
-        LOG(ERROR) << "BufferManager::AllocateNewPage: unable to write log for "
-                      "updating next page id"
-                      "entry for set operation";
-        return s;
+        LOG(INFO) << "BufferManager::AllocateNewPage: wrote the log entry";
+        page_id = next_page_id_++;
     }
 
-    LOG(INFO) << "BufferManager::AllocateNewPage: wrote the log entry";
-    auto page_id = next_page_id_++;
+    auto partition = GetPartition(page_id);
+    std::unique_lock l(partition->mu);
 
-    auto indexOrStatus = findIndexToEvict(page_id);
+    auto indexOrStatus = findIndexToEvict(partition, page_id, l);
     if (!indexOrStatus.ok()) {
         LOG(ERROR) << "BufferManager::AllocateNewPage: error while finding "
                       "index to evict";
@@ -142,31 +459,55 @@ absl::StatusOr<Page*> BufferManager::AllocateNewPage() {
     auto index = indexOrStatus.value();
     LOG(INFO) << "BufferManager::AllocateNewPage: found slot index: " << index;
 
-    cache_[index].AquireExclusiveLock();
-    cache_[index].pin_count_++;
-    cache_[index].page_id_ = page_id;
-    cache_[index].is_page_dirty_ = false;
-    cache_[index].ReleaseExclusiveLock();
+    auto page = &partition->frames[index];
+    l.unlock();
+    page->ZeroOut();
+    l.lock();
+
+    page->ReleaseExclusiveLock();
+    page->io_in_progress_ = false;
+    page->pin_count_.fetch_add(1, std::memory_order_relaxed);
+    partition->io_done.notify_all();
+
+    return page;
+}
+
+page_id_t BufferManager::AllocatePageId() {
+    std::unique_lock l(allocation_mu_);
+    return next_page_id_++;
+}
 
-    return &cache_[index];
+page_id_t BufferManager::GetNextPageId() {
+    std::unique_lock l(allocation_mu_);
+    return next_page_id_;
 }
 
 void BufferManager::UnpinPage(Page* page, bool is_dirty) {
     LOG(INFO) << "BufferManager::UnpinPage: Start with page_id: "
               << page->GetPageId() << " is_dirty: " << is_dirty;
 
+    // the dirty state is guarded by the partition lock. It is updated before
+    // the page is unpinned so that it can't be evicted as a clean page.
     if (is_dirty) {
-        page->is_page_dirty_ = true;
+        auto partition = GetPartition(page->GetPageId());
+        std::unique_lock l(partition->mu);
+        markPageDirty(partition, page - partition->frames,
+                      log_manager_->GetNextLogNumber());
+        page->page_type_ = ReadPageType(page);
     }
 
-    // TODO: what if only read lock is held. Is this safe?
-    page->pin_count_--;
-    CHECK_GE(page->pin_count_, 0);
+    // The pin count is atomic, so unpinning doesn't need the partition lock.
+    // Releasing makes our accesses to the page visible to the thread which
+    // evicts it next.
+    auto pin_count = page->pin_count_.fetch_sub(1, std::memory_order_release);
+    CHECK_GT(pin_count, 0);
 }
 
-// Find a free slot in the buffer cache. It doesn't update the maps.
-// REQUIRES: mu_ to be held by the caller
-absl::StatusOr<int> BufferManager::findIndexToEvict(page_id_t new_page_id) {
+// Find a free slot in the partition and reserve it for the new page.
+// REQUIRES: partition->mu to be held by the caller through l
+absl::StatusOr<int> BufferManager::findIndexToEvict(
+    Partition* partition, page_id_t new_page_id,
+    std::unique_lock<std::shared_mutex>& l) {
     LOG(INFO) << "BufferManager::findIndexToEvict: Start with new_page_id "
               << new_page_id;
 
@@ -174,49 +515,52 @@ absl::StatusOr<int> BufferManager::findIndexToEvict(page_id_t new_page_id) {
     page_id_t existing_page_id = INVALID_PAGE_ID;
     bool eviction = false;
 
-    if (cache_index_to_page_id_.size() < PAGE_BUFFER_SIZE) {
-        for (int i = 0; i < PAGE_BUFFER_SIZE; i++) {
-            if (cache_index_to_page_id_.find(i) ==
-                cache_index_to_page_id_.end()) {
-                cache_index = i;
-                break;
+    if (!partition->free_frames.empty()) {
+        cache_index = partition->free_frames.front();
+        partition->free_frames.pop_front();
+    } else {
+        // tell the policy about the hits since the last eviction
+        for (int i = 0; i < FRAMES_PER_PARTITION; i++) {
+            if (partition->accessed[i].exchange(false,
+                                                std::memory_order_relaxed)) {
+                partition->policy->RecordAccess(i);
             }
         }
 
-        CHECK_GE(cache_index, 0)
-            << "BufferManager::findIndexToEvict: programming "
-               "error - expected index to be non-negative";
-    } else {
-        int eviction_end_idx =
-            (eviction_start_idx_ + PAGE_BUFFER_SIZE - 1) % PAGE_BUFFER_SIZE;
-
-        LOG(INFO) << "BufferManager::findIndexToEvict: starting eviction idx "
-                     "search from "
-                  << eviction_start_idx_;
-
-        for (; eviction_start_idx_ != eviction_end_idx;
-             eviction_start_idx_ =
-                 (eviction_start_idx_ + 1) % PAGE_BUFFER_SIZE) {
-            LOG(INFO)
-                << "BufferManager::findIndexToEvict: current eviction idx "
-                   "search from "
-                << eviction_start_idx_;
-
-            // it's not possible to increase the pin count concurrently while
-            // doing this since we hold the global lock. So this is thread safe
-            if (cache_[eviction_start_idx_].pin_count_ == 0) {
-                if (cache_[eviction_start_idx_].second_chance_) {
-                    cache_[eviction_start_idx_].second_chance_ = false;
-                    continue;
-                }
-
-                cache_index = eviction_start_idx_;
+        // Pages can't be pinned through the page table concurrently since we
+        // hold the partition lock exclusively, but they can still be pinned
+        // through a swizzled reference and unpinned. The chosen frame is
+        // claimed so that neither can happen until it holds the new page,
+        // and given back to the policy if it was pinned in between.
+        for (int attempt = 0; attempt < FRAMES_PER_PARTITION; attempt++) {
+            auto index_or_status =
+                partition->policy->Evict([partition](int frame_index) {
+                    auto candidate = &partition->frames[frame_index];
+                    return candidate->pin_count_.load(
+                               std::memory_order_relaxed) == 0 &&
+                           !candidate->io_in_progress_;
+                });
+            if (!index_or_status.ok()) {
+                break;
+            }
+
+            auto candidate = &partition->frames[index_or_status.value()];
+            int pin_count = 0;
+            if (candidate->pin_count_.compare_exchange_strong(
+                    pin_count, Page::PIN_COUNT_EVICTING,
+                    std::memory_order_acquire)) {
+                cache_index = index_or_status.value();
                 eviction = true;
+                break;
             }
+
+            partition->policy->RecordInsert(index_or_status.value(),
+                                            candidate->GetPageId());
         }
     }
 
     if (cache_index == -1) {
+        partition->stats.Record(PAGE_TYPE_INVALID, BUFFER_EVICTION_FAILURE);
         LOG(ERROR)
             << "BufferManager::findIndexToEvict: couldn't find a page to evict";
         return absl::InternalError(
@@ -226,99 +570,273 @@ absl::StatusOr<int> BufferManager::findIndexToEvict(page_id_t new_page_id) {
     LOG(INFO) << "BufferManager::findIndexToEvict: found index to evict: "
               << cache_index;
 
-    Page* page = &cache_[cache_index];
-    page->AquireExclusiveLock();
+    // Reserve the frame for the new page before doing any io. Requests for
+    // either the new or the evicted page wait on io_done until we are done.
+    Page* page = &partition->frames[cache_index];
     if (eviction) {
         existing_page_id = page->GetPageId();
     }
+    PageType existing_page_type = page->page_type_;
+    page->io_in_progress_ = true;
+    partition->page_table[new_page_id] = cache_index;
+    partition->policy->RecordInsert(cache_index, new_page_id);
+    partition->accessed[cache_index].store(false, std::memory_order_relaxed);
+    partition->hits[cache_index].store(0, std::memory_order_relaxed);
+
+    // The page is unpinned, but a thread which just unpinned it could still
+    // be holding its latch. The exclusive latch is kept until the frame holds
+    // the new page, which fails the optimistic reads of both pages.
+    bool write_back = page->GetPageDirty();
+    l.unlock();
+    page->AquireExclusiveLock();
 
-    // this is safe to do because the flusher routine won't be flushing since
-    // we're holding an exclusive lock.
-    if (page->GetPageDirty()) {
+    absl::Status existing_page_write_status;
+    if (write_back) {
         CHECK_NE(existing_page_id, INVALID_PAGE_ID)
             << "BufferManager::findIndexToEvict: programming "
                "error - existing page id is invalid but page is dirty.";
 
-        auto existing_page_write_status =
+        existing_page_write_status =
             disk_manager_->WritePage(existing_page_id, page->GetData());
-        if (!existing_page_write_status.ok()) {
-            LOG(ERROR) << "BufferManager::findIndexToEvict: error while "
-                          "writing existing page to disk";
+    }
 
-            page->ReleaseExclusiveLock();
-            return existing_page_write_status;
-        }
+    // Requests for the evicted page keep waiting until it is removed from
+    // the page table below, so they find it in the compressed cache.
+    if (eviction && existing_page_write_status.ok() &&
+        compressed_cache_ != nullptr) {
+        compressed_cache_->Insert(existing_page_id, page->GetData());
     }
+    l.lock();
 
-    page->pin_count_ = 0;
-    page->ZeroOut();
+    if (!existing_page_write_status.ok()) {
+        LOG(ERROR) << "BufferManager::findIndexToEvict: error while "
+                      "writing existing page to disk";
 
-    page->ReleaseExclusiveLock();
+        partition->page_table.erase(new_page_id);
+        partition->policy->RestoreEvicted(cache_index, existing_page_id);
+        page->pin_count_.store(0, std::memory_order_release);
+        page->ReleaseExclusiveLock();
+        page->io_in_progress_ = false;
+        partition->io_done.notify_all();
+        return existing_page_write_status;
+    }
 
-    // update map
+    // update page table
     if (existing_page_id != INVALID_PAGE_ID) {
-        page_id_to_cache_index_.erase(existing_page_id);
+        partition->page_table.erase(existing_page_id);
+    }
+
+    if (eviction) {
+        recordStats(partition, existing_page_id, existing_page_type,
+                    BUFFER_EVICTION);
+    }
+    if (write_back) {
+        recordStats(partition, existing_page_id, existing_page_type,
+                    BUFFER_WRITE_BACK);
+    }
+
+    markPageClean(partition, cache_index);
+    int frame_number =
+        (partition - partitions_) * FRAMES_PER_PARTITION + cache_index;
+    for (auto& swizzled_child : swizzled_children_[frame_number]) {
+        swizzled_child.store(nullptr, std::memory_order_relaxed);
+    }
+    page->page_id_ = new_page_id;
+    page->page_type_ = PAGE_TYPE_INVALID;
+    if (eviction) {
+        // end the claim. A swizzled reference pinning the frame from now on
+        // sees the new page under io.
+        page->pin_count_.store(0, std::memory_order_release);
     }
-    page_id_to_cache_index_[new_page_id] = cache_index;
-    cache_index_to_page_id_[cache_index] = new_page_id;
 
     return cache_index;
 }
 
-void flushRoutine(BufferManager* buffer_manager) {
-    std::this_thread::sleep_for(
-        std::chrono::milliseconds(FLUSH_WAIT_INTERVAL_MILLISECONDS));
+void BufferManager::markPageDirty(Partition* partition, int frame_index,
+                                  ln_t dirty_log_number) {
+    auto page = &partition->frames[frame_index];
+    if (page->is_page_dirty_) {
+        return;
+    }
 
-    while (true) {
-        buffer_manager->flushToDisk();
+    page->is_page_dirty_ = true;
+    page->dirty_log_number_ = dirty_log_number;
+    partition->dirty_frames.emplace(dirty_log_number, frame_index);
+    dirty_page_count_++;
+}
 
-        std::this_thread::sleep_for(
-            std::chrono::milliseconds(FLUSH_WAIT_INTERVAL_MILLISECONDS));
+void BufferManager::markPageClean(Partition* partition, int frame_index) {
+    auto page = &partition->frames[frame_index];
+    if (!page->is_page_dirty_) {
+        return;
     }
+
+    partition->dirty_frames.erase({page->dirty_log_number_, frame_index});
+    page->is_page_dirty_ = false;
+    page->dirty_log_number_ = INVALID_LOG_NUMBER;
+    dirty_page_count_--;
 }
 
-void BufferManager::flushToDisk() {
-    LOG(INFO) << "BufferManager::flushToDisk: Start";
-    std::unique_lock l(mu_);
-    std::vector<int> to_flush;
+absl::Status BufferManager::updateFreeSpaceMap(
+    absl::FunctionRef<bool(FreeSpaceMapPage*)> fn) {
+    auto page_status = GetPageWithId(FREE_SPACE_MAP_PAGE_ID);
+    if (!page_status.ok()) {
+        return page_status.status();
+    }
 
-    // first check if we even need to flush any page
-    for (int i = 0; i < PAGE_BUFFER_SIZE; i++) {
-        auto page = &cache_[i];
-        page->AquireReadLock();
+    auto page = page_status.value();
+    page->AquireExclusiveLock();
+    auto free_space_map = reinterpret_cast<FreeSpaceMapPage*>(page->GetData());
+    CHECK_EQ(free_space_map->GetPageType(), PAGE_TYPE_FREE_SPACE_MAP);
+    bool is_dirty = fn(free_space_map);
+    UnpinPage(page, is_dirty);
+    page->ReleaseExclusiveLock();
+
+    return absl::OkStatus();
+}
+
+std::vector<page_id_t> BufferManager::GetResidentPages() {
+    // (hits, page id) of every resident page
+    std::vector<std::pair<uint32_t, page_id_t>> resident_pages;
+    for (auto& partition : partitions_) {
+        std::shared_lock l(partition.mu);
+        for (auto [page_id, frame_index] : partition.page_table) {
+            if (partition.frames[frame_index].io_in_progress_) {
+                continue;
+            }
 
-        if (page->pin_count_ == 0 && page->is_page_dirty_) {
-            to_flush.push_back(i);
+            resident_pages.emplace_back(
+                partition.hits[frame_index].load(std::memory_order_relaxed),
+                page_id);
         }
+    }
+
+    std::sort(resident_pages.begin(), resident_pages.end(),
+              std::greater<>());
 
-        page->ReleaseReadLock();
+    std::vector<page_id_t> page_ids;
+    page_ids.reserve(resident_pages.size());
+    for (auto [hits, page_id] : resident_pages) {
+        page_ids.push_back(page_id);
     }
+    return page_ids;
+}
 
-    LOG(INFO) << "BufferManager::flushToDisk: Number of pages to flush: "
-              << to_flush.size();
+absl::Status BufferManager::StartWarmup() {
+    return warmup_->StartPrefetch();
+}
 
-    for (std::size_t i = 0; i < to_flush.size(); i++) {
-        int idx = to_flush[i];
-        auto page = &cache_[idx];
-        page->AquireExclusiveLock();
+BufferStatsSnapshot BufferManager::GetStats() {
+    BufferStatsSnapshot snapshot;
+    for (auto& partition : partitions_) {
+        partition.stats.AddTo(&snapshot);
+    }
+    return snapshot;
+}
+
+void BufferManager::RecordLeafAccess(page_id_t page_id,
+                                     page_id_t next_page_id,
+                                     bool sequential_hint) {
+    readahead_->RecordLeafAccess(page_id, next_page_id, sequential_hint);
+}
+
+absl::StatusOr<int> BufferManager::FlushDirtyPages(int max_pages,
+                                                   ln_t log_number_limit) {
+    LOG(INFO) << "BufferManager::FlushDirtyPages: Start with max_pages "
+              << max_pages << " and log_number_limit " << log_number_limit;
+
+    // (log number when made dirty, page id, partition index, frame index)
+    std::vector<std::tuple<ln_t, page_id_t, int, int>> candidates;
+    for (int p = 0; p < PAGE_BUFFER_PARTITIONS; p++) {
+        auto partition = &partitions_[p];
+        std::unique_lock l(partition->mu);
 
-        // in between the reading and writing, the pages pin count could have
-        // been updated.
-        if (page->pin_count_ == 0) {
-            auto flush_status =
-                disk_manager_->WritePage(page->GetPageId(), page->GetData(),
-                                         /* flush */ i + 1 == to_flush.size());
-            if (!flush_status.ok()) {
-                LOG(ERROR) << "BufferManager::flushToDisk: error while "
-                              "flushing the page "
-                           << page->GetPageId();
-                page->ReleaseExclusiveLock();
-                return;
+        int taken = 0;
+        for (auto [dirty_log_number, frame_index] : partition->dirty_frames) {
+            if (taken >= max_pages && dirty_log_number >= log_number_limit) {
+                break;
+            }
+
+            auto page = &partition->frames[frame_index];
+            if (page->pin_count_.load(std::memory_order_relaxed) == 0 &&
+                !page->io_in_progress_) {
+                candidates.emplace_back(dirty_log_number, page->GetPageId(),
+                                        p, frame_index);
+                taken++;
             }
         }
+    }
 
-        page->ReleaseExclusiveLock();
+    // the oldest pages across all of the partitions go first
+    std::sort(candidates.begin(), candidates.end());
+
+    int written = 0;
+    for (auto [dirty_log_number, page_id, p, frame_index] : candidates) {
+        if (written >= max_pages && dirty_log_number >= log_number_limit) {
+            break;
+        }
+
+        auto written_or_status =
+            flushPage(&partitions_[p], frame_index, page_id);
+        if (!written_or_status.ok()) {
+            LOG(ERROR) << "BufferManager::FlushDirtyPages: error while "
+                          "flushing the page "
+                       << page_id;
+            return written_or_status.status();
+        }
+
+        if (written_or_status.value()) {
+            written++;
+        }
+    }
+
+    LOG(INFO) << "BufferManager::FlushDirtyPages: wrote " << written
+              << " pages";
+    return written;
+}
+
+absl::StatusOr<bool> BufferManager::flushPage(Partition* partition,
+                                              int frame_index,
+                                              page_id_t page_id) {
+    auto page = &partition->frames[frame_index];
+
+    // pin the page so that it can't be evicted while it is written without
+    // the partition lock.
+    std::unique_lock l(partition->mu);
+    if (page->GetPageId() != page_id || !page->is_page_dirty_ ||
+        page->pin_count_.load(std::memory_order_relaxed) > 0 ||
+        page->io_in_progress_) {
+        return false;
     }
+    page->pin_count_.fetch_add(1, std::memory_order_relaxed);
+    l.unlock();
+
+    // Mark the page clean before writing it. It can only be modified again
+    // under the exclusive latch once the read latch is released, and is
+    // marked dirty again after that.
+    page->AquireReadLock();
+    l.lock();
+    auto dirty_log_number = page->dirty_log_number_;
+    markPageClean(partition, frame_index);
+    l.unlock();
+
+    auto write_status = disk_manager_->WritePage(page_id, page->GetData());
+
+    l.lock();
+    if (!write_status.ok()) {
+        markPageDirty(partition, frame_index, dirty_log_number);
+    } else {
+        recordStats(partition, page_id, page->page_type_, BUFFER_FLUSH);
+    }
+    page->pin_count_.fetch_sub(1, std::memory_order_release);
+    l.unlock();
+    page->ReleaseReadLock();
+
+    if (!write_status.ok()) {
+        return write_status;
+    }
+
+    return true;
 }
 
 }  // namespace graphchaindb
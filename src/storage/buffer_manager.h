@@ -1,38 +1,101 @@
 #ifndef STORAGE_BUFFER_MANAGER_H
 #define STORAGE_BUFFER_MANAGER_H
 
+#include <atomic>
+#include <condition_variable>
+#include <list>
 #include <map>
+#include <memory>
+#include <mutex>
+#include <set>
 #include <shared_mutex>
+#include <utility>
+#include <vector>
 
+#include "absl/functional/function_ref.h"
 #include "absl/status/statusor.h"
 #include "src/common/config.h"
+#include "src/storage/background_writer.h"
+#include "src/storage/buffer_stats.h"
+#include "src/storage/compressed_page_cache.h"
 #include "src/storage/disk_manager.h"
+#include "src/storage/free_space_map_page.h"
 #include "src/storage/log_manager.h"
+#include "src/storage/option.h"
 #include "src/storage/overflow_page.h"
 #include "src/storage/page.h"
+#include "src/storage/page_arena.h"
+#include "src/storage/readahead.h"
+#include "src/storage/replacement_policy.h"
+#include "src/storage/warmup.h"
 
 namespace graphchaindb {
 
-class BufferManager;
-
-void flushRoutine(BufferManager* buffer_manager);
-
 // BufferManager manages all of the pages in the storage.
 //
 // Maintains a cache of pages in memory. It retrieves the pages from
 // disk and stores them in the cache. It also allocates new pages when
 // requested.
 //
+// The cache is split into PAGE_BUFFER_PARTITIONS partitions. A page always
+// lives in the partition selected by its page id and each partition has its
+// own lock, page table, free list and replacement policy. Operations on pages
+// of different partitions never contend with each other.
+//
+// Cached pages are pinned under the shared partition lock with an atomic
+// increment of the pin count and unpinned without the lock, unless they are
+// dirty. Hits are recorded in per frame flags which are handed to the
+// replacement policy before the next eviction, so the policy itself is only
+// touched under the exclusive lock.
+//
+// The partition lock is only held while changing metadata. Disk reads on a
+// miss and write backs of evicted pages happen without it, while the frame
+// is marked as having io in progress. Requests for the page of such a frame
+// wait for the io to finish. Requests for other pages proceed.
+//
+// Each partition keeps its dirty frames ordered by the log number at which
+// they were made dirty. A background writer uses it to write the oldest
+// dirty pages ahead of their eviction, see BackgroundWriter.
+//
+// The data of all frames lives in a single PageArena, possibly backed by huge
+// pages, apart from the cache line aligned frame metadata.
+//
+// Hits, misses, evictions, write backs, waits for io and failed evictions are
+// counted per partition by the type of the page, see GetStats. The root of
+// the index is counted apart, as PAGE_TYPE_ROOT, see SetIndexRootPageId.
+//
+// Sequential scans of the B+ tree leaf chain are detected from the leaf
+// accesses reported through RecordLeafAccess and the following leaves are
+// read in the background before the scan asks for them.
+//
+// References to child pages in resident B+ tree internal pages are swizzled:
+// the frame a child was found in is remembered per slot of the frame of its
+// parent, see GetChildPage. Following the reference again pins that frame
+// directly, without the partition lock or the page table. The references
+// only live in memory next to the frames and are reset when the frame of the
+// parent gets a new page, so the pages on disk only ever hold page ids. A
+// reference to a child which was evicted since is noticed when pinning it.
+//
+// Clean pages which are evicted can be kept compressed in memory if
+// Options::compressed_cache_size is set. A miss takes the page out of the
+// compressed cache instead of reading it from disk, see CompressedPageCache.
+//
+// The resident pages are saved periodically and read back in the background
+// after a restart, see Warmup.
+//
 // It is thread safe.
 //
 class BufferManager {
    public:
     explicit BufferManager(DiskManager* disk_manager, LogManager* log_manager);
+    BufferManager(DiskManager* disk_manager, LogManager* log_manager,
+                  const Options& options);
 
     BufferManager(const BufferManager&) = delete;
     BufferManager& operator=(const BufferManager&) = delete;
 
-    ~BufferManager() = default;
+    // Stops the background writer, the readahead and the warm-up workers
+    ~BufferManager();
 
     // Init the buffer manager after recovery and before any new operation
     absl::Status Init(page_id_t next_page_id);
@@ -40,40 +103,227 @@ class BufferManager {
     // Get the page with the given id and pins it
     absl::StatusOr<Page*> GetPageWithId(page_id_t page_id);
 
+    // Get the frame of the page with the given id for an optimistic read
+    // without pinning it. Returns nullptr if the page isn't cached.
+    //
+    // The frame can be evicted and reused at any time. The caller MUST start
+    // an optimistic read on it, check that it still holds the page and
+    // validate the read, see Page::StartOptimisticRead.
+    Page* GetPageForOptimisticRead(page_id_t page_id);
+
+    // Get the child page with the given id, read from the given slot of the
+    // internal page in the frame parent, and pin it.
+    //
+    // Same as GetPageWithId, but the frame is taken from the swizzled
+    // reference of the slot if it still holds the child. Otherwise the
+    // reference is swizzled to the frame the child is found in.
+    absl::StatusOr<Page*> GetChildPage(Page* parent, int slot,
+                                       page_id_t child_page_id);
+
+    // Get the frame of the child page for an optimistic read, like
+    // GetPageForOptimisticRead, through the swizzled reference of the given
+    // slot of the frame parent. The parent can be read optimistically too.
+    Page* GetChildPageForOptimisticRead(Page* parent, int slot,
+                                        page_id_t child_page_id);
+
     // Get an overflow page which at least contains the given capacity. The
     // capacity only includes the length of the string. It shouldn't include the
     // space required for storing the length itself.
+    //
+    // The page is found through the free space map without looking at any
+    // other overflow page, or allocated. The space is taken from the map
+    // right away, so concurrent callers can share the page.
+    //
+    // The page is returned pinned and exclusively latched. The caller MUST
+    // write the string to the page, then unpin it and release the latch.
     absl::StatusOr<Page*> GetOverflowPageWithCapacity(int required_capacity);
 
     // Allocates a new page and pins it
     absl::StatusOr<Page*> AllocateNewPage();
 
+    // Allocates the id of a new page without a frame and without logging
+    // it, for a page which is written to disk directly. The id can be
+    // allocated again after a crash unless the next page id is logged,
+    // see GetNextPageId.
+    page_id_t AllocatePageId();
+
+    // Get the id the next allocated page gets
+    page_id_t GetNextPageId();
+
     // Unpin the given page
     // ASSUMES: Appropriate lock on the page is held by the caller
     void UnpinPage(Page* page, bool is_dirty = false);
 
-    // Routine which is called periodically to flush the unpinned dirty
-    // pages to disk
+    // Record a read of the B+ tree leaf page_id whose next leaf is
+    // next_page_id. Prefetches the following leaves once the reads form a
+    // sequential scan, or right away if sequential_hint is set.
+    void RecordLeafAccess(page_id_t page_id, page_id_t next_page_id,
+                          bool sequential_hint = false);
+
+    // Write the unpinned dirty pages to disk and mark them clean. The pages
+    // are written in the order in which they were made dirty. At least
+    // max_pages pages are written if there are as many, and additionally
+    // every page made dirty before log_number_limit.
     //
-    // Acquires the exclusive lock
-    void flushToDisk();
+    // Returns the number of pages written.
+    // Acquires the partition locks one at a time
+    absl::StatusOr<int> FlushDirtyPages(
+        int max_pages, ln_t log_number_limit = INVALID_LOG_NUMBER);
+
+    // Get the number of dirty pages in the buffer pool
+    int GetDirtyPageCount() { return dirty_page_count_; }
+
+    // Get the statistics of all of the partitions
+    BufferStatsSnapshot GetStats();
+
+    // Set the root page of the index. Its events are counted as the events
+    // of a PAGE_TYPE_ROOT page rather than of its own type, since the
+    // database root page is never in the buffer pool.
+    void SetIndexRootPageId(page_id_t page_id) {
+        index_root_page_id_.store(page_id, std::memory_order_relaxed);
+    }
+
+    // Get the ids of the pages in the buffer pool, the most hit first
+    std::vector<page_id_t> GetResidentPages();
+
+    // Read the page into a free frame unless it is cached already. Never
+    // evicts a page. Returns if the page was read.
+    absl::StatusOr<bool> PrefetchPage(page_id_t page_id);
+
+    // Start reading the pages which were resident before the restart in the
+    // background, see Warmup.
+    //
+    // Returns NotFoundError if they weren't saved
+    absl::Status StartWarmup();
 
    private:
-    // Find an empty slot in the cache or evict one of the pages
-    // Also updates the search maps in case a slot was found
-    // REQUIRES: mu_ to be held by the caller
-    absl::StatusOr<int> findIndexToEvict(page_id_t new_page_id);
+    static constexpr int FRAMES_PER_PARTITION =
+        PAGE_BUFFER_SIZE / PAGE_BUFFER_PARTITIONS;
+    static_assert(PAGE_BUFFER_SIZE % PAGE_BUFFER_PARTITIONS == 0,
+                  "PAGE_BUFFER_PARTITIONS must divide PAGE_BUFFER_SIZE");
+
+    // An independently locked slice of the buffer pool. Aligned to a cache
+    // line so that the locks of neighbouring partitions don't share one.
+    struct alignas(CACHE_LINE_SIZE) Partition {
+        Partition();
+
+        std::shared_mutex mu;  // protects page_table, free_frames, policy
+                               // and the frame metadata. Pages are pinned
+                               // under the shared lock.
+        std::condition_variable_any io_done;  // signalled when io on a
+                                              // frame of the partition ends
+        std::map<page_id_t, int> page_table;  // page id -> frame index
+        std::list<int> free_frames;           // frames which hold no page
+        std::set<std::pair<ln_t, int>>
+            dirty_frames;  // (log number when made dirty, frame index)
+        std::unique_ptr<ReplacementPolicy> policy;
+        std::atomic<bool> accessed[FRAMES_PER_PARTITION] =
+            {};  // frames hit since the policy was last told
+        std::atomic<uint32_t> hits[FRAMES_PER_PARTITION] =
+            {};  // hits on the page of the frame, for warm-up
+        BufferStats stats;
+        Page frames[FRAMES_PER_PARTITION];
+    };
+
+    // Get the partition which owns the given page id
+    inline Partition* GetPartition(page_id_t page_id) {
+        return &partitions_[page_id % PAGE_BUFFER_PARTITIONS];
+    }
+
+    // Count the event of the page in the stats of the partition, see
+    // SetIndexRootPageId
+    inline void recordStats(Partition* partition, page_id_t page_id,
+                            PageType page_type, BufferTicker ticker) {
+        if ((page_type == PAGE_TYPE_BPLUS_INTERNAL ||
+             page_type == PAGE_TYPE_BPLUS_LEAF) &&
+            page_id == index_root_page_id_.load(std::memory_order_relaxed)) {
+            page_type = PAGE_TYPE_ROOT;
+        }
+        partition->stats.Record(page_type, ticker);
+    }
+
+    // Pin the page if it is cached and return its frame, waiting for io on
+    // the frame to finish. Returns nullptr if the page isn't cached.
+    // REQUIRES: partition->mu to be held by the caller through l, either
+    // shared or exclusively
+    template <typename Lock>
+    Page* pinCachedPage(Partition* partition, page_id_t page_id, Lock& l);
+
+    // Pin the frame of a swizzled reference if it holds the given page and
+    // isn't under io. Returns if it was pinned.
+    bool pinSwizzledPage(Page* page, page_id_t page_id);
+
+    // Report a hit on the page through a swizzled reference
+    void recordSwizzledHit(Page* page, page_id_t page_id);
+
+    // Get the swizzled reference of the slot of the frame
+    inline std::atomic<Page*>* getSwizzledChild(Page* parent, int slot) {
+        CHECK(slot >= 0 && slot <= BPLUS_INTERNAL_KEY_PAGE_ID_SIZE);
+        int frame_number =
+            (parent->data_ - arena_.GetPageData(0)) / PAGE_SIZE;
+        return &swizzled_children_[frame_number][slot];
+    }
+
+    // Read the page into a frame found by findIndexToEvict and pin it
+    // REQUIRES: partition->mu to be held exclusively by the caller through l
+    absl::StatusOr<Page*> readPage(Partition* partition, page_id_t page_id,
+                                   std::unique_lock<std::shared_mutex>& l);
+
+    // Find an empty frame in the partition or evict one of the pages.
+    // The frame is mapped to new_page_id in the page table and returned with
+    // io in progress set and its exclusive latch held. Its swizzled
+    // references are reset. The caller MUST
+    // release the latch, clear io in progress and notify io_done once it has
+    // filled the frame.
+    //
+    // The hits recorded since the last eviction are reported to the policy
+    // first. Releases l while latching the frame and writing back a dirty
+    // page which is evicted. The evicted page is added to the compressed
+    // cache.
+    // REQUIRES: partition->mu to be held exclusively by the caller through l
+    absl::StatusOr<int> findIndexToEvict(
+        Partition* partition, page_id_t new_page_id,
+        std::unique_lock<std::shared_mutex>& l);
+
+    // Mark the page in the frame dirty as of the given log number and add it
+    // to the dirty frames. Does nothing if it is dirty already.
+    // REQUIRES: partition->mu to be held by the caller
+    void markPageDirty(Partition* partition, int frame_index,
+                       ln_t dirty_log_number);
+
+    // Mark the page in the frame clean and remove it from the dirty frames
+    // REQUIRES: partition->mu to be held by the caller
+    void markPageClean(Partition* partition, int frame_index);
+
+    // Apply fn to the free space map page under its exclusive latch. The page
+    // is marked dirty if fn returns true.
+    absl::Status updateFreeSpaceMap(
+        absl::FunctionRef<bool(FreeSpaceMapPage*)> fn);
+
+    // Write the page of the frame if it is still the given dirty page and
+    // it is neither pinned nor under io. Returns if it was written.
+    absl::StatusOr<bool> flushPage(Partition* partition, int frame_index,
+                                   page_id_t page_id);
 
     DiskManager* disk_manager_;
     LogManager* log_manager_;
-    std::shared_mutex mu_;  // protects page_id_to_cache_index_ and
-                            // cache_index_to_page_id_
+    std::mutex allocation_mu_;  // protects next_page_id_
     page_id_t next_page_id_{STARTING_NORMAL_PAGE_ID};
-    std::map<page_id_t, int> page_id_to_cache_index_;
-    std::map<int, page_id_t> cache_index_to_page_id_;
-    int eviction_start_idx_ = 0;
-    std::vector<page_id_t> overflow_pages_;
-    Page cache_[PAGE_BUFFER_SIZE];
+    PageArena arena_{PAGE_BUFFER_SIZE};  // data of the frames
+    Partition partitions_[PAGE_BUFFER_PARTITIONS];
+    std::atomic<Page*> swizzled_children_[PAGE_BUFFER_SIZE]
+                                         [BPLUS_INTERNAL_KEY_PAGE_ID_SIZE + 1] =
+                                             {};  // frame of the child in
+                                                  // each slot of a frame,
+                                                  // by arena page number
+    std::atomic<int> dirty_page_count_{0};
+    std::atomic<page_id_t> index_root_page_id_{
+        INVALID_PAGE_ID};  // counted as PAGE_TYPE_ROOT in the stats
+    std::unique_ptr<CompressedPageCache>
+        compressed_cache_;  // nullptr if disabled
+    std::unique_ptr<BackgroundWriter> background_writer_;
+    std::unique_ptr<Readahead> readahead_;
+    std::unique_ptr<Warmup> warmup_;
 };
 
 }  // namespace graphchaindb
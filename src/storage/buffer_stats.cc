@@ -0,0 +1,104 @@
+#include "buffer_stats.h"
+
+#include "absl/strings/str_format.h"
+
+namespace graphchaindb {
+
+const char* BufferTickerName(BufferTicker ticker) {
+    switch (ticker) {
+        case BUFFER_HIT:
+            return "hit";
+        case BUFFER_MISS:
+            return "miss";
+        case BUFFER_EVICTION:
+            return "eviction";
+        case BUFFER_WRITE_BACK:
+            return "write_back";
+        case BUFFER_FLUSH:
+            return "flush";
+        case BUFFER_PIN_WAIT:
+            return "pin_wait";
+        case BUFFER_EVICTION_FAILURE:
+            return "eviction_failure";
+        case BUFFER_SWIZZLED_HIT:
+            return "swizzled_hit";
+        case BUFFER_COMPRESSED_HIT:
+            return "compressed_hit";
+        default:
+            return "unknown";
+    }
+}
+
+const char* PageTypeName(PageType page_type) {
+    switch (page_type) {
+        case PAGE_TYPE_ROOT:
+            return "root";
+        case PAGE_TYPE_BPLUS_INTERNAL:
+            return "internal";
+        case PAGE_TYPE_BPLUS_LEAF:
+            return "leaf";
+        case PAGE_TYPE_OVERFLOW:
+            return "overflow";
+        case PAGE_TYPE_FREE_SPACE_MAP:
+            return "free_space_map";
+        default:
+            return "unknown";
+    }
+}
+
+uint64_t BufferStatsSnapshot::GetTotal(BufferTicker ticker) const {
+    uint64_t total = 0;
+    for (int t = 0; t < PAGE_TYPE_COUNT; t++) {
+        total += counters[t][ticker];
+    }
+    return total;
+}
+
+double BufferStatsSnapshot::GetHitRatio(PageType page_type) const {
+    uint64_t hits = Get(page_type, BUFFER_HIT);
+    uint64_t requests = hits + Get(page_type, BUFFER_MISS);
+    return requests == 0 ? 0 : static_cast<double>(hits) / requests;
+}
+
+double BufferStatsSnapshot::GetTotalHitRatio() const {
+    uint64_t hits = GetTotal(BUFFER_HIT);
+    uint64_t requests = hits + GetTotal(BUFFER_MISS);
+    return requests == 0 ? 0 : static_cast<double>(hits) / requests;
+}
+
+std::string BufferStatsSnapshot::ToString() const {
+    std::string result = absl::StrFormat("%-14s", "type");
+    for (int k = 0; k < BUFFER_TICKER_COUNT; k++) {
+        absl::StrAppendFormat(&result, " %16s",
+                              BufferTickerName(static_cast<BufferTicker>(k)));
+    }
+    absl::StrAppendFormat(&result, " %9s\n", "hit_ratio");
+
+    for (int t = 0; t < PAGE_TYPE_COUNT; t++) {
+        auto page_type = static_cast<PageType>(t);
+        absl::StrAppendFormat(&result, "%-14s", PageTypeName(page_type));
+        for (int k = 0; k < BUFFER_TICKER_COUNT; k++) {
+            absl::StrAppendFormat(&result, " %16d", counters[t][k]);
+        }
+        absl::StrAppendFormat(&result, " %9.4f\n", GetHitRatio(page_type));
+    }
+
+    absl::StrAppendFormat(&result, "%-14s", "total");
+    for (int k = 0; k < BUFFER_TICKER_COUNT; k++) {
+        absl::StrAppendFormat(&result, " %16d",
+                              GetTotal(static_cast<BufferTicker>(k)));
+    }
+    absl::StrAppendFormat(&result, " %9.4f\n", GetTotalHitRatio());
+    return result;
+}
+
+void BufferStats::AddTo(BufferStatsSnapshot* snapshot) const {
+    for (int t = 0; t < PAGE_TYPE_COUNT; t++) {
+        for (int k = 0; k < BUFFER_TICKER_COUNT; k++) {
+            snapshot->counters[t][k] +=
+                counters_[t][k].load(std::memory_order_relaxed);
+        }
+    }
+}
+
+}  // namespace graphchaindb
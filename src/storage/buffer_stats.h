@@ -0,0 +1,90 @@
+#ifndef STORAGE_BUFFER_STATS_H
+#define STORAGE_BUFFER_STATS_H
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+#include "src/storage/page.h"
+
+namespace graphchaindb {
+
+static constexpr int PAGE_TYPE_COUNT =
+    PAGE_TYPE_FREE_SPACE_MAP + 1;  // number of values of PageType
+
+// Events of the buffer pool which are counted by BufferStats
+enum BufferTicker {
+    BUFFER_HIT,               // the page was found in the pool
+    BUFFER_MISS,              // the page was read from disk
+    BUFFER_EVICTION,          // the page was evicted from the pool
+    BUFFER_WRITE_BACK,        // the dirty page was written when evicted
+    BUFFER_FLUSH,             // the dirty page was written ahead of eviction
+    BUFFER_PIN_WAIT,          // a request waited for io on the frame
+    BUFFER_EVICTION_FAILURE,  // no frame could be evicted for the page
+    BUFFER_SWIZZLED_HIT,      // the hit was through a swizzled reference,
+                              // it is counted as a hit as well
+    BUFFER_COMPRESSED_HIT,    // the miss was served by the compressed cache,
+                              // it is counted as a miss as well
+    BUFFER_TICKER_COUNT
+};
+
+// Get the name of the ticker
+const char* BufferTickerName(BufferTicker ticker);
+
+// Get the name of the page type
+const char* PageTypeName(PageType page_type);
+
+// A point in time copy of one or more BufferStats
+struct BufferStatsSnapshot {
+    // Get the count of the ticker for pages of the given type
+    uint64_t Get(PageType page_type, BufferTicker ticker) const {
+        return counters[page_type][ticker];
+    }
+
+    // Get the count of the ticker for pages of any type
+    uint64_t GetTotal(BufferTicker ticker) const;
+
+    // Get the ratio of the requests for pages of the given type which were
+    // hits. Returns 0 if there were none.
+    double GetHitRatio(PageType page_type) const;
+
+    // Get the ratio of the requests for any page which were hits
+    double GetTotalHitRatio() const;
+
+    // Format the counters as a table with a row per page type
+    std::string ToString() const;
+
+    uint64_t counters[PAGE_TYPE_COUNT][BUFFER_TICKER_COUNT] = {};
+};
+
+// BufferStats counts the events of the buffer pool by the type of the page.
+// The root of the index is counted as PAGE_TYPE_ROOT, see
+// BufferManager::SetIndexRootPageId.
+//
+// The counters are updated without locks and summed up into a snapshot on
+// read. A snapshot taken while events are recorded isn't consistent across
+// counters.
+//
+// It is thread safe.
+class BufferStats {
+   public:
+    BufferStats() = default;
+
+    BufferStats(const BufferStats&) = delete;
+    BufferStats& operator=(const BufferStats&) = delete;
+
+    // Count an event for a page of the given type
+    inline void Record(PageType page_type, BufferTicker ticker) {
+        counters_[page_type][ticker].fetch_add(1, std::memory_order_relaxed);
+    }
+
+    // Add the counters to the snapshot
+    void AddTo(BufferStatsSnapshot* snapshot) const;
+
+   private:
+    std::atomic<uint64_t> counters_[PAGE_TYPE_COUNT][BUFFER_TICKER_COUNT] = {};
+};
+
+}  // namespace graphchaindb
+
+#endif  // STORAGE_BUFFER_STATS_H
@@ -0,0 +1,63 @@
+#include "clock_replacement_policy.h"
+
+#include <glog/logging.h>
+
+namespace graphchaindb {
+
+ClockReplacementPolicy::ClockReplacementPolicy(int frame_count)
+    : frame_count_{frame_count},
+      tracked_(frame_count, false),
+      referenced_(frame_count, false) {
+    CHECK_GT(frame_count_, 0);
+}
+
+void ClockReplacementPolicy::RecordInsert(int frame_index,
+                                          page_id_t /* page_id */) {
+    tracked_[frame_index] = true;
+    referenced_[frame_index] = true;
+}
+
+void ClockReplacementPolicy::RestoreEvicted(int frame_index,
+                                            page_id_t /* page_id */) {
+    // the frame was chosen with its reference bit cleared
+    tracked_[frame_index] = true;
+    referenced_[frame_index] = false;
+}
+
+void ClockReplacementPolicy::RecordAccess(int frame_index) {
+    referenced_[frame_index] = true;
+}
+
+void ClockReplacementPolicy::Remove(int frame_index) {
+    tracked_[frame_index] = false;
+    referenced_[frame_index] = false;
+}
+
+absl::StatusOr<int> ClockReplacementPolicy::Evict(
+    absl::FunctionRef<bool(int)> is_evictable) {
+    // The first sweep clears the reference bits of all evictable frames, so
+    // an evictable frame is always found by the end of the second one.
+    // Referenced bits are only cleared once per access, which makes the
+    // victim selection amortized O(1).
+    for (int step = 0; step < 2 * frame_count_; step++) {
+        int frame_index = hand_;
+        hand_ = (hand_ + 1) % frame_count_;
+
+        if (!tracked_[frame_index] || !is_evictable(frame_index)) {
+            continue;
+        }
+
+        if (referenced_[frame_index]) {
+            referenced_[frame_index] = false;
+            continue;
+        }
+
+        tracked_[frame_index] = false;
+        return frame_index;
+    }
+
+    return absl::ResourceExhaustedError(
+        "ClockReplacementPolicy::Evict: all of the frames are in use");
+}
+
+}  // namespace graphchaindb
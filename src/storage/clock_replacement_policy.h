@@ -0,0 +1,49 @@
+#ifndef STORAGE_CLOCK_REPLACEMENT_POLICY_H
+#define STORAGE_CLOCK_REPLACEMENT_POLICY_H
+
+#include <vector>
+
+#include "replacement_policy.h"
+
+namespace graphchaindb {
+
+// CLOCK (second chance) replacement policy.
+//
+// Every frame has a reference bit which is set whenever the page in it is
+// accessed. The clock hand sweeps over the frames, clearing set reference
+// bits and evicting the first evictable frame whose bit is already clear.
+// A page which is accessed between two sweeps of the hand is never evicted
+// by the second one, which keeps frequently used pages such as the upper
+// levels of the B+ tree resident.
+//
+// Not thread safe.
+class ClockReplacementPolicy : public ReplacementPolicy {
+   public:
+    explicit ClockReplacementPolicy(int frame_count);
+
+    ClockReplacementPolicy(const ClockReplacementPolicy&) = delete;
+    ClockReplacementPolicy& operator=(const ClockReplacementPolicy&) = delete;
+
+    ~ClockReplacementPolicy() override = default;
+
+    void RecordInsert(int frame_index, page_id_t page_id) override;
+
+    void RestoreEvicted(int frame_index, page_id_t page_id) override;
+
+    void RecordAccess(int frame_index) override;
+
+    void Remove(int frame_index) override;
+
+    absl::StatusOr<int> Evict(
+        absl::FunctionRef<bool(int)> is_evictable) override;
+
+   private:
+    int frame_count_;
+    int hand_{0};
+    std::vector<bool> tracked_;
+    std::vector<bool> referenced_;
+};
+
+}  // namespace graphchaindb
+
+#endif  // STORAGE_CLOCK_REPLACEMENT_POLICY_H
@@ -0,0 +1,158 @@
+#include "compressed_page_cache.h"
+
+#include <glog/logging.h>
+
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+#include <utility>
+
+namespace graphchaindb {
+
+namespace {
+
+// Zero runs shorter than this are copied as part of the surrounding literal
+// bytes, they would take more space as a run of their own.
+constexpr int MIN_ZERO_RUN = 8;
+
+// Get the length of the run of zero bytes of the page starting at pos
+int ZeroRunLength(const char* data, int pos) {
+    int end = pos;
+    while (end < PAGE_SIZE && data[end] == 0) {
+        end++;
+    }
+    return end - pos;
+}
+
+void AppendLength(std::string* compressed, uint16_t length) {
+    compressed->append(reinterpret_cast<const char*>(&length),
+                       sizeof(length));
+}
+
+}  // namespace
+
+// The compressed page is a sequence of runs. Each run is the number of zero
+// bytes, the number of literal bytes and the literal bytes.
+bool CompressPage(const char* data, std::string* compressed) {
+    compressed->clear();
+
+    int pos = 0;
+    while (pos < PAGE_SIZE) {
+        int zeros = ZeroRunLength(data, pos);
+        pos += zeros;
+
+        int literal_start = pos;
+        while (pos < PAGE_SIZE) {
+            int run = ZeroRunLength(data, pos);
+            if (run >= MIN_ZERO_RUN || pos + run == PAGE_SIZE) {
+                break;
+            }
+            pos += run + 1;
+        }
+
+        AppendLength(compressed, zeros);
+        AppendLength(compressed, pos - literal_start);
+        compressed->append(data + literal_start, pos - literal_start);
+        if (compressed->size() >= PAGE_SIZE) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+bool DecompressPage(const std::string& compressed, char* data) {
+    size_t in = 0;
+    int out = 0;
+    while (in < compressed.size()) {
+        uint16_t zeros, literals;
+        if (in + sizeof(zeros) + sizeof(literals) > compressed.size()) {
+            return false;
+        }
+        memcpy(&zeros, compressed.data() + in, sizeof(zeros));
+        in += sizeof(zeros);
+        memcpy(&literals, compressed.data() + in, sizeof(literals));
+        in += sizeof(literals);
+
+        if (out + zeros + literals > PAGE_SIZE ||
+            in + literals > compressed.size()) {
+            return false;
+        }
+        memset(data + out, 0, zeros);
+        out += zeros;
+        memcpy(data + out, compressed.data() + in, literals);
+        out += literals;
+        in += literals;
+    }
+
+    return out == PAGE_SIZE;
+}
+
+CompressedPageCache::CompressedPageCache(size_t capacity)
+    : capacity_{capacity} {}
+
+bool CompressedPageCache::Insert(page_id_t page_id, const char* data) {
+    std::string compressed;
+    if (!CompressPage(data, &compressed) || compressed.size() > capacity_) {
+        VLOG(VERBOSE_CHEAP) << "CompressedPageCache::Insert: not caching page "
+                            << page_id;
+        return false;
+    }
+
+    std::unique_lock l(mu_);
+    auto index_itr = index_.find(page_id);
+    if (index_itr != index_.end()) {
+        erase(index_itr->second);
+    }
+
+    while (size_ + compressed.size() > capacity_) {
+        erase(std::prev(entries_.end()));
+    }
+
+    size_t size = compressed.size();
+    size_ += size;
+    entries_.push_front(Entry{page_id, size, std::move(compressed)});
+    index_[page_id] = entries_.begin();
+    return true;
+}
+
+bool CompressedPageCache::Take(page_id_t page_id, char* data) {
+    std::string compressed;
+    {
+        std::unique_lock l(mu_);
+        auto index_itr = index_.find(page_id);
+        if (index_itr == index_.end()) {
+            return false;
+        }
+
+        compressed = std::move(index_itr->second->compressed);
+        erase(index_itr->second);
+    }
+
+    if (!DecompressPage(compressed, data)) {
+        LOG(ERROR) << "CompressedPageCache::Take: malformed compressed page "
+                   << page_id;
+        return false;
+    }
+    return true;
+}
+
+int CompressedPageCache::GetPageCount() {
+    std::unique_lock l(mu_);
+    return entries_.size();
+}
+
+size_t CompressedPageCache::GetSize() {
+    std::unique_lock l(mu_);
+    return size_;
+}
+
+void CompressedPageCache::erase(std::list<Entry>::iterator entry) {
+    // the compressed data may have been moved out already, so its size is
+    // taken from the accounting of the entry rather than the string.
+    size_ -= entry->size;
+    index_.erase(entry->page_id);
+    entries_.erase(entry);
+}
+
+}  // namespace graphchaindb
@@ -0,0 +1,79 @@
+#ifndef STORAGE_COMPRESSED_PAGE_CACHE_H
+#define STORAGE_COMPRESSED_PAGE_CACHE_H
+
+#include <cstddef>
+#include <list>
+#include <map>
+#include <mutex>
+#include <string>
+
+#include "src/common/config.h"
+
+namespace graphchaindb {
+
+// Compress the page data into compressed. Returns false if the page doesn't
+// get any smaller.
+//
+// Runs of zero bytes are encoded as their length, everything else is copied
+// as is. The B+ tree pages are mostly unused key and value slots, so they
+// shrink a lot.
+bool CompressPage(const char* data, std::string* compressed);
+
+// Decompress a page compressed by CompressPage into data, which MUST hold
+// PAGE_SIZE Bytes. Returns false if compressed is malformed.
+bool DecompressPage(const std::string& compressed, char* data);
+
+// CompressedPageCache is a second tier of the buffer pool which keeps
+// compressed copies of the pages evicted from it in memory.
+//
+// The buffer pool inserts pages when it evicts them and takes them back out
+// on a miss, before reading from disk. A page is never in both, so the cache
+// never holds an outdated copy of a page. Only pages which are the same on
+// disk are inserted.
+//
+// The compressed pages take at most capacity Bytes. The least recently
+// inserted pages are dropped to make space for new ones.
+//
+// It is thread safe.
+class CompressedPageCache {
+   public:
+    explicit CompressedPageCache(size_t capacity);
+
+    CompressedPageCache(const CompressedPageCache&) = delete;
+    CompressedPageCache& operator=(const CompressedPageCache&) = delete;
+
+    // Compress and store the page, replacing a previous copy. Returns if it
+    // was stored.
+    bool Insert(page_id_t page_id, const char* data);
+
+    // Decompress the page into data and remove it from the cache. Returns if
+    // it was found.
+    bool Take(page_id_t page_id, char* data);
+
+    // Get the number of pages in the cache
+    int GetPageCount();
+
+    // Get the size of the compressed pages in Bytes
+    size_t GetSize();
+
+   private:
+    struct Entry {
+        page_id_t page_id;
+        size_t size;  // of the compressed page in Bytes
+        std::string compressed;
+    };
+
+    // Remove the entry and release its space
+    // REQUIRES: mu_ to be held by the caller
+    void erase(std::list<Entry>::iterator entry);
+
+    const size_t capacity_;
+    std::mutex mu_;  // protects the members below
+    size_t size_ = 0;
+    std::list<Entry> entries_;  // the most recently inserted first
+    std::map<page_id_t, std::list<Entry>::iterator> index_;
+};
+
+}  // namespace graphchaindb
+
+#endif  // STORAGE_COMPRESSED_PAGE_CACHE_H
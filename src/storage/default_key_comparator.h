@@ -26,6 +26,8 @@ class DefaultKeyComparator : public KeyComparator {
         auto comp = a.compare(b);
         return (comp == 0) ? comp : ((comp < 0) ? -1 : 1);
     }
+
+    bool IsBytewise() override { return true; }
 };
 
 }  // namespace graphchaindb
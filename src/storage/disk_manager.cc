@@ -1,10 +1,16 @@
 #include "disk_manager.h"
 
+#include <fcntl.h>
 #include <glog/logging.h>
 #include <sys/stat.h>
+#include <unistd.h>
 
+#include <cstdio>
 #include <iostream>
+#include <memory>
+#include <new>
 
+#include "src/storage/free_space_map_page.h"
 #include "src/storage/log_entry.h"
 
 namespace graphchaindb {
@@ -13,20 +19,21 @@ DiskManager::DiskManager(absl::string_view db_path)
     : db_path_{std::string{db_path.data(), db_path.size()}} {}
 
 DiskManager::~DiskManager() {
-    db_file_.close();
+    if (db_fd_ != -1) {
+        close(db_fd_);
+    }
     log_file_.close();
 }
 
 absl::StatusOr<RootPage*> DiskManager::LoadDB() {
     LOG(INFO) << "DiskManager::LoadDB: Start at " << db_path_;
 
-    db_file_.open(db_path_ + ".db",
-                  std::ios::in | std::ios::binary | std::ios::out);
+    db_fd_ = open((db_path_ + ".db").c_str(), O_RDWR);
 
     log_file_.open(db_path_ + ".log", std::ios::in | std::ios::binary |
                                           std::ios::out | std::ios::app);
 
-    if (!db_file_.is_open() || !log_file_.is_open()) {
+    if (db_fd_ == -1 || !log_file_.is_open()) {
         LOG(ERROR) << "DiskManager::LoadDB: error while "
                       "opening db and log files: "
                    << strerror(errno);
@@ -47,19 +54,43 @@ absl::StatusOr<RootPage*> DiskManager::LoadDB() {
 
     CHECK_EQ(root_page->GetPageId(), ROOT_PAGE_ID);
     CHECK_EQ(root_page->GetPageType(), PAGE_TYPE_ROOT);
+
+    // an older file keeps a B+ tree page where the free space map is now
+    if (root_page->GetFormatVersion() != DB_FORMAT_VERSION) {
+        LOG(ERROR) << "DiskManager::LoadDB: unsupported format version "
+                   << root_page->GetFormatVersion();
+        delete[] root_data;
+        return absl::FailedPreconditionError(
+            "the db file has an unsupported format");
+    }
+
+    auto free_space_map_data = std::make_unique<char[]>(PAGE_SIZE);
+    s = ReadPage(FREE_SPACE_MAP_PAGE_ID, free_space_map_data.get());
+    if (!s.ok() ||
+        reinterpret_cast<FreeSpaceMapPage*>(free_space_map_data.get())
+                ->GetPageType() != PAGE_TYPE_FREE_SPACE_MAP) {
+        LOG(ERROR) << "DiskManager::LoadDB: the free space map page is "
+                      "missing";
+        delete[] root_data;
+        return absl::FailedPreconditionError(
+            "the db file has no free space map");
+    }
+
     return root_page;
 }
 
 absl::StatusOr<RootPage*> DiskManager::CreateDBFilesAndLoadDB() {
     LOG(INFO) << "DiskManager::CreateDBFilesAndLoadDB: Start at " << db_path_;
 
-    db_file_.open(db_path_ + ".db", std::ios::in | std::ios::binary |
-                                        std::ios::out | std::ios::trunc);
+    db_fd_ = open((db_path_ + ".db").c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+
+    // the pages of a previous database with this path are meaningless now
+    unlink((db_path_ + ".warmup").c_str());
 
     log_file_.open(db_path_ + ".log", std::ios::in | std::ios::binary |
                                           std::ios::out | std::ios::trunc);
 
-    if (!db_file_.is_open() || !log_file_.is_open()) {
+    if (db_fd_ == -1 || !log_file_.is_open()) {
         LOG(ERROR) << "DiskManager::CreateDBFilesAndLoadDB: error while "
                       "creating db and log files: "
                    << strerror(errno);
@@ -68,17 +99,27 @@ absl::StatusOr<RootPage*> DiskManager::CreateDBFilesAndLoadDB() {
             "unable to create and open db and log files.");
     }
 
-    std::unique_ptr<RootPage> temp_root = std::make_unique<RootPage>();
-    absl::Status s =
-        WritePage(ROOT_PAGE_ID, reinterpret_cast<char*>(temp_root.get()),
+    // the root page is smaller than a page, write it within a whole one
+    auto root_data = std::make_unique<char[]>(PAGE_SIZE);
+    new (root_data.get()) RootPage();
+    absl::Status s = WritePage(ROOT_PAGE_ID, root_data.get(), /* flush */ true);
+    if (!s.ok()) {
+        return s;
+    }
+
+    auto free_space_map_data = std::make_unique<char[]>(PAGE_SIZE);
+    reinterpret_cast<FreeSpaceMapPage*>(free_space_map_data.get())
+        ->InitPage(FREE_SPACE_MAP_PAGE_ID);
+    s = WritePage(FREE_SPACE_MAP_PAGE_ID, free_space_map_data.get(),
                   /* flush */ true);
     if (!s.ok()) {
         return s;
     }
 
-    // creation done, close the fstream so that they can be loaded in a
+    // creation done, close the files so that they can be loaded in a
     // different mode.
-    db_file_.close();
+    close(db_fd_);
+    db_fd_ = -1;
     log_file_.close();
 
     return LoadDB();
@@ -150,27 +191,31 @@ absl::Status DiskManager::ReadPage(page_id_t page_id, char* destination) {
     LOG(INFO) << "DiskManager::ReadPage: Start for page id: " << page_id;
     CHECK_NE(page_id, INVALID_PAGE_ID);
 
-    int db_file_offset = page_id * PAGE_SIZE;
-    db_file_.seekp(db_file_offset, std::ios::beg);
-    if (db_file_.bad()) {
-        LOG(ERROR) << "DiskManager::ReadPage: error while "
-                      "seeking db file to a page location: "
-                   << strerror(errno);
-        return absl::InternalError(
-            "error in seeking db file to a page location");
-    }
-
-    db_file_.read(destination, PAGE_SIZE);
-    if (db_file_.bad()) {
-        LOG(ERROR) << "DiskManager::ReadPage: error while "
-                      "reading page from disk: "
-                   << strerror(errno);
-        return absl::InternalError("error in reading page from disk");
+    off_t db_file_offset = static_cast<off_t>(page_id) * PAGE_SIZE;
+    ssize_t read_size = 0;
+    while (read_size < PAGE_SIZE) {
+        ssize_t n = pread(db_fd_, destination + read_size,
+                          PAGE_SIZE - read_size, db_file_offset + read_size);
+        if (n == -1 && errno == EINTR) {
+            continue;
+        }
+
+        if (n == -1) {
+            LOG(ERROR) << "DiskManager::ReadPage: error while "
+                          "reading page from disk: "
+                       << strerror(errno);
+            return absl::InternalError("error in reading page from disk");
+        }
+
+        // the page was allocated but never written, the rest of it is empty.
+        if (n == 0) {
+            memset(destination + read_size, 0, PAGE_SIZE - read_size);
+            break;
+        }
+
+        read_size += n;
     }
 
-    // TODO: what is read size < page size
-    // TODO: what if page_id position is more than the file size?
-
     return absl::OkStatus();
 }
 
@@ -178,34 +223,137 @@ absl::Status DiskManager::WritePage(page_id_t page_id, char* data, bool flush) {
     LOG(INFO) << "DiskManager::WritePage: Start for page id: " << page_id;
     CHECK_NE(page_id, INVALID_PAGE_ID);
 
-    int64_t db_file_offset = page_id * PAGE_SIZE;
-    db_file_.seekp(db_file_offset, std::ios::beg);
-    if (db_file_.bad()) {
-        LOG(ERROR) << "DiskManager::WritePage: error while "
-                      "seeking db file to a page location: "
+    off_t db_file_offset = static_cast<off_t>(page_id) * PAGE_SIZE;
+    ssize_t written_size = 0;
+    while (written_size < PAGE_SIZE) {
+        ssize_t n = pwrite(db_fd_, data + written_size,
+                           PAGE_SIZE - written_size,
+                           db_file_offset + written_size);
+        if (n == -1 && errno == EINTR) {
+            continue;
+        }
+
+        if (n == -1) {
+            LOG(ERROR) << "DiskManager::WritePage: error while "
+                          "writing data to a page on disk: "
+                       << strerror(errno);
+            return absl::InternalError(
+                "error in writing data to a page on disk");
+        }
+
+        written_size += n;
+    }
+
+    // pwrite hands the data to the kernel directly, which is all that
+    // flushing the stream buffer used to guarantee.
+    (void)flush;
+
+    return absl::OkStatus();
+}
+
+absl::Status DiskManager::WriteWarmupFile(
+    const std::vector<page_id_t>& page_ids) {
+    LOG(INFO) << "DiskManager::WriteWarmupFile: Start with "
+              << page_ids.size() << " pages";
+
+    auto path = db_path_ + ".warmup";
+    auto temp_path = path + ".tmp";
+    int warmup_fd = open(temp_path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (warmup_fd == -1) {
+        LOG(ERROR) << "DiskManager::WriteWarmupFile: error while creating "
+                      "the warm-up file: "
                    << strerror(errno);
-        return absl::InternalError(
-            "error in seeking db file to a page location");
+        return absl::InternalError("error in creating the warm-up file");
+    }
+
+    int32_t count = page_ids.size();
+    std::string contents(reinterpret_cast<char*>(&count), sizeof(count));
+    contents.append(reinterpret_cast<const char*>(page_ids.data()),
+                    count * sizeof(page_id_t));
+
+    size_t written_size = 0;
+    while (written_size < contents.size()) {
+        ssize_t n = write(warmup_fd, contents.data() + written_size,
+                          contents.size() - written_size);
+        if (n == -1 && errno == EINTR) {
+            continue;
+        }
+
+        if (n == -1) {
+            LOG(ERROR) << "DiskManager::WriteWarmupFile: error while writing "
+                          "the warm-up file: "
+                       << strerror(errno);
+            close(warmup_fd);
+            return absl::InternalError("error in writing the warm-up file");
+        }
+
+        written_size += n;
     }
 
-    db_file_.write(data, PAGE_SIZE);
-    if (db_file_.bad()) {
-        LOG(ERROR) << "DiskManager::WritePage: error while "
-                      "writing data to a page on disk: "
+    // the contents must be durable before the rename makes them visible
+    if (fsync(warmup_fd) != 0) {
+        LOG(ERROR) << "DiskManager::WriteWarmupFile: error while syncing "
+                      "the warm-up file: "
                    << strerror(errno);
-        return absl::InternalError("error in writing data to a page on disk");
+        close(warmup_fd);
+        return absl::InternalError("error in syncing the warm-up file");
     }
+    close(warmup_fd);
 
-    if (flush) {
-        db_file_.flush();
+    if (rename(temp_path.c_str(), path.c_str()) != 0) {
+        LOG(ERROR) << "DiskManager::WriteWarmupFile: error while renaming "
+                      "the warm-up file: "
+                   << strerror(errno);
+        return absl::InternalError("error in renaming the warm-up file");
     }
 
-    // TODO: what is read size < page size
-    // TODO: what if page_id position is more than the file size?
+    // and the rename itself is durable only once the directory is synced
+    auto separator = path.find_last_of('/');
+    auto directory =
+        separator == std::string::npos ? "." : path.substr(0, separator + 1);
+    int directory_fd = open(directory.c_str(), O_RDONLY | O_DIRECTORY);
+    if (directory_fd == -1 || fsync(directory_fd) != 0) {
+        LOG(ERROR) << "DiskManager::WriteWarmupFile: error while syncing "
+                      "the directory of the warm-up file: "
+                   << strerror(errno);
+        if (directory_fd != -1) {
+            close(directory_fd);
+        }
+        return absl::InternalError(
+            "error in syncing the directory of the warm-up file");
+    }
+    close(directory_fd);
 
     return absl::OkStatus();
 }
 
+absl::StatusOr<std::vector<page_id_t>> DiskManager::ReadWarmupFile() {
+    LOG(INFO) << "DiskManager::ReadWarmupFile: Start";
+
+    std::ifstream warmup_file(db_path_ + ".warmup",
+                              std::ios::in | std::ios::binary);
+    if (!warmup_file.is_open()) {
+        return absl::NotFoundError("warm-up file not found");
+    }
+
+    int32_t count = 0;
+    warmup_file.read(reinterpret_cast<char*>(&count), sizeof(count));
+    if (!warmup_file.good() || count < 0) {
+        LOG(ERROR) << "DiskManager::ReadWarmupFile: invalid warm-up file";
+        return absl::DataLossError("invalid warm-up file");
+    }
+
+    std::vector<page_id_t> page_ids(count);
+    warmup_file.read(reinterpret_cast<char*>(page_ids.data()),
+                     count * sizeof(page_id_t));
+    if (!warmup_file.good()) {
+        LOG(ERROR) << "DiskManager::ReadWarmupFile: truncated warm-up file";
+        return absl::DataLossError("truncated warm-up file");
+    }
+
+    return page_ids;
+}
+
 int32_t DiskManager::GetLogFileSize() { return GetFileSize(db_path_ + ".log"); }
 
 int32_t DiskManager::GetFileSize(std::string file_name) {
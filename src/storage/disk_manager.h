@@ -3,6 +3,7 @@
 
 #include <fstream>
 #include <string>
+#include <vector>
 
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
@@ -13,7 +14,10 @@
 namespace graphchaindb {
 
 // DiskManager is responsible for reading and writing to db and log files
-// todo: Thread safety?
+//
+// Pages are read and written with positional io on the db file, so page io
+// is thread safe and concurrent page reads/writes don't serialize on it.
+// todo: Thread safety of the log file?
 class DiskManager {
    public:
     explicit DiskManager(absl::string_view db_path);
@@ -27,7 +31,9 @@ class DiskManager {
     //
     // MUST be called before any set/get operation on the database.
     //
-    // Returns NotFoundError if the files aren't found
+    // Returns NotFoundError if the files aren't found and
+    // FailedPreconditionError if the db file has a different format, see
+    // DB_FORMAT_VERSION
     absl::StatusOr<RootPage*> LoadDB();
 
     // Create the db and log files on disk.
@@ -49,11 +55,21 @@ class DiskManager {
     // Get Log file size
     int32_t GetLogFileSize();
 
+    // Replace the warm-up file with the given page ids. The file is written
+    // aside, synced and renamed, so a crash leaves either the old or the new
+    // list.
+    absl::Status WriteWarmupFile(const std::vector<page_id_t>& page_ids);
+
+    // Read the page ids of the warm-up file
+    //
+    // Returns NotFoundError if there is no warm-up file
+    absl::StatusOr<std::vector<page_id_t>> ReadWarmupFile();
+
    private:
     int32_t GetFileSize(std::string file_name);
 
     std::string db_path_;
-    std::fstream db_file_;
+    int db_fd_{-1};
     std::fstream log_file_;
 };
 
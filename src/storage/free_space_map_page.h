@@ -0,0 +1,176 @@
+#ifndef STORAGE_FREE_SPACE_MAP_PAGE_H
+#define STORAGE_FREE_SPACE_MAP_PAGE_H
+
+#include <glog/logging.h>
+
+#include <algorithm>
+#include <cstdint>
+
+#include "page.h"
+#include "src/common/config.h"
+
+namespace graphchaindb {
+
+// The page which tracks the free space of the overflow pages.
+//
+// Every overflow page has an entry with its free space. The entries are
+// kept in doubly linked lists, one per size class of FREE_SPACE_CLASS_SIZE
+// bytes of free space, so finding a page with enough room only looks at the
+// heads of the lists and moving a page to another class is constant time.
+// A page is only taken from a class whose every page is guaranteed to have
+// the required space.
+//
+// The page is stored at FREE_SPACE_MAP_PAGE_ID. Overflow pages which don't
+// fit in it anymore are not tracked and never reused.
+//
+// Format (size in bytes):
+// ------------------------------------------------
+// | Headers (44) | Entry 1 (12) | Entry 2 (12) | ... |
+// ------------------------------------------------
+//
+// Header
+// -------------------------------------------------------------------
+// | PageType (4) | PageId (4) | Count (4) | List heads (2 * classes) |
+// -------------------------------------------------------------------
+//
+// Entry
+// -------------------------------------------------------------------
+// | PageId (4) | Free space (2) | Prev entry (2) | Next entry (2) | - |
+// -------------------------------------------------------------------
+//
+// REQUIRES: the appropriate latch on the page container to be held
+class FreeSpaceMapPage {
+   public:
+    FreeSpaceMapPage() = default;
+
+    FreeSpaceMapPage(const FreeSpaceMapPage&) = delete;
+    FreeSpaceMapPage& operator=(const FreeSpaceMapPage&) = delete;
+
+    ~FreeSpaceMapPage() = default;
+
+    // init the page
+    void InitPage(page_id_t page_id) {
+        page_type_ = PageType::PAGE_TYPE_FREE_SPACE_MAP;
+        page_id_ = page_id;
+        count_ = 0;
+        for (auto& head : heads_) {
+            head = NO_ENTRY;
+        }
+    }
+
+    // Get the page type
+    inline PageType GetPageType() { return page_type_; }
+
+    // Get the number of tracked overflow pages
+    inline int32_t GetCount() { return count_; }
+
+    // Get the id of the overflow page of the entry
+    inline page_id_t GetEntryPageId(int entry) {
+        return entries_[entry].page_id;
+    }
+
+    // Get the free space of the overflow page of the entry
+    inline int32_t GetEntryFreeSpace(int entry) {
+        return entries_[entry].free_space;
+    }
+
+    // Track an overflow page with the given free space. Returns its entry or
+    // -1 if the map is full.
+    int Add(page_id_t page_id, int32_t free_space) {
+        if (count_ == MAX_ENTRIES) {
+            return NO_ENTRY;
+        }
+
+        int entry = count_++;
+        entries_[entry].page_id = page_id;
+        entries_[entry].free_space = free_space;
+        link(entry);
+        return entry;
+    }
+
+    // Find an overflow page with at least the given free space and take it
+    // from the page. Returns its entry or -1 if there is none.
+    int Allocate(int32_t required_space) {
+        CHECK_GE(required_space, 0);
+
+        int size_class = (required_space + FREE_SPACE_CLASS_SIZE - 1) /
+                         FREE_SPACE_CLASS_SIZE;
+        for (; size_class < FREE_SPACE_CLASSES; size_class++) {
+            int entry = heads_[size_class];
+            if (entry != NO_ENTRY) {
+                CHECK_GE(entries_[entry].free_space, required_space);
+                SetFreeSpace(entry,
+                             entries_[entry].free_space - required_space);
+                return entry;
+            }
+        }
+
+        return NO_ENTRY;
+    }
+
+    // Set the free space of the overflow page of the entry
+    void SetFreeSpace(int entry, int32_t free_space) {
+        CHECK_GE(entry, 0);
+        CHECK_LT(entry, count_);
+
+        unlink(entry);
+        entries_[entry].free_space = free_space;
+        link(entry);
+    }
+
+    static constexpr int NO_ENTRY = -1;
+    static constexpr int HEADER_SIZE = 12 + 2 * FREE_SPACE_CLASSES;
+    static constexpr int ENTRY_SIZE = 12;
+    static constexpr int MAX_ENTRIES = (PAGE_SIZE - HEADER_SIZE) / ENTRY_SIZE;
+
+   private:
+    struct Entry {
+        page_id_t page_id;
+        int16_t free_space;
+        int16_t prev;
+        int16_t next;
+    };
+    static_assert(sizeof(Entry) == ENTRY_SIZE, "unexpected entry size");
+
+    static inline int sizeClassOf(int32_t free_space) {
+        return std::min(free_space / FREE_SPACE_CLASS_SIZE,
+                        FREE_SPACE_CLASSES - 1);
+    }
+
+    // push the entry to the front of the list of its size class
+    void link(int entry) {
+        int size_class = sizeClassOf(entries_[entry].free_space);
+        entries_[entry].prev = NO_ENTRY;
+        entries_[entry].next = heads_[size_class];
+        if (heads_[size_class] != NO_ENTRY) {
+            entries_[heads_[size_class]].prev = entry;
+        }
+        heads_[size_class] = entry;
+    }
+
+    // remove the entry from the list of its size class
+    void unlink(int entry) {
+        int size_class = sizeClassOf(entries_[entry].free_space);
+        if (entries_[entry].prev == NO_ENTRY) {
+            heads_[size_class] = entries_[entry].next;
+        } else {
+            entries_[entries_[entry].prev].next = entries_[entry].next;
+        }
+        if (entries_[entry].next != NO_ENTRY) {
+            entries_[entries_[entry].next].prev = entries_[entry].prev;
+        }
+    }
+
+    PageType page_type_;
+    page_id_t page_id_;
+    int32_t count_;
+    int16_t heads_[FREE_SPACE_CLASSES];
+    Entry entries_[MAX_ENTRIES];
+};
+
+static_assert(sizeof(FreeSpaceMapPage) <= PAGE_SIZE,
+              "FreeSpaceMapPage must fit in a page");
+
+}  // namespace graphchaindb
+
+#endif  // STORAGE_FREE_SPACE_MAP_PAGE_H
@@ -22,6 +22,11 @@ class KeyComparator {
     // 0 if first == second
     // 1 if first > second
     virtual int Compare(const absl::string_view, const absl::string_view) = 0;
+
+    // Returns if the keys are ordered byte by byte. The keys between two keys
+    // share their common prefix then, which the B+ tree pages strip, and the
+    // keys are ordered like their first bytes.
+    virtual bool IsBytewise() { return false; }
 };
 
 }  // namespace graphchaindb
@@ -0,0 +1,202 @@
+#include "key_head_search.h"
+
+#include <glog/logging.h>
+
+#include <algorithm>
+
+#if defined(__x86_64__) || defined(__i386__)
+#define KEY_HEAD_SEARCH_X86
+#include <immintrin.h>
+#endif
+
+#if defined(__ARM_NEON) && defined(__aarch64__)
+#define KEY_HEAD_SEARCH_NEON
+#include <arm_neon.h>
+#endif
+
+namespace graphchaindb {
+
+namespace {
+
+// the most heads the vector implementations scan before a larger one
+static constexpr int32_t SCAN_WINDOW = 64;
+
+KeyHeadRange searchKeyHeadsScalar(const uint32_t* key_heads, int32_t count,
+                                  uint32_t key_head) {
+    auto lower = std::lower_bound(key_heads, key_heads + count, key_head);
+    auto upper = std::upper_bound(lower, key_heads + count, key_head);
+    return {static_cast<int32_t>(lower - key_heads),
+            static_cast<int32_t>(upper - key_heads)};
+}
+
+// Scan the heads from the index on, of which smaller are smaller than the
+// key head. None of the heads before the index are larger.
+KeyHeadRange scanKeyHeads(const uint32_t* key_heads, int32_t index,
+                          int32_t count, uint32_t key_head, int32_t smaller) {
+    for (; index < count; index++) {
+        if (key_heads[index] > key_head) {
+            return {smaller, index};
+        }
+        if (key_heads[index] < key_head) {
+            smaller++;
+        }
+    }
+    return {smaller, count};
+}
+
+// Get an index at most SCAN_WINDOW heads before the first head which isn't
+// smaller than the key head. All of the heads before it are smaller.
+int32_t narrowKeyHeads(const uint32_t* key_heads, int32_t count,
+                       uint32_t key_head) {
+    int32_t base = 0;
+    while (count > SCAN_WINDOW) {
+        int32_t half = count / 2;
+        base = key_heads[base + half] < key_head ? base + half : base;
+        count -= half;
+    }
+    return base;
+}
+
+#ifdef KEY_HEAD_SEARCH_X86
+
+// The vector instructions compare signed integers, so the heads are
+// compared with their sign bits flipped.
+
+__attribute__((target("sse4.2"))) KeyHeadRange searchKeyHeadsSse42(
+    const uint32_t* key_heads, int32_t count, uint32_t key_head) {
+    const auto flip = _mm_set1_epi32(INT32_MIN);
+    const auto key = _mm_xor_si128(_mm_set1_epi32(key_head), flip);
+
+    int32_t index = narrowKeyHeads(key_heads, count, key_head);
+    int32_t smaller = index;
+    for (; index + 4 <= count; index += 4) {
+        auto heads = _mm_xor_si128(
+            _mm_loadu_si128(
+                reinterpret_cast<const __m128i*>(key_heads + index)),
+            flip);
+        smaller += __builtin_popcount(
+            _mm_movemask_ps(_mm_castsi128_ps(_mm_cmpgt_epi32(key, heads))));
+        int larger = __builtin_popcount(
+            _mm_movemask_ps(_mm_castsi128_ps(_mm_cmpgt_epi32(heads, key))));
+
+        // the heads are sorted, so the larger ones end the range
+        if (larger != 0) {
+            return {smaller, index + 4 - larger};
+        }
+    }
+    return scanKeyHeads(key_heads, index, count, key_head, smaller);
+}
+
+__attribute__((target("avx2"))) KeyHeadRange searchKeyHeadsAvx2(
+    const uint32_t* key_heads, int32_t count, uint32_t key_head) {
+    const auto flip = _mm256_set1_epi32(INT32_MIN);
+    const auto key = _mm256_xor_si256(_mm256_set1_epi32(key_head), flip);
+
+    int32_t index = narrowKeyHeads(key_heads, count, key_head);
+    int32_t smaller = index;
+    for (; index + 8 <= count; index += 8) {
+        auto heads = _mm256_xor_si256(
+            _mm256_loadu_si256(
+                reinterpret_cast<const __m256i*>(key_heads + index)),
+            flip);
+        smaller += __builtin_popcount(_mm256_movemask_ps(
+            _mm256_castsi256_ps(_mm256_cmpgt_epi32(key, heads))));
+        int larger = __builtin_popcount(_mm256_movemask_ps(
+            _mm256_castsi256_ps(_mm256_cmpgt_epi32(heads, key))));
+
+        // the heads are sorted, so the larger ones end the range
+        if (larger != 0) {
+            return {smaller, index + 8 - larger};
+        }
+    }
+    return scanKeyHeads(key_heads, index, count, key_head, smaller);
+}
+
+#endif  // KEY_HEAD_SEARCH_X86
+
+#ifdef KEY_HEAD_SEARCH_NEON
+
+KeyHeadRange searchKeyHeadsNeon(const uint32_t* key_heads, int32_t count,
+                                uint32_t key_head) {
+    const auto key = vdupq_n_u32(key_head);
+
+    int32_t index = narrowKeyHeads(key_heads, count, key_head);
+    int32_t smaller = index;
+    for (; index + 4 <= count; index += 4) {
+        auto heads = vld1q_u32(key_heads + index);
+        smaller += vaddvq_u32(vshrq_n_u32(vcltq_u32(heads, key), 31));
+        int larger = vaddvq_u32(vshrq_n_u32(vcgtq_u32(heads, key), 31));
+
+        // the heads are sorted, so the larger ones end the range
+        if (larger != 0) {
+            return {smaller, index + 4 - larger};
+        }
+    }
+    return scanKeyHeads(key_heads, index, count, key_head, smaller);
+}
+
+#endif  // KEY_HEAD_SEARCH_NEON
+
+}  // namespace
+
+KeyHeadRange SearchKeyHeads(KeyHeadSearchType type, const uint32_t* key_heads,
+                            int32_t count, uint32_t key_head) {
+    switch (type) {
+#ifdef KEY_HEAD_SEARCH_X86
+        case KeyHeadSearchType::SSE42:
+            return searchKeyHeadsSse42(key_heads, count, key_head);
+        case KeyHeadSearchType::AVX2:
+            return searchKeyHeadsAvx2(key_heads, count, key_head);
+#endif
+#ifdef KEY_HEAD_SEARCH_NEON
+        case KeyHeadSearchType::NEON:
+            return searchKeyHeadsNeon(key_heads, count, key_head);
+#endif
+        case KeyHeadSearchType::SCALAR:
+            return searchKeyHeadsScalar(key_heads, count, key_head);
+        default:
+            LOG(FATAL) << "unsupported key head search "
+                       << static_cast<int>(type);
+            return {0, 0};
+    }
+}
+
+KeyHeadRange SearchKeyHeads(const uint32_t* key_heads, int32_t count,
+                            uint32_t key_head) {
+    static const auto type = GetKeyHeadSearchType();
+    return SearchKeyHeads(type, key_heads, count, key_head);
+}
+
+bool IsKeyHeadSearchSupported(KeyHeadSearchType type) {
+    switch (type) {
+        case KeyHeadSearchType::SCALAR:
+            return true;
+#ifdef KEY_HEAD_SEARCH_X86
+        case KeyHeadSearchType::SSE42:
+            return __builtin_cpu_supports("sse4.2");
+        case KeyHeadSearchType::AVX2:
+            return __builtin_cpu_supports("avx2");
+#endif
+#ifdef KEY_HEAD_SEARCH_NEON
+        case KeyHeadSearchType::NEON:
+            return true;
+#endif
+        default:
+            return false;
+    }
+}
+
+KeyHeadSearchType GetKeyHeadSearchType() {
+    static const auto type = [] {
+        for (auto type : {KeyHeadSearchType::AVX2, KeyHeadSearchType::NEON,
+                          KeyHeadSearchType::SSE42}) {
+            if (IsKeyHeadSearchSupported(type)) {
+                return type;
+            }
+        }
+        return KeyHeadSearchType::SCALAR;
+    }();
+    return type;
+}
+
+}  // namespace graphchaindb
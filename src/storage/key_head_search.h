@@ -0,0 +1,47 @@
+#ifndef STORAGE_KEY_HEAD_SEARCH_H
+#define STORAGE_KEY_HEAD_SEARCH_H
+
+#include <cstdint>
+
+namespace graphchaindb {
+
+// The range [lower, upper) of the sorted key heads which are equal to a key
+// head. The heads before it are smaller and the heads after it larger.
+struct KeyHeadRange {
+    int32_t lower;
+    int32_t upper;
+};
+
+// The implementations of the search in the key heads of a B+ tree page, see
+// BplusTreePage::GetKeyHead.
+enum class KeyHeadSearchType {
+    SCALAR,  // binary search
+    SSE42,   // 4 heads per instruction
+    AVX2,    // 8 heads per instruction
+    NEON,    // 4 heads per instruction
+};
+
+// Search for the range of the count sorted key heads which are equal to the
+// key head with the given implementation, which MUST be supported.
+//
+// The vector implementations narrow the heads down with a branchless binary
+// search, and then count the smaller and the equal heads until a larger
+// one, which avoids the mispredicted branches of the last steps of a binary
+// search.
+KeyHeadRange SearchKeyHeads(KeyHeadSearchType type, const uint32_t* key_heads,
+                            int32_t count, uint32_t key_head);
+
+// Search for the range of the count sorted key heads which are equal to the
+// key head with the fastest implementation the CPU supports.
+KeyHeadRange SearchKeyHeads(const uint32_t* key_heads, int32_t count,
+                            uint32_t key_head);
+
+// Returns if the CPU supports the implementation
+bool IsKeyHeadSearchSupported(KeyHeadSearchType type);
+
+// Get the fastest implementation the CPU supports, which is selected once
+KeyHeadSearchType GetKeyHeadSearchType();
+
+}  // namespace graphchaindb
+
+#endif  // STORAGE_KEY_HEAD_SEARCH_H
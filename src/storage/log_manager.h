@@ -1,6 +1,7 @@
 #ifndef STORAGE_LOG_MANAGER_H
 #define STORAGE_LOG_MANAGER_H
 
+#include <atomic>
 #include <fstream>
 
 #include "absl/status/status.h"
@@ -44,9 +45,13 @@ class LogManager {
     // Set the next log number that will be used
     void SetNextLogNumber(ln_t next_ln) { next_ln_ = next_ln; }
 
+    // Get the next log number that will be used
+    ln_t GetNextLogNumber() { return next_ln_; }
+
    private:
     DiskManager* disk_manager_;
-    ln_t next_ln_{INVALID_LOG_NUMBER};
+    // read by the background writer of the buffer manager without any lock
+    std::atomic<ln_t> next_ln_{INVALID_LOG_NUMBER};
 };
 
 }  // namespace graphchaindb
@@ -1,11 +1,23 @@
 #ifndef STORAGE_OPTION_H
 #define STORAGE_OPTION_H
 
+#include <cstddef>
+
 namespace graphchaindb {
 
+// Indicates the page replacement policy used by the buffer pool.
+enum ReplacementPolicyType {
+    // CLOCK (second chance). Cheap, but a large scan evicts everything.
+    REPLACEMENT_POLICY_CLOCK,
+
+    // 2Q. Pages seen once are evicted before pages seen repeatedly, which
+    // keeps scans and bulk loads from flushing the hot pages.
+    REPLACEMENT_POLICY_TWO_QUEUE
+};
+
 // Provides options to use while loading the storage layer from disk
 struct Options {
-    Options();
+    Options() = default;
 
     // creates the database if it doesn't already exists
     // defaults to false
@@ -14,6 +26,20 @@ struct Options {
     // returns an error if the database already exists
     // defaults to true
     bool error_if_exists = true;
+
+    // the page replacement policy of the buffer pool
+    // defaults to REPLACEMENT_POLICY_CLOCK
+    ReplacementPolicyType replacement_policy = REPLACEMENT_POLICY_CLOCK;
+
+    // the size in Bytes of the compressed copies of evicted pages kept in
+    // memory, see CompressedPageCache. 0 disables the compressed cache.
+    // defaults to 0
+    size_t compressed_cache_size = 0;
+
+    // runs the B+ tree as a B-link tree. Pages are split without locking
+    // their parent, see BplusTree. Deletes don't merge the pages then.
+    // defaults to false
+    bool blink_tree = false;
 };
 
 // Provides options while storing key value pairs in storage
@@ -21,6 +47,17 @@ struct WriteOptions {
     WriteOptions() = default;
 };
 
+// Provides options while bulk loading key value pairs into storage
+struct BulkLoadOptions {
+    BulkLoadOptions() = default;
+
+    // the fraction of every page which is filled with the loaded pairs. The
+    // rest is left free for later inserts, which split the pages otherwise.
+    // MUST be in (0, 1].
+    // defaults to 0.9
+    double fill_factor = 0.9;
+};
+
 // Provides options while reading key value pairs from storage
 struct ReadOptions {
     ReadOptions() = default;
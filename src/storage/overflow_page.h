@@ -36,13 +36,16 @@ class OverflowPage {
     void InitPage(page_id_t page_id) {
         page_id_ = page_id;
         page_type_ = PageType::PAGE_TYPE_OVERFLOW;
+        space_used = HEADER_SIZE;
     }
 
-    // the next slot to insert new data in.
+    // the offset of the next slot to insert new data in. The offset starts
+    // from the data_ entry and doesn't include the header.
     // REQUIRES: exclusive lock is held on the page container.
-    inline int32_t NextSlot() { return space_used; }
+    inline int32_t NextSlot() { return space_used - HEADER_SIZE; }
 
-    // remaining capacity in the overflow page
+    // remaining capacity in the overflow page. A string needs its length
+    // plus the space for storing the length.
     inline int32_t RemainingCapacity() { return PAGE_SIZE - space_used; }
 
     // get string at the given offset. The offset starts from the
@@ -51,8 +54,10 @@ class OverflowPage {
         LOG(INFO) << "OverflowPage::GetStringAtOffset: offset " << offset;
         CHECK_GE(offset, 0);
 
-        auto size = *reinterpret_cast<int32_t*>(&data_[offset]);
-        CHECK_LT(offset + size + sizeof(int32_t), DATA_SIZE);
+        // the strings are packed, so the size isn't aligned
+        int32_t size;
+        memcpy(&size, &data_[offset], sizeof(int32_t));
+        CHECK_LE(offset + size + sizeof(int32_t), DATA_SIZE);
 
         return absl::string_view(&data_[offset + sizeof(int32_t)], size);
     }
@@ -65,7 +70,7 @@ class OverflowPage {
         CHECK_GE(offset, 0);
 
         auto size = data.length();
-        CHECK_LT(offset + size + sizeof(int32_t), DATA_SIZE);
+        CHECK_LE(offset + size + sizeof(int32_t), DATA_SIZE);
 
         space_used += sizeof(int32_t) + size;
 
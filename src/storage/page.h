@@ -4,6 +4,8 @@
 #include <glog/logging.h>
 
 #include <algorithm>
+#include <atomic>
+#include <cstdint>
 #include <shared_mutex>
 
 #include "absl/base/thread_annotations.h"
@@ -18,7 +20,8 @@ enum PageType {
     PAGE_TYPE_ROOT,
     PAGE_TYPE_BPLUS_INTERNAL,
     PAGE_TYPE_BPLUS_LEAF,
-    PAGE_TYPE_OVERFLOW
+    PAGE_TYPE_OVERFLOW,
+    PAGE_TYPE_FREE_SPACE_MAP
 };
 
 // Page represent a single unit of storage in the database.
@@ -28,12 +31,27 @@ enum PageType {
 // a base class which other pages inherit from. The actual data page is wrapped
 // within this class along with metadata obtained from it.
 //
+// Besides the read and exclusive locks, the page can be read optimistically
+// without writing to it. Its version is odd while the exclusive lock is held
+// and grows with every release, so a reader which saw the same even version
+// before and after reading knows that it read a consistent page. The buffer
+// manager holds the exclusive lock while it replaces the page of a frame.
+//
+// The page only holds the metadata of a frame of the buffer pool and points
+// to its data, which lives in a separate PageArena. The metadata is aligned
+// to a cache line so that the latches of neighbouring frames don't share one.
+//
 // This class is thread safe.
-class Page {
+class alignas(CACHE_LINE_SIZE) Page {
     friend class BufferManager;
 
    public:
-    Page() { ZeroOut(); };
+    // Creates a frame without data. The owner MUST attach the data before
+    // the page is used.
+    Page() = default;
+
+    // Creates a page over the given PAGE_SIZE bytes of data and zeroes it
+    explicit Page(char* data) : data_{CHECK_NOTNULL(data)} { ZeroOut(); }
 
     Page(const Page&) = delete;
     Page& operator=(const Page&) = delete;
@@ -41,7 +59,9 @@ class Page {
     ~Page() = default;
 
     // Get the page id
-    inline page_id_t GetPageId() { return page_id_; }
+    inline page_id_t GetPageId() {
+        return page_id_.load(std::memory_order_relaxed);
+    }
 
     // Get the actual page data
     inline char* GetData() { return data_; }
@@ -50,38 +70,82 @@ class Page {
     inline bool GetPageDirty() { return is_page_dirty_; }
 
     // Aquire a read lock on the page
-    inline void AquireReadLock() {
-        LOG(INFO) << "Page::AquireReadLock: page_id " << page_id_;
-        mu_.lock_shared();
-    }
+    inline void AquireReadLock() { mu_.lock_shared(); }
 
     // Release the read lock on the page
-    inline void ReleaseReadLock() {
-        LOG(INFO) << "Page::ReleaseReadLock: page_id " << page_id_;
-        mu_.unlock_shared();
-    }
+    inline void ReleaseReadLock() { mu_.unlock_shared(); }
 
-    // Aquire an exclusive lock on the page
+    // Aquire an exclusive lock on the page. Makes the version odd.
     inline void AquireExclusiveLock() {
-        LOG(INFO) << "Page::AquireExclusiveLock: page_id " << page_id_;
         mu_.lock();
+        version_.fetch_add(1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
     }
 
-    // Release the exclusive lock on the page
+    // Release the exclusive lock on the page. Makes the version even again.
     inline void ReleaseExclusiveLock() {
-        LOG(INFO) << "Page::ReleaseExclusiveLock: page_id " << page_id_;
+        version_.fetch_add(1, std::memory_order_release);
         mu_.unlock();
     }
 
+    // Start an optimistic read of the page. Returns false if the exclusive
+    // lock is held, in which case the caller should retry or lock.
+    //
+    // The data can change during the read. The caller MUST only copy out of
+    // it, tolerate garbage and call ValidateOptimisticRead before using
+    // anything it read.
+    inline bool StartOptimisticRead(uint64_t* version) {
+        *version = version_.load(std::memory_order_acquire);
+        return (*version & 1) == 0;
+    }
+
+    // Returns if the page is unchanged since the optimistic read which
+    // returned version started.
+    inline bool ValidateOptimisticRead(uint64_t version) {
+        std::atomic_thread_fence(std::memory_order_acquire);
+        return version_.load(std::memory_order_relaxed) == version;
+    }
+
+    // Aquire the exclusive lock if the page is unchanged since the optimistic
+    // read which returned version started. Returns false without the lock
+    // otherwise, in which case the caller should restart its read.
+    inline bool UpgradeOptimisticRead(uint64_t version) {
+        mu_.lock();
+        if (version_.load(std::memory_order_relaxed) != version) {
+            mu_.unlock();
+            return false;
+        }
+
+        version_.fetch_add(1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        return true;
+    }
+
    private:
     inline void ZeroOut() { memset(data_, 0, PAGE_SIZE); }
 
-    page_id_t page_id_;
+    // pin count of a frame which is claimed for eviction. It can't be
+    // pinned until the frame holds its new page.
+    static constexpr int PIN_COUNT_EVICTING = -1;
+
+    std::atomic<page_id_t> page_id_{INVALID_PAGE_ID};  // changed under the
+                                                        // lock of the owning
+                                                        // partition
     std::shared_mutex mu_;
-    int pin_count_ = 0;
-    bool second_chance_ = false;  // for clock eviction policy
-    bool is_page_dirty_ = false;
-    char data_[PAGE_SIZE] GUARDED_BY(mu_);
+    std::atomic<uint64_t> version_{0};  // odd while mu_ is held exclusively
+    std::atomic<int> pin_count_{0};  // incremented under the lock of the
+                                     // owning partition or through a
+                                     // swizzled reference
+    std::atomic<PageType> page_type_{
+        PAGE_TYPE_INVALID};  // type of the page last read or written, changed
+                             // under the lock of the owning partition
+    std::atomic<bool> io_in_progress_{false};  // changed under the lock of
+                                               // the owning partition
+    bool is_page_dirty_ = false;   // guarded by the lock of the owning
+                                   // partition
+    ln_t dirty_log_number_ = INVALID_LOG_NUMBER;  // next log number when the
+                                                  // page was made dirty
+    char* data_ PT_GUARDED_BY(mu_) = nullptr;  // PAGE_SIZE bytes in an arena
 };
 
 }  // namespace graphchaindb
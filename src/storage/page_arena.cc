@@ -0,0 +1,71 @@
+#include "page_arena.h"
+
+#include <glog/logging.h>
+#include <sys/mman.h>
+
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+
+namespace graphchaindb {
+
+namespace {
+
+size_t RoundUp(size_t size, size_t alignment) {
+    return (size + alignment - 1) / alignment * alignment;
+}
+
+}  // namespace
+
+PageArena::PageArena(int num_pages) : num_pages_{num_pages} {
+    CHECK_GT(num_pages, 0);
+    size_t size = static_cast<size_t>(num_pages) * PAGE_SIZE;
+
+    if (size >= HUGE_PAGE_SIZE) {
+        size_ = RoundUp(size, HUGE_PAGE_SIZE);
+        void* data = mmap(nullptr, size_, PROT_READ | PROT_WRITE,
+                          MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+        if (data != MAP_FAILED) {
+            LOG(INFO) << "PageArena::PageArena: Mapped " << size_
+                      << " bytes with MAP_HUGETLB";
+            allocation_ = Allocation::HUGETLB;
+            data_ = static_cast<char*>(data);
+            return;
+        }
+        LOG(INFO) << "PageArena::PageArena: MAP_HUGETLB failed with errno "
+                  << errno << ". Falling back to transparent huge pages";
+    }
+
+    size_ = size;
+    void* data = mmap(nullptr, size_, PROT_READ | PROT_WRITE,
+                      MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (data != MAP_FAILED) {
+#ifdef MADV_HUGEPAGE
+        if (madvise(data, size_, MADV_HUGEPAGE) != 0) {
+            LOG(INFO) << "PageArena::PageArena: MADV_HUGEPAGE failed with "
+                         "errno "
+                      << errno;
+        }
+#endif
+        allocation_ = Allocation::MMAP;
+        data_ = static_cast<char*>(data);
+        return;
+    }
+
+    LOG(ERROR) << "PageArena::PageArena: mmap failed with errno " << errno
+               << ". Falling back to the heap";
+    allocation_ = Allocation::HEAP;
+    data_ = static_cast<char*>(
+        CHECK_NOTNULL(std::aligned_alloc(PAGE_SIZE, size_)));
+    memset(data_, 0, size_);
+}
+
+PageArena::~PageArena() {
+    if (allocation_ == Allocation::HEAP) {
+        std::free(data_);
+    } else {
+        munmap(data_, size_);
+    }
+}
+
+}  // namespace graphchaindb
@@ -0,0 +1,54 @@
+#ifndef STORAGE_PAGE_ARENA_H
+#define STORAGE_PAGE_ARENA_H
+
+#include <cstddef>
+
+#include "src/common/config.h"
+
+namespace graphchaindb {
+
+// PageArena is a single contiguous block of memory holding the data of the
+// pages of the buffer pool.
+//
+// The data of every page is PAGE_SIZE aligned and the pages are laid out
+// back to back, away from the page metadata, so that scanning the data of a
+// page only touches its own cache lines. The block is backed by huge pages
+// when possible to reduce the TLB misses of random page accesses. It is
+// mapped with MAP_HUGETLB if it spans at least one huge page, otherwise or if
+// no huge pages are reserved it is mapped normally and transparent huge pages
+// are requested with MADV_HUGEPAGE. It falls back to an aligned heap
+// allocation if mmap fails.
+//
+// The memory of the pages is zeroed.
+class PageArena {
+   public:
+    explicit PageArena(int num_pages);
+
+    PageArena(const PageArena&) = delete;
+    PageArena& operator=(const PageArena&) = delete;
+
+    ~PageArena();
+
+    // Get the data of the page with the given index
+    inline char* GetPageData(int index) {
+        return data_ + static_cast<size_t>(index) * PAGE_SIZE;
+    }
+
+    // Get the number of pages in the arena
+    inline int GetNumPages() { return num_pages_; }
+
+    // Returns if the arena is mapped with MAP_HUGETLB
+    inline bool IsHugeTLB() { return allocation_ == Allocation::HUGETLB; }
+
+   private:
+    enum class Allocation { HUGETLB, MMAP, HEAP };
+
+    int num_pages_;
+    size_t size_;  // size of the allocation in Bytes
+    Allocation allocation_;
+    char* data_;
+};
+
+}  // namespace graphchaindb
+
+#endif  // STORAGE_PAGE_ARENA_H
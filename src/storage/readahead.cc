@@ -0,0 +1,196 @@
+#include "readahead.h"
+
+#include <glog/logging.h>
+
+#include <algorithm>
+
+#include "bplus_tree_page_leaf.h"
+#include "buffer_manager.h"
+
+namespace graphchaindb {
+
+Readahead::Readahead(BufferManager* buffer_manager)
+    : buffer_manager_{CHECK_NOTNULL(buffer_manager)} {}
+
+Readahead::~Readahead() { Stop(); }
+
+void Readahead::Start() {
+    std::unique_lock l(mu_);
+    if (running_) {
+        return;
+    }
+
+    running_ = true;
+    worker_ = std::thread(&Readahead::WorkerRoutine, this);
+}
+
+void Readahead::Stop() {
+    {
+        std::unique_lock l(mu_);
+        if (!running_) {
+            return;
+        }
+
+        running_ = false;
+        requests_.clear();
+    }
+
+    requests_cv_.notify_all();
+    worker_.join();
+
+    std::unique_lock l(mu_);
+    idle_cv_.notify_all();
+}
+
+void Readahead::RecordLeafAccess(page_id_t page_id, page_id_t next_page_id,
+                                 bool sequential_hint) {
+    std::unique_lock l(mu_);
+    if (!running_) {
+        return;
+    }
+
+    clock_++;
+
+    Stream* stream = nullptr;
+    for (auto& candidate : streams_) {
+        if (candidate.expected_page_id == page_id) {
+            stream = &candidate;
+            break;
+        }
+    }
+
+    if (stream != nullptr) {
+        // the scan consumed one of the leaves read ahead of it. Grow the
+        // window since the access pattern is confirmed again.
+        stream->ahead = std::max(0, stream->ahead - 1);
+        if (stream->sequential) {
+            stream->window =
+                std::min(2 * stream->window, READAHEAD_MAX_WINDOW);
+        }
+        stream->sequential = true;
+    } else {
+        if (static_cast<int>(streams_.size()) < READAHEAD_MAX_STREAMS) {
+            streams_.emplace_back();
+            stream = &streams_.back();
+        } else {
+            stream = &*std::min_element(
+                streams_.begin(), streams_.end(),
+                [](const Stream& a, const Stream& b) {
+                    return a.last_used < b.last_used;
+                });
+        }
+
+        stream->ahead = 0;
+        stream->window = READAHEAD_INITIAL_WINDOW;
+        stream->sequential = sequential_hint;
+    }
+
+    stream->expected_page_id = next_page_id;
+    stream->last_used = clock_;
+
+    // the scan has caught up with the leaves which were read ahead.
+    if (stream->ahead == 0) {
+        stream->frontier_page_id = page_id;
+    }
+
+    if (!stream->sequential || next_page_id == INVALID_PAGE_ID ||
+        stream->ahead > stream->window / 2) {
+        return;
+    }
+
+    VLOG(VERBOSE_CHEAP) << "Readahead::RecordLeafAccess: prefetching "
+                        << stream->window - stream->ahead
+                        << " leaves after page id "
+                        << stream->frontier_page_id;
+
+    requests_.push_back(
+        {stream->frontier_page_id, stream->window - stream->ahead});
+    stream->ahead = stream->window;
+    requests_cv_.notify_one();
+}
+
+void Readahead::WaitUntilIdle() {
+    std::unique_lock l(mu_);
+    idle_cv_.wait(
+        l, [this] { return !running_ || (!busy_ && requests_.empty()); });
+}
+
+int64_t Readahead::GetPrefetchedPageCount() {
+    std::unique_lock l(mu_);
+    return prefetched_page_count_;
+}
+
+void Readahead::WorkerRoutine() {
+    std::unique_lock l(mu_);
+    while (true) {
+        requests_cv_.wait(
+            l, [this] { return !running_ || !requests_.empty(); });
+        if (!running_) {
+            return;
+        }
+
+        auto request = requests_.front();
+        requests_.pop_front();
+        busy_ = true;
+
+        l.unlock();
+        auto last_page_id = Prefetch(request);
+        l.lock();
+
+        // later requests of the same scan continue from the last leaf read.
+        for (auto& stream : streams_) {
+            if (stream.frontier_page_id == request.after_page_id) {
+                stream.frontier_page_id = last_page_id;
+            }
+        }
+
+        busy_ = false;
+        if (requests_.empty()) {
+            idle_cv_.notify_all();
+        }
+    }
+}
+
+page_id_t Readahead::Prefetch(const Request& request) {
+    page_id_t page_id = request.after_page_id;
+    page_id_t last_page_id = request.after_page_id;
+    bool read_next = false;
+
+    for (int i = 0; i <= request.count; i++) {
+        auto page_or_status = buffer_manager_->GetPageWithId(page_id);
+        if (!page_or_status.ok()) {
+            LOG(ERROR) << "Readahead::Prefetch: unable to read page "
+                       << page_id;
+            break;
+        }
+
+        auto page = page_or_status.value();
+        page->AquireReadLock();
+
+        // the chain could have changed since the request. Only follow leaves.
+        auto leaf_page = reinterpret_cast<BplusTreeLeafPage*>(page->GetData());
+        bool is_leaf = leaf_page->GetPageType() == PAGE_TYPE_BPLUS_LEAF;
+        page_id_t next_page_id =
+            is_leaf ? leaf_page->GetNextPageId() : INVALID_PAGE_ID;
+
+        page->ReleaseReadLock();
+        buffer_manager_->UnpinPage(page);
+
+        if (read_next) {
+            last_page_id = page_id;
+            std::unique_lock l(mu_);
+            prefetched_page_count_++;
+        }
+
+        if (next_page_id == INVALID_PAGE_ID) {
+            break;
+        }
+
+        page_id = next_page_id;
+        read_next = true;
+    }
+
+    return last_page_id;
+}
+
+}  // namespace graphchaindb
@@ -0,0 +1,96 @@
+#ifndef STORAGE_READAHEAD_H
+#define STORAGE_READAHEAD_H
+
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "src/common/config.h"
+
+namespace graphchaindb {
+
+class BufferManager;
+
+// Readahead prefetches the B+ tree leaves ahead of a scan of the leaf chain.
+//
+// Readers report every leaf they read together with the id of the next leaf.
+// A read of the leaf which was reported as the next one of a previous read
+// makes the access sequential. Once a scan is detected, or a reader hints
+// that it is scanning, the following leaves of the chain are read into the
+// buffer pool by a background worker, unpinned, before the scan reaches
+// them. The number of leaves kept ahead of the scan starts at
+// READAHEAD_INITIAL_WINDOW and doubles with every sequential read up to
+// READAHEAD_MAX_WINDOW.
+//
+// It is thread safe.
+class Readahead {
+   public:
+    explicit Readahead(BufferManager* buffer_manager);
+
+    Readahead(const Readahead&) = delete;
+    Readahead& operator=(const Readahead&) = delete;
+
+    // Stops the worker
+    ~Readahead();
+
+    // Start the background worker
+    void Start();
+
+    // Stop the background worker. Pending prefetches are dropped.
+    void Stop();
+
+    // Record that the leaf page_id, whose next leaf is next_page_id, was
+    // read. sequential_hint indicates that the reader is going to read the
+    // following leaves as well.
+    void RecordLeafAccess(page_id_t page_id, page_id_t next_page_id,
+                          bool sequential_hint = false);
+
+    // Block until all of the requested prefetches are done
+    void WaitUntilIdle();
+
+    // Get the number of leaves read by the worker so far
+    int64_t GetPrefetchedPageCount();
+
+   private:
+    // A scan of the leaf chain
+    struct Stream {
+        page_id_t expected_page_id;  // the leaf the scan reads next
+        page_id_t frontier_page_id;  // the last leaf requested for prefetch
+        int ahead;                   // leaves requested ahead of the scan
+        int window;                  // leaves to keep ahead of the scan
+        bool sequential;             // whether prefetching has started
+        int64_t last_used;           // for replacing the oldest stream
+    };
+
+    // Prefetch count leaves following the leaf after_page_id
+    struct Request {
+        page_id_t after_page_id;
+        int count;
+    };
+
+    // Loop of the background worker
+    void WorkerRoutine();
+
+    // Read the leaves of the request into the buffer pool. Returns the last
+    // leaf which was read.
+    page_id_t Prefetch(const Request& request);
+
+    BufferManager* buffer_manager_;
+
+    std::mutex mu_;  // protects all of the fields below
+    std::condition_variable requests_cv_;
+    std::condition_variable idle_cv_;
+    std::deque<Request> requests_;
+    std::vector<Stream> streams_;
+    bool running_{false};
+    bool busy_{false};
+    int64_t clock_{0};
+    int64_t prefetched_page_count_{0};
+    std::thread worker_;
+};
+
+}  // namespace graphchaindb
+
+#endif  // STORAGE_READAHEAD_H
@@ -39,6 +39,18 @@ absl::StatusOr<page_id_t> RecoveryManager::Recover(
                     break;
                 }
 
+                // a bulk load allocated the pages of the index it built
+                // without logging them
+                if (comp_->Compare(current_entry->GetKey(), BULK_LOAD_KEY) ==
+                    0) {
+                    std::string value(current_entry->GetValue().value());
+                    auto separator = value.find(' ');
+                    index_root_page_id =
+                        std::stoull(value.substr(0, separator));
+                    next_page_id = std::stoull(value.substr(separator + 1));
+                    break;
+                }
+
                 if (comp_->Compare(current_entry->GetKey(),
                                    INDEX_ROOT_PAGE_ID_KEY) == 0) {
                     auto value_str = current_entry->GetValue().value();
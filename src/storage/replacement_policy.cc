@@ -0,0 +1,24 @@
+#include "replacement_policy.h"
+
+#include <glog/logging.h>
+
+#include "clock_replacement_policy.h"
+#include "two_queue_replacement_policy.h"
+
+namespace graphchaindb {
+
+std::unique_ptr<ReplacementPolicy> NewReplacementPolicy(
+    ReplacementPolicyType type, int frame_count) {
+    switch (type) {
+        case REPLACEMENT_POLICY_CLOCK:
+            return std::make_unique<ClockReplacementPolicy>(frame_count);
+        case REPLACEMENT_POLICY_TWO_QUEUE:
+            return std::make_unique<TwoQueueReplacementPolicy>(frame_count);
+    }
+
+    LOG(FATAL) << "NewReplacementPolicy: unknown replacement policy type "
+               << type;
+    return nullptr;
+}
+
+}  // namespace graphchaindb
@@ -0,0 +1,58 @@
+#ifndef STORAGE_REPLACEMENT_POLICY_H
+#define STORAGE_REPLACEMENT_POLICY_H
+
+#include <memory>
+
+#include "absl/functional/function_ref.h"
+#include "absl/status/statusor.h"
+#include "option.h"
+#include "src/common/config.h"
+
+namespace graphchaindb {
+
+// An interface for the page replacement policy of a buffer pool partition.
+//
+// Frames are identified by their index in the partition. The buffer manager
+// reports which page a frame holds and every access to it. The policy picks
+// the frame to evict when the partition is full.
+//
+// Not thread safe. Calls are serialized by the partition lock.
+class ReplacementPolicy {
+   public:
+    ReplacementPolicy() = default;
+
+    ReplacementPolicy(const ReplacementPolicy&) = delete;
+    ReplacementPolicy& operator=(const ReplacementPolicy&) = delete;
+
+    virtual ~ReplacementPolicy() = default;
+
+    // The frame now holds the given page. Called after a miss or an
+    // allocation, before the page is handed out.
+    virtual void RecordInsert(int frame_index, page_id_t page_id) = 0;
+
+    // The frame chosen by Evict keeps its page after all, because the page
+    // couldn't be written back. The frame is tracked again as it was before
+    // the eviction, without counting as a new access.
+    virtual void RestoreEvicted(int frame_index, page_id_t page_id) = 0;
+
+    // The page in the frame is accessed (pinned) again.
+    virtual void RecordAccess(int frame_index) = 0;
+
+    // The frame doesn't hold a page anymore without being evicted.
+    virtual void Remove(int frame_index) = 0;
+
+    // Choose a frame to evict among the frames for which is_evictable returns
+    // true and stop tracking it.
+    //
+    // Returns ResourceExhaustedError if no frame can be evicted.
+    virtual absl::StatusOr<int> Evict(
+        absl::FunctionRef<bool(int)> is_evictable) = 0;
+};
+
+// Create the replacement policy of the given type for frame_count frames
+std::unique_ptr<ReplacementPolicy> NewReplacementPolicy(
+    ReplacementPolicyType type, int frame_count);
+
+}  // namespace graphchaindb
+
+#endif  // STORAGE_REPLACEMENT_POLICY_H
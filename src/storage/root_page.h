@@ -11,9 +11,11 @@ namespace graphchaindb {
 //
 // Format (size in bytes):
 //
-// ---------------------------------------------------
-// | PageType (4) | PageId (4) | IndexRootPageId (4) |
-// ---------------------------------------------------
+// -----------------------------------------------------------------------
+// | PageType (4) | PageId (4) | IndexRootPageId (4) | Padding (4) |
+// -----------------------------------------------------------------------
+// | LastFlushedLogNumber (8) | FormatVersion (4) |
+// ------------------------------------------------
 //
 class RootPage {
    public:
@@ -28,12 +30,16 @@ class RootPage {
 
     page_id_t GetPageId() { return page_id_; }
 
+    // Get the format of the db file, see DB_FORMAT_VERSION
+    uint32_t GetFormatVersion() { return format_version_; }
+
    private:
     PageType page_type_{PAGE_TYPE_ROOT};
     page_id_t page_id_{ROOT_PAGE_ID};
     page_id_t index_root_page_id_{
         INVALID_PAGE_ID};  // root page of the bplus tree index.
     ln_t last_flushed_log_number_{INVALID_LOG_NUMBER};
+    uint32_t format_version_{DB_FORMAT_VERSION};
 };
 
 }  // namespace graphchaindb
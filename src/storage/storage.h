@@ -5,6 +5,7 @@
 #include <cstdio>
 #include <string>
 
+#include "absl/functional/function_ref.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/string_view.h"
@@ -41,6 +42,36 @@ class Storage {
     // Gets the latest value corresponding to the given key.
     virtual absl::StatusOr<std::string> Get(const ReadOptions& options,
                                             absl::string_view key) = 0;
+
+    // Loads the key value pairs of a sorted stream into the empty storage.
+    // next sets the next pair and returns true, or returns false at the end
+    // of the stream. The keys MUST be sorted and unique.
+    //
+    // Much faster than setting the pairs one by one: the index is built
+    // bottom up and only a single log entry is written for the whole load.
+    // MUST NOT run concurrently with other writes.
+    //
+    // Returns FailedPreconditionError if the storage isn't empty and
+    // InvalidArgumentError if the keys aren't sorted.
+    virtual absl::Status BulkLoad(
+        const BulkLoadOptions& options,
+        absl::FunctionRef<absl::StatusOr<bool>(std::string* key,
+                                               std::string* value)>
+            next) = 0;
+
+    // Gets the value of the given property of the storage. Valid properties:
+    //
+    //  "graphchaindb.buffer-stats" - a table of the buffer pool counters per
+    //      page type
+    //  "graphchaindb.buffer-stats.<page type>.<counter>" - a single counter,
+    //      e.g. "graphchaindb.buffer-stats.leaf.miss"
+    //  "graphchaindb.buffer-hit-ratio[.<page type>]" - the ratio of the
+    //      buffer pool requests which were hits, for all or a type of pages
+    //  "graphchaindb.dirty-pages" - the number of dirty pages in the pool
+    //
+    // Returns NotFoundError for an unknown property.
+    virtual absl::StatusOr<std::string> GetProperty(
+        absl::string_view property) = 0;
 };
 
 }  // namespace graphchaindb
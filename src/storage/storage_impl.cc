@@ -2,6 +2,9 @@
 
 #include <glog/logging.h>
 
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_format.h"
+#include "absl/strings/strip.h"
 #include "src/storage/log_entry.h"
 
 namespace graphchaindb {
@@ -9,8 +12,9 @@ namespace graphchaindb {
 StorageImpl::StorageImpl(const Options& options, absl::string_view db_path)
     : disk_manager_(new DiskManager(db_path)),
       log_manager_(new LogManager(disk_manager_)),
-      buffer_manager_(new BufferManager(disk_manager_, log_manager_)),
-      index_(new BplusTreeIndex(buffer_manager_, disk_manager_, log_manager_)),
+      buffer_manager_(new BufferManager(disk_manager_, log_manager_, options)),
+      index_(new BplusTreeIndex(buffer_manager_, disk_manager_, log_manager_,
+                                options)),
       recovery_manager_(new RecoveryManager(log_manager_, index_)) {}
 
 StorageImpl::~StorageImpl() {
@@ -84,6 +88,60 @@ absl::StatusOr<std::string> StorageImpl::Get(const ReadOptions& options,
     return index_->Get(options, key);
 }
 
+absl::Status StorageImpl::BulkLoad(
+    const BulkLoadOptions& options,
+    absl::FunctionRef<absl::StatusOr<bool>(std::string* key,
+                                           std::string* value)>
+        next) {
+    LOG(INFO) << "StorageImpl::BulkLoad: Start";
+
+    // the index writes the single log entry of the load itself
+    auto s = index_->BulkLoad(options, next);
+    if (!s.ok()) {
+        LOG(ERROR) << "StorageImpl::BulkLoad: error in bulk load operation";
+    }
+    return s;
+}
+
+absl::StatusOr<std::string> StorageImpl::GetProperty(
+    absl::string_view property) {
+    static constexpr absl::string_view kPrefix = "graphchaindb.";
+    if (!absl::ConsumePrefix(&property, kPrefix)) {
+        return absl::NotFoundError("unknown property");
+    }
+
+    if (property == "dirty-pages") {
+        return absl::StrCat(buffer_manager_->GetDirtyPageCount());
+    }
+
+    auto stats = buffer_manager_->GetStats();
+    if (property == "buffer-stats") {
+        return stats.ToString();
+    }
+    if (property == "buffer-hit-ratio") {
+        return absl::StrFormat("%.4f", stats.GetTotalHitRatio());
+    }
+
+    for (int t = 0; t < PAGE_TYPE_COUNT; t++) {
+        auto page_type = static_cast<PageType>(t);
+        if (property ==
+            absl::StrCat("buffer-hit-ratio.", PageTypeName(page_type))) {
+            return absl::StrFormat("%.4f", stats.GetHitRatio(page_type));
+        }
+
+        for (int k = 0; k < BUFFER_TICKER_COUNT; k++) {
+            auto ticker = static_cast<BufferTicker>(k);
+            if (property == absl::StrCat("buffer-stats.",
+                                         PageTypeName(page_type), ".",
+                                         BufferTickerName(ticker))) {
+                return absl::StrCat(stats.Get(page_type, ticker));
+            }
+        }
+    }
+
+    return absl::NotFoundError("unknown property");
+}
+
 absl::Status StorageImpl::Recover(const Options& options) {
     LOG(INFO) << "StorageImpl::Recover: Start";
 
@@ -99,6 +157,10 @@ absl::Status StorageImpl::Recover(const Options& options) {
             LOG(ERROR) << "StorageImpl::Recover: database files already exist";
             return absl::AlreadyExistsError("Database files already exist");
         }
+    } else if (absl::IsFailedPrecondition(s.status())) {
+        // recreating the files would drop the data of the existing database
+        LOG(ERROR) << "StorageImpl::Recover: unable to load the database";
+        return s.status();
     } else {
         // TODO: consider checking if the error is not found error
         if (options.create_if_not_exists) {
@@ -135,6 +197,13 @@ absl::Status StorageImpl::Recover(const Options& options) {
 
     index_->Init(bplus_tree_index_root_page_id);
 
+    // a cold pool only makes the first requests slower
+    auto warmup_status = buffer_manager_->StartWarmup();
+    if (!warmup_status.ok() && !absl::IsNotFound(warmup_status)) {
+        LOG(ERROR) << "StorageImpl::Recover: error while starting the "
+                      "buffer pool warm-up";
+    }
+
     return s.status();
 }
 
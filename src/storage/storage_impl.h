@@ -46,6 +46,17 @@ class StorageImpl : public Storage {
     absl::Status Delete(const WriteOptions& options,
                         absl::string_view key) override;
 
+    // Loads the key value pairs of a sorted stream into the empty storage.
+    absl::Status BulkLoad(
+        const BulkLoadOptions& options,
+        absl::FunctionRef<absl::StatusOr<bool>(std::string* key,
+                                               std::string* value)>
+            next) override;
+
+    // Gets the value of the given property of the storage.
+    absl::StatusOr<std::string> GetProperty(
+        absl::string_view property) override;
+
     // Run recovery procedure.
     // Also handles create_if_not_exists and error_if_exists from options.
     absl::Status Recover(const Options& options);
@@ -36,9 +36,12 @@ std::string StringContainer::GetStringData(BufferManager* buffer_manager) {
     LOG(INFO) << "StringContainer::GetStringData: overflown data: "
               << overflown_data << " size: " << overflown_data.length();
 
+    auto result = std::string(inline_data.begin(), 52) +
+                  std::string(overflown_data.begin(), overflown_data.size());
+
+    buffer_manager->UnpinPage(overflow_page_container);
     overflow_page_container->ReleaseReadLock();
-    return std::string(inline_data.begin(), 52) +
-           std::string(overflown_data.begin(), overflown_data.size());
+    return result;
 }
 
 void StringContainer::SetStringData(BufferManager* buffer_manager,
@@ -50,10 +53,10 @@ void StringContainer::SetStringData(BufferManager* buffer_manager,
         memcpy(data_ + sizeof(int32_t), value.begin(), value.length());
     } else {
         memcpy(data_ + sizeof(int32_t), value.begin(), 52);
+        // returned exclusively latched with the space reserved for us
         auto overflow_page_container =
             buffer_manager->GetOverflowPageWithCapacity(value.length() - 52)
                 .value();
-        overflow_page_container->AquireExclusiveLock();
 
         // set overflow page id
         auto page_id = overflow_page_container->GetPageId();
@@ -26,7 +26,9 @@ class BufferManager;
 // | Length (4) | data (52) | Overflow page id (4) | Offset overflow page (4) |
 // ----------------------------------------------------------------------------
 //
-class StringContainer {
+// The lengths and ids are read in place, so a container MUST be aligned to
+// them. Copy it out of a place which isn't.
+class alignas(int32_t) StringContainer {
    public:
     StringContainer() = default;
 
@@ -42,12 +44,30 @@ class StringContainer {
     // Get the string data stored in the container
     std::string GetStringData(BufferManager* buffer_manager);
 
+    // Get the string data if it is stored entirely in the container. Returns
+    // false if a part of it is in an overflow page or the length is invalid.
+    //
+    // Never follows the overflow page, so it is safe to call while reading a
+    // page optimistically.
+    inline bool GetInlineStringData(absl::string_view* value) {
+        auto len = GetStringLength();
+        if (len < 0 || len > MAX_INLINE_LENGTH) {
+            return false;
+        }
+
+        *value = absl::string_view(data_ + sizeof(int32_t), len);
+        return true;
+    }
+
     // Set the string data stored in the container
     void SetStringData(BufferManager* buffer_manager, absl::string_view value);
 
     inline void EraseStringData() { memset(data_, 0, sizeof(int32_t)); }
 
    private:
+    // the longest string which is stored in the container alone
+    static constexpr int MAX_INLINE_LENGTH =
+        STRING_CONTAINER_SIZE - sizeof(int32_t);
     static constexpr int OVERFLOW_PAGE_ID_SLOT = 56;
     static constexpr int OVERFLOW_PAGE_OFFSET = 60;
 
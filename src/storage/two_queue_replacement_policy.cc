@@ -0,0 +1,148 @@
+#include "two_queue_replacement_policy.h"
+
+#include <glog/logging.h>
+
+#include <algorithm>
+
+namespace graphchaindb {
+
+// The sizes recommended by the paper: Kin is 25% of the frames and Kout
+// remembers as many pages as 50% of the frames hold.
+TwoQueueReplacementPolicy::TwoQueueReplacementPolicy(int frame_count)
+    : a1in_max_size_{std::max(1, frame_count / 4)},
+      a1out_max_size_{std::max(1, frame_count / 2)},
+      queue_of_frame_(frame_count, QUEUE_NONE),
+      evicted_from_(frame_count, QUEUE_NONE),
+      position_of_frame_(frame_count),
+      page_of_frame_(frame_count, INVALID_PAGE_ID) {
+    CHECK_GT(frame_count, 0);
+}
+
+void TwoQueueReplacementPolicy::RecordInsert(int frame_index,
+                                             page_id_t page_id) {
+    Unlink(frame_index);
+    page_of_frame_[frame_index] = page_id;
+
+    auto ghost_itr = a1out_index_.find(page_id);
+    if (ghost_itr != a1out_index_.end()) {
+        a1out_.erase(ghost_itr->second);
+        a1out_index_.erase(ghost_itr);
+
+        queue_of_frame_[frame_index] = QUEUE_AM;
+        position_of_frame_[frame_index] = am_.insert(am_.end(), frame_index);
+        return;
+    }
+
+    queue_of_frame_[frame_index] = QUEUE_A1IN;
+    position_of_frame_[frame_index] = a1in_.insert(a1in_.end(), frame_index);
+}
+
+void TwoQueueReplacementPolicy::RestoreEvicted(int frame_index,
+                                               page_id_t page_id) {
+    Unlink(frame_index);
+    page_of_frame_[frame_index] = page_id;
+
+    // a page evicted from A1in was remembered in A1out, which would make it
+    // hot the next time it is inserted. It goes back to the front of its
+    // queue, where it was picked from.
+    auto queue = evicted_from_[frame_index];
+    if (queue == QUEUE_A1IN) {
+        auto ghost_itr = a1out_index_.find(page_id);
+        if (ghost_itr != a1out_index_.end()) {
+            a1out_.erase(ghost_itr->second);
+            a1out_index_.erase(ghost_itr);
+        }
+    }
+
+    auto& list = queue == QUEUE_AM ? am_ : a1in_;
+    queue_of_frame_[frame_index] = queue == QUEUE_AM ? QUEUE_AM : QUEUE_A1IN;
+    position_of_frame_[frame_index] = list.insert(list.begin(), frame_index);
+}
+
+void TwoQueueReplacementPolicy::RecordAccess(int frame_index) {
+    // accesses to a page in A1in are correlated with its first one and don't
+    // make it hot.
+    if (queue_of_frame_[frame_index] == QUEUE_AM) {
+        am_.splice(am_.end(), am_, position_of_frame_[frame_index]);
+    }
+}
+
+void TwoQueueReplacementPolicy::Remove(int frame_index) {
+    Unlink(frame_index);
+    page_of_frame_[frame_index] = INVALID_PAGE_ID;
+}
+
+absl::StatusOr<int> TwoQueueReplacementPolicy::Evict(
+    absl::FunctionRef<bool(int)> is_evictable) {
+    int frame_index = -1;
+    if (static_cast<int>(a1in_.size()) > a1in_max_size_ || am_.empty()) {
+        frame_index = EvictFrom(a1in_, is_evictable);
+        if (frame_index != -1) {
+            RememberEvicted(page_of_frame_[frame_index]);
+        }
+    }
+
+    if (frame_index == -1) {
+        frame_index = EvictFrom(am_, is_evictable);
+    }
+
+    // everything in Am is pinned, fall back to A1in even below its share.
+    if (frame_index == -1) {
+        frame_index = EvictFrom(a1in_, is_evictable);
+        if (frame_index != -1) {
+            RememberEvicted(page_of_frame_[frame_index]);
+        }
+    }
+
+    if (frame_index == -1) {
+        return absl::ResourceExhaustedError(
+            "TwoQueueReplacementPolicy::Evict: all of the frames are in use");
+    }
+
+    page_of_frame_[frame_index] = INVALID_PAGE_ID;
+    return frame_index;
+}
+
+void TwoQueueReplacementPolicy::Unlink(int frame_index) {
+    switch (queue_of_frame_[frame_index]) {
+        case QUEUE_A1IN:
+            a1in_.erase(position_of_frame_[frame_index]);
+            break;
+        case QUEUE_AM:
+            am_.erase(position_of_frame_[frame_index]);
+            break;
+        case QUEUE_NONE:
+            break;
+    }
+
+    queue_of_frame_[frame_index] = QUEUE_NONE;
+}
+
+int TwoQueueReplacementPolicy::EvictFrom(
+    std::list<int>& queue, absl::FunctionRef<bool(int)> is_evictable) {
+    for (auto itr = queue.begin(); itr != queue.end(); itr++) {
+        int frame_index = *itr;
+        if (is_evictable(frame_index)) {
+            queue.erase(itr);
+            evicted_from_[frame_index] = queue_of_frame_[frame_index];
+            queue_of_frame_[frame_index] = QUEUE_NONE;
+            return frame_index;
+        }
+    }
+
+    return -1;
+}
+
+void TwoQueueReplacementPolicy::RememberEvicted(page_id_t page_id) {
+    if (page_id == INVALID_PAGE_ID || a1out_index_.count(page_id) > 0) {
+        return;
+    }
+
+    a1out_index_[page_id] = a1out_.insert(a1out_.end(), page_id);
+    if (static_cast<int>(a1out_.size()) > a1out_max_size_) {
+        a1out_index_.erase(a1out_.front());
+        a1out_.pop_front();
+    }
+}
+
+}  // namespace graphchaindb
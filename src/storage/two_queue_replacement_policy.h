@@ -0,0 +1,77 @@
+#ifndef STORAGE_TWO_QUEUE_REPLACEMENT_POLICY_H
+#define STORAGE_TWO_QUEUE_REPLACEMENT_POLICY_H
+
+#include <list>
+#include <unordered_map>
+#include <vector>
+
+#include "replacement_policy.h"
+
+namespace graphchaindb {
+
+// 2Q replacement policy (Johnson and Shasha, VLDB '94).
+//
+// A page read for the first time enters the A1in FIFO queue and repeated
+// accesses while it is there don't promote it. When it is evicted from A1in
+// its page id is remembered in the A1out ghost queue. A page which is read
+// again while its id is in A1out is hot and enters the Am LRU queue. Frames
+// are evicted from A1in while it holds more than its share of the frames and
+// from the LRU end of Am otherwise.
+//
+// A scan touches every page once, so it only cycles through A1in and never
+// displaces the pages in Am.
+//
+// Not thread safe.
+class TwoQueueReplacementPolicy : public ReplacementPolicy {
+   public:
+    explicit TwoQueueReplacementPolicy(int frame_count);
+
+    TwoQueueReplacementPolicy(const TwoQueueReplacementPolicy&) = delete;
+    TwoQueueReplacementPolicy& operator=(const TwoQueueReplacementPolicy&) =
+        delete;
+
+    ~TwoQueueReplacementPolicy() override = default;
+
+    void RecordInsert(int frame_index, page_id_t page_id) override;
+
+    void RestoreEvicted(int frame_index, page_id_t page_id) override;
+
+    void RecordAccess(int frame_index) override;
+
+    void Remove(int frame_index) override;
+
+    absl::StatusOr<int> Evict(
+        absl::FunctionRef<bool(int)> is_evictable) override;
+
+   private:
+    enum Queue { QUEUE_NONE, QUEUE_A1IN, QUEUE_AM };
+
+    // Remove the frame from the queue it is in
+    void Unlink(int frame_index);
+
+    // Evict the oldest evictable frame of the queue. Returns -1 if there is
+    // none.
+    int EvictFrom(std::list<int>& queue,
+                  absl::FunctionRef<bool(int)> is_evictable);
+
+    // Remember the page id of a frame evicted from A1in
+    void RememberEvicted(page_id_t page_id);
+
+    int a1in_max_size_;   // Kin. A1in is preferred for eviction above it.
+    int a1out_max_size_;  // Kout. Number of remembered page ids.
+
+    std::list<int> a1in_;  // front is the oldest
+    std::list<int> am_;    // front is the least recently used
+    std::list<page_id_t> a1out_;  // front is the oldest
+    std::unordered_map<page_id_t, std::list<page_id_t>::iterator>
+        a1out_index_;
+
+    std::vector<Queue> queue_of_frame_;
+    std::vector<Queue> evicted_from_;  // queue of the frame before Evict
+    std::vector<std::list<int>::iterator> position_of_frame_;
+    std::vector<page_id_t> page_of_frame_;
+};
+
+}  // namespace graphchaindb
+
+#endif  // STORAGE_TWO_QUEUE_REPLACEMENT_POLICY_H
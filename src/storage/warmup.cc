@@ -0,0 +1,136 @@
+#include "warmup.h"
+
+#include <glog/logging.h>
+
+#include <algorithm>
+#include <chrono>
+
+#include "buffer_manager.h"
+#include "disk_manager.h"
+
+namespace graphchaindb {
+
+Warmup::Warmup(BufferManager* buffer_manager, DiskManager* disk_manager)
+    : buffer_manager_{CHECK_NOTNULL(buffer_manager)},
+      disk_manager_{CHECK_NOTNULL(disk_manager)} {}
+
+Warmup::~Warmup() { Stop(); }
+
+void Warmup::Start() {
+    std::unique_lock l(mu_);
+    if (running_) {
+        return;
+    }
+
+    running_ = true;
+    worker_ = std::thread(&Warmup::WorkerRoutine, this);
+}
+
+void Warmup::Stop() {
+    stop_prefetch_ = true;
+    WaitForPrefetch();
+
+    {
+        std::unique_lock l(mu_);
+        if (!running_) {
+            return;
+        }
+
+        running_ = false;
+    }
+
+    stop_cv_.notify_all();
+    worker_.join();
+
+    auto s = Save();
+    if (!s.ok()) {
+        LOG(ERROR) << "Warmup::Stop: error while saving the resident pages";
+    }
+}
+
+absl::Status Warmup::Save() {
+    return disk_manager_->WriteWarmupFile(buffer_manager_->GetResidentPages());
+}
+
+absl::Status Warmup::StartPrefetch() {
+    LOG(INFO) << "Warmup::StartPrefetch: Start";
+
+    auto page_ids_or_status = disk_manager_->ReadWarmupFile();
+    if (!page_ids_or_status.ok()) {
+        return page_ids_or_status.status();
+    }
+
+    // only the hottest pages fit in the pool
+    auto page_ids = std::move(page_ids_or_status.value());
+    if (page_ids.size() > PAGE_BUFFER_SIZE) {
+        page_ids.resize(PAGE_BUFFER_SIZE);
+    }
+    std::sort(page_ids.begin(), page_ids.end());
+
+    WaitForPrefetch();
+    std::unique_lock l(mu_);
+    prefetch_page_ids_ = std::move(page_ids);
+    next_prefetch_index_ = 0;
+    stop_prefetch_ = false;
+    for (int i = 0; i < WARMUP_PREFETCH_THREADS; i++) {
+        prefetch_threads_.emplace_back(&Warmup::PrefetchRoutine, this);
+    }
+
+    return absl::OkStatus();
+}
+
+void Warmup::WaitForPrefetch() {
+    std::vector<std::thread> threads;
+    {
+        std::unique_lock l(mu_);
+        threads.swap(prefetch_threads_);
+    }
+
+    for (auto& thread : threads) {
+        thread.join();
+    }
+}
+
+void Warmup::WorkerRoutine() {
+    std::unique_lock l(mu_);
+    while (running_) {
+        stop_cv_.wait_for(
+            l, std::chrono::milliseconds(WARMUP_SAVE_INTERVAL_MILLISECONDS),
+            [this] { return !running_; });
+        if (!running_) {
+            break;
+        }
+
+        l.unlock();
+        auto s = Save();
+        if (!s.ok()) {
+            LOG(ERROR) << "Warmup::WorkerRoutine: error while saving the "
+                          "resident pages";
+        }
+        l.lock();
+    }
+}
+
+void Warmup::PrefetchRoutine() {
+    while (!stop_prefetch_) {
+        int index = next_prefetch_index_++;
+        if (index >= static_cast<int>(prefetch_page_ids_.size())) {
+            return;
+        }
+
+        auto page_id = prefetch_page_ids_[index];
+        auto read_or_status = buffer_manager_->PrefetchPage(page_id);
+        if (!read_or_status.ok()) {
+            LOG(ERROR) << "Warmup::PrefetchRoutine: error while reading the "
+                          "page "
+                       << page_id;
+            continue;
+        }
+
+        if (read_or_status.value()) {
+            prefetched_page_count_++;
+        }
+    }
+}
+
+}  // namespace graphchaindb
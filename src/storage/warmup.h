@@ -0,0 +1,88 @@
+#ifndef STORAGE_WARMUP_H
+#define STORAGE_WARMUP_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "absl/status/status.h"
+#include "src/common/config.h"
+
+namespace graphchaindb {
+
+class BufferManager;
+class DiskManager;
+
+// Warmup keeps the buffer pool warm across restarts.
+//
+// A background worker saves the ids of the pages resident in the buffer
+// pool, hottest first, to the warm-up file of the database every
+// WARMUP_SAVE_INTERVAL_MILLISECONDS and once more when it stops.
+//
+// After a restart the hottest pages which fit in the pool are read back in
+// the background by WARMUP_PREFETCH_THREADS threads while requests are
+// served. They are read in page id order to keep the disk access mostly
+// sequential. Prefetching only fills free frames, so it never evicts a page
+// which was requested in the meantime.
+//
+// It is thread safe.
+class Warmup {
+   public:
+    Warmup(BufferManager* buffer_manager, DiskManager* disk_manager);
+
+    Warmup(const Warmup&) = delete;
+    Warmup& operator=(const Warmup&) = delete;
+
+    // Stops the worker and the prefetch
+    ~Warmup();
+
+    // Start the background worker saving the resident pages
+    void Start();
+
+    // Stop the prefetch and the background worker. The resident pages are
+    // saved a last time if the worker was running.
+    void Stop();
+
+    // Save the resident pages now
+    absl::Status Save();
+
+    // Start reading the pages of the warm-up file in the background.
+    //
+    // Returns NotFoundError if there is no warm-up file
+    absl::Status StartPrefetch();
+
+    // Block until the prefetch started by StartPrefetch is done
+    void WaitForPrefetch();
+
+    // Get the number of pages read by the prefetch so far
+    int64_t GetPrefetchedPageCount() { return prefetched_page_count_; }
+
+   private:
+    // Loop of the background worker
+    void WorkerRoutine();
+
+    // Loop of a prefetch thread. The threads take the pages in order.
+    void PrefetchRoutine();
+
+    BufferManager* buffer_manager_;
+    DiskManager* disk_manager_;
+
+    std::mutex mu_;  // protects running_ and the threads
+    std::condition_variable stop_cv_;
+    bool running_{false};
+    std::thread worker_;
+    std::vector<std::thread> prefetch_threads_;
+
+    std::vector<page_id_t> prefetch_page_ids_;  // written before the prefetch
+                                                // threads start
+    std::atomic<int> next_prefetch_index_{0};
+    std::atomic<bool> stop_prefetch_{false};
+    std::atomic<int64_t> prefetched_page_count_{0};
+};
+
+}  // namespace graphchaindb
+
+#endif  // STORAGE_WARMUP_H
@@ -0,0 +1,115 @@
+#include "src/storage/background_writer.h"
+
+#include <glog/logging.h>
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <filesystem>
+#include <memory>
+#include <thread>
+
+#include "src/common/config.h"
+#include "src/common/test_utils.h"
+#include "src/storage/buffer_manager.h"
+#include "src/storage/disk_manager.h"
+#include "src/storage/log_manager.h"
+
+namespace graphchaindb {
+
+class BackgroundWriterTest : public ::testing::Test {
+   protected:
+    BackgroundWriterTest() {
+        std::filesystem::remove(
+            std::string{TEST_DB_PATH.data(), TEST_DB_PATH.size()} + ".db");
+        std::filesystem::remove(
+            std::string{TEST_DB_PATH.data(), TEST_DB_PATH.size()} + ".log");
+        disk_manager = std::make_unique<DiskManager>(TEST_DB_PATH);
+        log_manager = std::make_unique<LogManager>(disk_manager.get());
+        buffer_manager = std::make_unique<BufferManager>(disk_manager.get(),
+                                                         log_manager.get());
+        background_writer = std::make_unique<BackgroundWriter>(
+            buffer_manager.get(), log_manager.get());
+    }
+
+    // Doesn't init the buffer manager, so that its own background writer
+    // doesn't run.
+    absl::Status Init() {
+        auto s = disk_manager->CreateDBFilesAndLoadDB();
+        if (!s.ok()) {
+            return s.status();
+        }
+
+        log_manager->SetNextLogNumber(STARTING_LOG_NUMBER);
+        return absl::OkStatus();
+    }
+
+    // Allocate count pages and unpin them dirty
+    void DirtyPages(int count) {
+        for (int i = 0; i < count; i++) {
+            auto page_status = buffer_manager->AllocateNewPage();
+            EXPECT_TRUE(page_status.ok());
+            buffer_manager->UnpinPage(page_status.value(), true);
+        }
+    }
+
+    // Wait until there are at most count dirty pages. Returns if it happened
+    // in time.
+    bool WaitForDirtyPageCount(int count) {
+        for (int i = 0; i < 100; i++) {
+            if (buffer_manager->GetDirtyPageCount() <= count) {
+                return true;
+            }
+
+            std::this_thread::sleep_for(std::chrono::milliseconds(
+                FLUSH_MIN_WAIT_INTERVAL_MILLISECONDS));
+        }
+
+        return false;
+    }
+
+    std::unique_ptr<DiskManager> disk_manager;
+    std::unique_ptr<LogManager> log_manager;
+    std::unique_ptr<BufferManager> buffer_manager;
+    std::unique_ptr<BackgroundWriter> background_writer;
+};
+
+TEST_F(BackgroundWriterTest, WritesDownToLowWatermark) {
+    EXPECT_TRUE(Init().ok());
+    auto low_watermark = PAGE_BUFFER_SIZE * FLUSH_LOW_WATERMARK_PERCENT / 100;
+
+    DirtyPages(PAGE_BUFFER_SIZE);
+    EXPECT_EQ(buffer_manager->GetDirtyPageCount(), PAGE_BUFFER_SIZE);
+
+    background_writer->Start();
+    EXPECT_TRUE(WaitForDirtyPageCount(low_watermark));
+    EXPECT_EQ(buffer_manager->GetDirtyPageCount(), low_watermark);
+}
+
+TEST_F(BackgroundWriterTest, WritesPagesDirtyForTooLong) {
+    EXPECT_TRUE(Init().ok());
+
+    DirtyPages(2);
+    log_manager->SetNextLogNumber(log_manager->GetNextLogNumber() +
+                                  FLUSH_MAX_LOG_DISTANCE + 1);
+
+    background_writer->Start();
+    EXPECT_TRUE(WaitForDirtyPageCount(0));
+}
+
+TEST_F(BackgroundWriterTest, StopDoesNotWaitForThePause) {
+    EXPECT_TRUE(Init().ok());
+
+    // nothing to write, so the writer pauses for the longest interval
+    background_writer->Start();
+    std::this_thread::sleep_for(
+        std::chrono::milliseconds(FLUSH_MIN_WAIT_INTERVAL_MILLISECONDS));
+
+    auto start = std::chrono::steady_clock::now();
+    background_writer->Stop();
+    auto elapsed = std::chrono::steady_clock::now() - start;
+
+    EXPECT_LT(elapsed,
+              std::chrono::milliseconds(FLUSH_WAIT_INTERVAL_MILLISECONDS));
+}
+
+}  // namespace graphchaindb
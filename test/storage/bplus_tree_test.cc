@@ -3,17 +3,25 @@
 #include <glog/logging.h>
 #include <gtest/gtest.h>
 
+#include <algorithm>
 #include <filesystem>
 #include <map>
 #include <memory>
 #include <random>
+#include <thread>
+#include <vector>
 
+#include "absl/strings/match.h"
+#include "absl/strings/str_cat.h"
 #include "absl/strings/string_view.h"
 #include "src/common/config.h"
 #include "src/common/test_utils.h"
+#include "src/storage/bplus_tree_iterator.h"
 #include "src/storage/bplus_tree_page_internal.h"
 #include "src/storage/bplus_tree_page_leaf.h"
+#include "src/storage/bplus_tree_search.h"
 #include "src/storage/buffer_manager.h"
+#include "src/storage/default_key_comparator.h"
 #include "src/storage/disk_manager.h"
 #include "src/storage/log_entry.h"
 #include "src/storage/log_manager.h"
@@ -42,6 +50,8 @@ class BplusTreeTest : public ::testing::Test {
             return s.status();
         }
 
+        log_manager->SetNextLogNumber(STARTING_LOG_NUMBER);
+
         auto s3 = buffer_manager->Init(STARTING_NORMAL_PAGE_ID);
         if (!s3.ok()) {
             return s3;
@@ -50,6 +60,15 @@ class BplusTreeTest : public ::testing::Test {
         return bplus_tree->Init();
     }
 
+    // replace the tree with a B-link tree. MUST be called before Init
+    void UseBlinkTree() {
+        Options options;
+        options.blink_tree = true;
+        bplus_tree = std::make_unique<BplusTree>(
+            buffer_manager.get(), disk_manager.get(), log_manager.get(),
+            options);
+    }
+
     WriteOptions dummy_write_options;
     ReadOptions dummy_read_options;
     std::unique_ptr<DiskManager> disk_manager;
@@ -160,6 +179,531 @@ TEST_F(BplusTreeTest, MultipleRandomInsertGetDeleteSucceeds) {
     bplus_tree->PrintTree();
 }
 
+TEST_F(BplusTreeTest, IteratorScanAfterRandomInsertSucceeds) {
+    EXPECT_TRUE(Init().ok());
+    auto count = 2000;
+    std::map<std::string, std::string> kv;
+
+    std::random_device rd;
+    std::mt19937 mt(rd());
+    std::uniform_int_distribution<int> dist(1000, 9999);
+
+    // enough keys for the leaves to outnumber the frames of the buffer pool
+    for (auto i = 0; i < count; i++) {
+        std::string suffix = std::to_string(dist(mt));
+
+        std::string key = "dummy_key_" + suffix;
+        std::string value = "dummy_value_" + suffix;
+
+        kv[key] = value;
+
+        EXPECT_TRUE(bplus_tree->Insert(dummy_write_options, key, value).ok());
+    }
+
+    auto iterator = bplus_tree->NewIterator();
+    EXPECT_TRUE(iterator->SeekToFirst().ok());
+    for (auto kvp : kv) {
+        ASSERT_TRUE(iterator->IsValid());
+
+        auto entry_or_status = iterator->GetCurrent();
+        EXPECT_TRUE(entry_or_status.ok());
+        EXPECT_EQ(kvp.first, entry_or_status.value()->key);
+        EXPECT_EQ(kvp.second, entry_or_status.value()->value);
+
+        EXPECT_TRUE(iterator->Next().ok());
+    }
+    EXPECT_FALSE(iterator->IsValid());
+
+    // seek to the middle of the key space
+    auto expected_itr = kv.lower_bound("dummy_key_5000");
+    BplusTreeEntry seek_entry{"dummy_key_5000", ""};
+    EXPECT_TRUE(iterator->SeekEqOrGreaterTo(&seek_entry).ok());
+    for (; expected_itr != kv.end(); expected_itr++) {
+        ASSERT_TRUE(iterator->IsValid());
+        EXPECT_EQ(expected_itr->first, iterator->GetCurrent().value()->key);
+        EXPECT_TRUE(iterator->Next().ok());
+    }
+    EXPECT_FALSE(iterator->IsValid());
+}
+
+TEST_F(BplusTreeTest, VariableLengthInsertGetScanSucceeds) {
+    EXPECT_TRUE(Init().ok());
+    auto count = 1000;
+    std::map<std::string, std::string> kv;
+
+    std::mt19937 mt(42);
+    std::uniform_int_distribution<int> key_dist(0, 9999);
+    std::uniform_int_distribution<int> length_dist(0, 300);
+
+    // the long keys and values are kept in overflow pages, and the values of
+    // the overwritten keys change their size
+    for (auto i = 0; i < count; i++) {
+        std::string suffix = std::to_string(key_dist(mt));
+
+        std::string key = std::string(length_dist(mt) / 2, 'k') + suffix;
+        std::string value = suffix + std::string(length_dist(mt), 'v');
+
+        kv[key] = value;
+
+        EXPECT_TRUE(bplus_tree->Insert(dummy_write_options, key, value).ok());
+    }
+
+    for (auto kvp : kv) {
+        auto value_or_status = bplus_tree->Get(dummy_read_options, kvp.first);
+        EXPECT_TRUE(value_or_status.ok());
+        EXPECT_EQ(kvp.second, value_or_status.value());
+    }
+
+    auto iterator = bplus_tree->NewIterator();
+    EXPECT_TRUE(iterator->SeekToFirst().ok());
+    for (auto kvp : kv) {
+        ASSERT_TRUE(iterator->IsValid());
+        EXPECT_EQ(kvp.first, iterator->GetCurrent().value()->key);
+        EXPECT_TRUE(iterator->Next().ok());
+    }
+    EXPECT_FALSE(iterator->IsValid());
+
+    for (auto kvp : kv) {
+        EXPECT_TRUE(bplus_tree->Delete(dummy_write_options, kvp.first).ok());
+    }
+}
+
+TEST_F(BplusTreeTest, PrefixCompressedInsertGetScanSucceeds) {
+    EXPECT_TRUE(Init().ok());
+    auto count = 3000;
+    std::map<std::string, std::string> kv;
+
+    std::mt19937 mt(42);
+    std::uniform_int_distribution<int> tenant_dist(0, 9);
+    std::uniform_int_distribution<int> id_dist(0, 99999999);
+
+    for (auto i = 0; i < count; i++) {
+        char key[64];
+        snprintf(key, sizeof(key), "tenant_%02d/entity/%08d", tenant_dist(mt),
+                 id_dist(mt));
+        std::string value = "dummy_value_" + std::to_string(i);
+
+        kv[key] = value;
+
+        EXPECT_TRUE(bplus_tree->Insert(dummy_write_options, key, value).ok());
+    }
+
+    for (auto kvp : kv) {
+        auto value_or_status = bplus_tree->Get(dummy_read_options, kvp.first);
+        EXPECT_TRUE(value_or_status.ok());
+        EXPECT_EQ(kvp.second, value_or_status.value());
+    }
+
+    auto iterator = bplus_tree->NewIterator();
+    EXPECT_TRUE(iterator->SeekToFirst().ok());
+    for (auto kvp : kv) {
+        ASSERT_TRUE(iterator->IsValid());
+        EXPECT_EQ(kvp.first, iterator->GetCurrent().value()->key);
+        EXPECT_EQ(kvp.second, iterator->GetCurrent().value()->value);
+        EXPECT_TRUE(iterator->Next().ok());
+    }
+    EXPECT_FALSE(iterator->IsValid());
+
+    // most of the pages below the root hold the keys of a single tenant,
+    // whose common prefix they store only once
+    auto root_page_container =
+        buffer_manager->GetPageWithId(bplus_tree->root_page_id_).value();
+    auto root_page = reinterpret_cast<BplusTreeInternalPage*>(
+        root_page_container->GetData());
+    ASSERT_EQ(root_page->GetPageType(), PageType::PAGE_TYPE_BPLUS_INTERNAL);
+
+    int compressed_count = 0;
+    for (int32_t idx = 0; idx <= root_page->GetCount(); idx++) {
+        auto child_page_container =
+            buffer_manager->GetPageWithId(root_page->GetChild(idx)).value();
+        auto child_page =
+            reinterpret_cast<BplusTreePage*>(child_page_container->GetData());
+        if (absl::StartsWith(child_page->GetPrefix(), "tenant_")) {
+            compressed_count++;
+        }
+        buffer_manager->UnpinPage(child_page_container);
+    }
+    auto root_count = root_page->GetCount();
+    buffer_manager->UnpinPage(root_page_container);
+    EXPECT_GT(compressed_count, root_count / 2);
+
+    for (auto kvp : kv) {
+        EXPECT_TRUE(bplus_tree->Delete(dummy_write_options, kvp.first).ok());
+    }
+}
+
+TEST_F(BplusTreeTest, GetCountsRootPageInStatsSucceeds) {
+    EXPECT_TRUE(Init().ok());
+    auto count = 1000;
+
+    for (auto i = 0; i < count; i++) {
+        std::string key = "dummy_key_" + std::to_string(i);
+        EXPECT_TRUE(bplus_tree->Insert(dummy_write_options, key, key).ok());
+    }
+
+    // every get starts at the root, which is counted apart from the pages
+    // below it
+    auto before = buffer_manager->GetStats();
+    for (auto i = 0; i < count; i++) {
+        std::string key = "dummy_key_" + std::to_string(i);
+        EXPECT_TRUE(bplus_tree->Get(dummy_read_options, key).ok());
+    }
+    auto after = buffer_manager->GetStats();
+
+    EXPECT_GE(after.Get(PAGE_TYPE_ROOT, BUFFER_HIT) -
+                  before.Get(PAGE_TYPE_ROOT, BUFFER_HIT),
+              count);
+    EXPECT_GE(after.Get(PAGE_TYPE_BPLUS_LEAF, BUFFER_HIT) +
+                  after.Get(PAGE_TYPE_BPLUS_LEAF, BUFFER_MISS) -
+                  before.Get(PAGE_TYPE_BPLUS_LEAF, BUFFER_HIT) -
+                  before.Get(PAGE_TYPE_BPLUS_LEAF, BUFFER_MISS),
+              count);
+}
+
+TEST_F(BplusTreeTest, ConcurrentGetDuringInsertSucceeds) {
+    EXPECT_TRUE(Init().ok());
+    auto count = 1000;
+
+    // the first half is inserted upfront and must stay readable while the
+    // second half splits the pages under the readers.
+    for (auto i = 0; i < count / 2; i++) {
+        std::string key = "dummy_key_" + std::to_string(1000 + i);
+        std::string value = "dummy_value_" + std::to_string(1000 + i);
+        EXPECT_TRUE(bplus_tree->Insert(dummy_write_options, key, value).ok());
+    }
+
+    std::thread writer([&]() {
+        for (auto i = count / 2; i < count; i++) {
+            std::string key = "dummy_key_" + std::to_string(1000 + i);
+            std::string value = "dummy_value_" + std::to_string(1000 + i);
+            EXPECT_TRUE(
+                bplus_tree->Insert(dummy_write_options, key, value).ok());
+        }
+    });
+
+    std::vector<std::thread> readers;
+    for (int t = 0; t < 4; t++) {
+        readers.emplace_back([&, t]() {
+            for (auto i = t; i < count / 2; i += 4) {
+                std::string key = "dummy_key_" + std::to_string(1000 + i);
+                auto value_or_status = bplus_tree->Get(dummy_read_options, key);
+                EXPECT_TRUE(value_or_status.ok());
+                EXPECT_EQ("dummy_value_" + std::to_string(1000 + i),
+                          value_or_status.value());
+            }
+        });
+    }
+
+    writer.join();
+    for (auto& reader : readers) {
+        reader.join();
+    }
+}
+
+TEST_F(BplusTreeTest, ConcurrentInsertDeleteGetSucceeds) {
+    EXPECT_TRUE(Init().ok());
+    auto count = 400;
+    auto threads = 4;
+
+    // keys of the form dummy_key_<thread><index>. The even ones are inserted
+    // upfront and deleted concurrently with the inserts of the odd ones,
+    // while readers look up keys which are never deleted.
+    auto key_of = [](int t, int i) {
+        return "dummy_key_" + std::to_string(t) + std::to_string(1000 + i);
+    };
+    for (int t = 0; t < threads; t++) {
+        for (auto i = 0; i < count; i += 2) {
+            EXPECT_TRUE(bplus_tree
+                            ->Insert(dummy_write_options, key_of(t, i),
+                                     key_of(t, i))
+                            .ok());
+        }
+    }
+
+    std::vector<std::thread> workers;
+    for (int t = 0; t < threads; t++) {
+        workers.emplace_back([&, t]() {
+            for (auto i = 0; i < count; i += 2) {
+                EXPECT_TRUE(bplus_tree
+                                ->Insert(dummy_write_options, key_of(t, i + 1),
+                                         key_of(t, i + 1))
+                                .ok());
+                if (i % 4 == 0) {
+                    EXPECT_TRUE(
+                        bplus_tree->Delete(dummy_write_options, key_of(t, i))
+                            .ok());
+                }
+            }
+        });
+        workers.emplace_back([&, t]() {
+            for (auto i = 2; i < count; i += 4) {
+                auto value_or_status =
+                    bplus_tree->Get(dummy_read_options, key_of(t, i));
+                EXPECT_TRUE(value_or_status.ok());
+                EXPECT_EQ(key_of(t, i), value_or_status.value());
+            }
+        });
+    }
+    for (auto& worker : workers) {
+        worker.join();
+    }
+
+    for (int t = 0; t < threads; t++) {
+        for (auto i = 0; i < count; i++) {
+            auto value_or_status =
+                bplus_tree->Get(dummy_read_options, key_of(t, i));
+            EXPECT_EQ(value_or_status.ok(), i % 4 != 0);
+        }
+    }
+}
+
+TEST_F(BplusTreeTest, DeleteMergesPagesAndShrinksTreeSucceeds) {
+    EXPECT_TRUE(Init().ok());
+    auto count = 20000;
+    auto remaining = 50;
+    auto key_of = [](int i) {
+        char key[32];
+        snprintf(key, sizeof(key), "dummy_key_%06d", i);
+        return std::string(key);
+    };
+
+    std::vector<int> ids(count);
+    for (auto i = 0; i < count; i++) {
+        ids[i] = i;
+    }
+    std::mt19937 mt(42);
+    std::shuffle(ids.begin(), ids.end(), mt);
+    for (auto id : ids) {
+        EXPECT_TRUE(bplus_tree
+                        ->Insert(dummy_write_options, key_of(id),
+                                 "dummy_value_" + key_of(id))
+                        .ok());
+    }
+
+    // delete all but a few keys, which fit into a single leaf
+    std::shuffle(ids.begin(), ids.end(), mt);
+    for (auto i = remaining; i < count; i++) {
+        EXPECT_TRUE(
+            bplus_tree->Delete(dummy_write_options, key_of(ids[i])).ok());
+    }
+
+    std::map<std::string, std::string> kv;
+    for (auto i = 0; i < count; i++) {
+        auto value_or_status =
+            bplus_tree->Get(dummy_read_options, key_of(ids[i]));
+        EXPECT_EQ(value_or_status.ok(), i < remaining);
+        if (i < remaining) {
+            EXPECT_EQ("dummy_value_" + key_of(ids[i]), value_or_status.value());
+            kv[key_of(ids[i])] = value_or_status.value();
+        }
+    }
+
+    auto iterator = bplus_tree->NewIterator();
+    EXPECT_TRUE(iterator->SeekToFirst().ok());
+    for (auto kvp : kv) {
+        ASSERT_TRUE(iterator->IsValid());
+        EXPECT_EQ(kvp.first, iterator->GetCurrent().value()->key);
+        EXPECT_EQ(kvp.second, iterator->GetCurrent().value()->value);
+        EXPECT_TRUE(iterator->Next().ok());
+    }
+    EXPECT_FALSE(iterator->IsValid());
+    iterator.reset();
+
+    // the tree shrank back to a root with a few leaves at most, and the
+    // pages which were merged away are marked as invalid
+    auto root_page_container =
+        buffer_manager->GetPageWithId(bplus_tree->root_page_id_).value();
+    auto root_page = reinterpret_cast<BplusTreeInternalPage*>(
+        root_page_container->GetData());
+    if (root_page->GetPageType() == PageType::PAGE_TYPE_BPLUS_INTERNAL) {
+        EXPECT_LE(root_page->GetCount(), 2);
+        for (int32_t idx = 0; idx <= root_page->GetCount(); idx++) {
+            auto child_page_container =
+                buffer_manager->GetPageWithId(root_page->GetChild(idx))
+                    .value();
+            EXPECT_EQ(reinterpret_cast<BplusTreePage*>(
+                          child_page_container->GetData())
+                          ->GetPageType(),
+                      PageType::PAGE_TYPE_BPLUS_LEAF);
+            buffer_manager->UnpinPage(child_page_container);
+        }
+    }
+    buffer_manager->UnpinPage(root_page_container);
+
+    auto freed_page_ids = bplus_tree->TakeFreedPageIds();
+    EXPECT_GT(freed_page_ids.size(), 100);
+    EXPECT_TRUE(bplus_tree->TakeFreedPageIds().empty());
+    auto freed_page_container =
+        buffer_manager->GetPageWithId(freed_page_ids.front()).value();
+    EXPECT_EQ(
+        reinterpret_cast<BplusTreePage*>(freed_page_container->GetData())
+            ->GetPageType(),
+        PageType::PAGE_TYPE_INVALID);
+    buffer_manager->UnpinPage(freed_page_container);
+
+    // and grows again
+    for (auto i = remaining; i < count; i++) {
+        EXPECT_TRUE(
+            bplus_tree->Insert(dummy_write_options, key_of(ids[i]), "dummy")
+                .ok());
+    }
+    for (auto i = 0; i < count; i += 13) {
+        EXPECT_TRUE(bplus_tree->Get(dummy_read_options, key_of(i)).ok());
+    }
+}
+
+TEST_F(BplusTreeTest, ConcurrentScanDuringDeleteSucceeds) {
+    EXPECT_TRUE(Init().ok());
+    auto count = 6000;
+    auto key_of = [](int i) {
+        char key[32];
+        snprintf(key, sizeof(key), "dummy_key_%06d", i);
+        return std::string(key);
+    };
+    for (auto i = 0; i < count; i++) {
+        EXPECT_TRUE(
+            bplus_tree->Insert(dummy_write_options, key_of(i), key_of(i)).ok());
+    }
+
+    // the keys which aren't multiples of 8 are deleted while the leaves are
+    // scanned, which merges and rebalances them under the scans. Every scan
+    // must still see each of the other keys exactly once, in order.
+    std::thread deleter([&]() {
+        for (auto i = 0; i < count; i++) {
+            if (i % 8 != 0) {
+                EXPECT_TRUE(
+                    bplus_tree->Delete(dummy_write_options, key_of(i)).ok());
+            }
+        }
+    });
+
+    std::vector<std::thread> scanners;
+    for (int t = 0; t < 2; t++) {
+        scanners.emplace_back([&]() {
+            for (int scan = 0; scan < 5; scan++) {
+                auto iterator = bplus_tree->NewIterator();
+                EXPECT_TRUE(iterator->SeekToFirst().ok());
+
+                std::string last_key;
+                int kept = 0;
+                while (iterator->IsValid()) {
+                    auto key = iterator->GetCurrent().value()->key;
+                    EXPECT_LT(last_key, key);
+                    if (key == key_of(8 * kept)) {
+                        kept++;
+                    }
+                    last_key = key;
+                    EXPECT_TRUE(iterator->Next().ok());
+                }
+                EXPECT_EQ(kept, count / 8);
+            }
+        });
+    }
+
+    deleter.join();
+    for (auto& scanner : scanners) {
+        scanner.join();
+    }
+}
+
+TEST_F(BplusTreeTest, BlinkTreeRandomInsertGetScanDeleteSucceeds) {
+    UseBlinkTree();
+    EXPECT_TRUE(Init().ok());
+    auto count = 3000;
+    std::map<std::string, std::string> kv;
+
+    std::random_device rd;
+    std::mt19937 mt(rd());
+    std::uniform_int_distribution<int> dist(10000, 99999);
+
+    // enough keys to split the internal pages as well
+    for (auto i = 0; i < count; i++) {
+        std::string suffix = std::to_string(dist(mt));
+
+        std::string key = "dummy_key_" + suffix;
+        std::string value = "dummy_value_" + suffix;
+
+        kv[key] = value;
+
+        EXPECT_TRUE(bplus_tree->Insert(dummy_write_options, key, value).ok());
+    }
+
+    for (auto kvp : kv) {
+        auto value_or_status = bplus_tree->Get(dummy_read_options, kvp.first);
+        EXPECT_TRUE(value_or_status.ok());
+        EXPECT_EQ(kvp.second, value_or_status->data());
+    }
+
+    auto expected_itr = kv.lower_bound("dummy_key_50000");
+    BplusTreeEntry seek_entry{"dummy_key_50000", ""};
+    auto iterator = bplus_tree->NewIterator();
+    EXPECT_TRUE(iterator->SeekEqOrGreaterTo(&seek_entry).ok());
+    for (; expected_itr != kv.end(); expected_itr++) {
+        ASSERT_TRUE(iterator->IsValid());
+        EXPECT_EQ(expected_itr->first, iterator->GetCurrent().value()->key);
+        EXPECT_TRUE(iterator->Next().ok());
+    }
+    EXPECT_FALSE(iterator->IsValid());
+
+    for (auto kvp : kv) {
+        EXPECT_TRUE(bplus_tree->Delete(dummy_write_options, kvp.first).ok());
+        EXPECT_FALSE(bplus_tree->Get(dummy_read_options, kvp.first).ok());
+    }
+}
+
+TEST_F(BplusTreeTest, BlinkTreeConcurrentInsertGetSucceeds) {
+    UseBlinkTree();
+    EXPECT_TRUE(Init().ok());
+    auto count = 1000;
+    auto threads = 4;
+
+    // the even keys are inserted upfront and read while the odd ones are
+    // inserted concurrently, splitting the pages under the readers.
+    auto key_of = [](int t, int i) {
+        return "dummy_key_" + std::to_string(10000 + i) + std::to_string(t);
+    };
+    for (int t = 0; t < threads; t++) {
+        for (auto i = 0; i < count; i += 2) {
+            EXPECT_TRUE(bplus_tree
+                            ->Insert(dummy_write_options, key_of(t, i),
+                                     key_of(t, i))
+                            .ok());
+        }
+    }
+
+    std::vector<std::thread> workers;
+    for (int t = 0; t < threads; t++) {
+        workers.emplace_back([&, t]() {
+            for (auto i = 1; i < count; i += 2) {
+                EXPECT_TRUE(bplus_tree
+                                ->Insert(dummy_write_options, key_of(t, i),
+                                         key_of(t, i))
+                                .ok());
+            }
+        });
+        workers.emplace_back([&, t]() {
+            for (auto i = 0; i < count; i += 2) {
+                auto value_or_status =
+                    bplus_tree->Get(dummy_read_options, key_of(t, i));
+                EXPECT_TRUE(value_or_status.ok());
+                EXPECT_EQ(key_of(t, i), value_or_status.value());
+            }
+        });
+    }
+    for (auto& worker : workers) {
+        worker.join();
+    }
+
+    for (int t = 0; t < threads; t++) {
+        for (auto i = 0; i < count; i++) {
+            auto value_or_status =
+                bplus_tree->Get(dummy_read_options, key_of(t, i));
+            EXPECT_TRUE(value_or_status.ok());
+            EXPECT_EQ(key_of(t, i), value_or_status.value());
+        }
+    }
+}
+
 TEST_F(BplusTreeTest, SequentialAllDoubleDigitsInsertGetDeleteSucceeds) {
     EXPECT_TRUE(Init().ok());
     auto count = 100;
@@ -211,55 +755,416 @@ TEST_F(BplusTreeTest, SplitChildLeafSucceeds) {
     child_page->InitPage(child_page_container->GetPageId(),
                          PageType::PAGE_TYPE_BPLUS_LEAF, INVALID_PAGE_ID);
 
-    parent_page->children_[0] = child_page->GetPageId();
-    for (int idx = 0; idx < BPLUS_LEAF_KEY_VALUE_SIZE; idx++) {
-        std::string key = "dummy_key_" + std::to_string(idx);
-        std::string value = "dummy_value_" + std::to_string(idx);
+    parent_page->SetChild(0, child_page->GetPageId());
+    std::vector<std::pair<std::string, std::string>> pairs;
+    while (!child_page->IsFull()) {
+        char key[32];
+        char value[32];
+        snprintf(key, sizeof(key), "dummy_key_%04d",
+                 static_cast<int>(pairs.size()));
+        snprintf(value, sizeof(value), "dummy_value_%04d",
+                 static_cast<int>(pairs.size()));
 
-        child_page->data_[idx].key.SetStringData(buffer_manager.get(), key);
-        child_page->data_[idx].value.SetStringData(buffer_manager.get(), value);
+        EXPECT_TRUE(child_page->Insert(child_page->GetCount(), key, value,
+                                       buffer_manager.get()));
+        pairs.emplace_back(key, value);
     }
 
     uint32_t split_index = 0;
-    auto median_idx = BPLUS_LEAF_KEY_VALUE_SIZE / 2 - 1;
 
     auto statusOrNewChildPageId = bplus_tree->SplitChild(
         parent_page_container, split_index, child_page_container);
     EXPECT_TRUE(statusOrNewChildPageId.ok());
     auto second_child_page_id = statusOrNewChildPageId.value();
 
+    auto second_child_page_container =
+        buffer_manager->GetPageWithId(second_child_page_id).value();
+    auto second_child_page = reinterpret_cast<BplusTreeLeafPage*>(
+        second_child_page_container->GetData());
+
+    // the pairs are of about the same size, so they are split in halves
+    auto left_count = child_page->GetCount();
     EXPECT_EQ(parent_page->GetCount(), 1);
-    EXPECT_EQ(child_page->GetCount(), BPLUS_LEAF_KEY_VALUE_SIZE / 2);
+    EXPECT_EQ(left_count + second_child_page->GetCount(),
+              static_cast<int32_t>(pairs.size()));
+    EXPECT_LE(std::abs(left_count - second_child_page->GetCount()), 1);
+    EXPECT_FALSE(child_page->IsFull());
+    EXPECT_FALSE(second_child_page->IsFull());
 
-    EXPECT_EQ(
-        parent_page->keys_[split_index].GetStringData(buffer_manager.get()),
-        child_page->data_[median_idx].key.GetStringData(buffer_manager.get()));
-    EXPECT_EQ(parent_page->children_[split_index],
+    // the separator is truncated to the shortest key between the halves
+    auto separator = parent_page->GetKey(split_index, buffer_manager.get());
+    EXPECT_LE(pairs[left_count - 1].first, separator);
+    EXPECT_LT(separator, pairs[left_count].first);
+    EXPECT_EQ(parent_page->GetChild(split_index),
               child_page->GetPageId());  // verification that it doesn't
                                          // overwrite this accidently
-    EXPECT_EQ(parent_page->children_[split_index + 1], second_child_page_id);
+    EXPECT_EQ(parent_page->GetChild(split_index + 1), second_child_page_id);
+
+    for (int idx = 0; idx < static_cast<int>(pairs.size()); idx++) {
+        auto page = idx < left_count ? child_page : second_child_page;
+        auto page_idx = idx < left_count ? idx : idx - left_count;
+        EXPECT_EQ(page->GetKey(page_idx, buffer_manager.get()),
+                  pairs[idx].first);
+        EXPECT_EQ(page->GetValue(page_idx, buffer_manager.get()),
+                  pairs[idx].second);
+    }
+
+    EXPECT_EQ(child_page->GetParentPageId(), parent_page->GetPageId());
+    EXPECT_EQ(second_child_page->GetParentPageId(), parent_page->GetPageId());
+    EXPECT_EQ(child_page->GetNextPageId(), second_child_page_id);
+    EXPECT_EQ(second_child_page->GetNextPageId(), INVALID_PAGE_ID);
+}
+
+TEST_F(BplusTreeTest, SplitChildLeafTruncatesSeparatorSucceeds) {
+    EXPECT_TRUE(Init().ok());
+
+    // setup
+    auto parent_page_container = buffer_manager->AllocateNewPage().value();
+    auto parent_page = reinterpret_cast<BplusTreeInternalPage*>(
+        parent_page_container->GetData());
+    parent_page->InitPage(parent_page_container->GetPageId(),
+                          PageType::PAGE_TYPE_BPLUS_INTERNAL, INVALID_PAGE_ID);
+
+    auto child_page_container = buffer_manager->AllocateNewPage().value();
+    auto child_page =
+        reinterpret_cast<BplusTreeLeafPage*>(child_page_container->GetData());
+    child_page->InitPage(child_page_container->GetPageId(),
+                         PageType::PAGE_TYPE_BPLUS_LEAF, INVALID_PAGE_ID);
+
+    // the keys differ early, but are long
+    parent_page->SetChild(0, child_page->GetPageId());
+    std::vector<std::string> keys;
+    while (!child_page->IsFull()) {
+        char key[64];
+        snprintf(key, sizeof(key), "dummy_key_%04d/long/entity/suffix",
+                 static_cast<int>(keys.size()));
+
+        EXPECT_TRUE(child_page->Insert(child_page->GetCount(), key,
+                                       "dummy_value", buffer_manager.get()));
+        keys.emplace_back(key);
+    }
+
+    EXPECT_TRUE(
+        bplus_tree->SplitChild(parent_page_container, 0, child_page_container)
+            .ok());
+
+    auto left_count = child_page->GetCount();
+    auto separator = parent_page->GetKey(0, buffer_manager.get());
+    EXPECT_EQ(separator, keys[left_count].substr(0, strlen("dummy_key_0000")));
+    EXPECT_LE(keys[left_count - 1], separator);
+    EXPECT_LT(separator, keys[left_count]);
+    EXPECT_EQ(child_page->GetHighKey(buffer_manager.get()), separator);
+
+    // the keys on both sides of a truncated separator are found in the tree
+    for (auto& key : keys) {
+        EXPECT_TRUE(bplus_tree->Insert(dummy_write_options, key, key).ok());
+    }
+    for (auto& key : keys) {
+        auto value_or_status = bplus_tree->Get(dummy_read_options, key);
+        EXPECT_TRUE(value_or_status.ok());
+        EXPECT_EQ(key, value_or_status.value());
+    }
+}
 
+TEST_F(BplusTreeTest, LeafKeyHeadsFollowInsertRemoveSucceeds) {
+    EXPECT_TRUE(Init().ok());
+
+    // setup
+    auto page_container = buffer_manager->AllocateNewPage().value();
+    auto page = reinterpret_cast<BplusTreeLeafPage*>(page_container->GetData());
+    page->InitPage(page_container->GetPageId(), PageType::PAGE_TYPE_BPLUS_LEAF,
+                   INVALID_PAGE_ID);
+
+    // the keys share their first bytes often, and some are shorter than a
+    // key head
+    DefaultKeyComparator comp;
+    std::mt19937 generator(7);
+    std::uniform_int_distribution<int> distribution(0, 9999);
+    while (!page->IsFull()) {
+        auto key = std::to_string(distribution(generator));
+        bool found;
+        auto index = LowerBoundKeyInPage(&comp, buffer_manager.get(), key,
+                                         page, &found);
+        if (found) {
+            continue;
+        }
+        EXPECT_TRUE(page->Insert(index, key, key, buffer_manager.get()));
+    }
+    for (int32_t idx = page->GetCount() - 1; idx >= 0; idx -= 3) {
+        page->Remove(idx);
+    }
+
+    auto key_heads = page->GetKeyHeads();
+    for (int32_t idx = 0; idx < page->GetCount(); idx++) {
+        auto key = page->GetKey(idx, buffer_manager.get());
+        EXPECT_EQ(key_heads[idx], BplusTreePage::GetKeyHead(key));
+        EXPECT_EQ(key, page->GetValue(idx, buffer_manager.get()));
+        if (idx > 0) {
+            EXPECT_LE(key_heads[idx - 1], key_heads[idx]);
+        }
+
+        bool found;
+        EXPECT_EQ(idx, LowerBoundKeyInPage(&comp, buffer_manager.get(), key,
+                                           page, &found));
+        EXPECT_TRUE(found);
+    }
+}
+
+TEST_F(BplusTreeTest, LeafPrefixChangeKeepsLongKeysSucceeds) {
+    EXPECT_TRUE(Init().ok());
+
+    // setup
+    auto page_container = buffer_manager->AllocateNewPage().value();
+    auto page = reinterpret_cast<BplusTreeLeafPage*>(page_container->GetData());
+    page->InitPage(page_container->GetPageId(), PageType::PAGE_TYPE_BPLUS_LEAF,
+                   INVALID_PAGE_ID);
+
+    // every long key fills most of an overflow page, so writing any of them
+    // again would take a new one
+    std::vector<std::string> keys;
+    for (int32_t idx = 0; idx < 8; idx++) {
+        keys.push_back(absl::StrCat("tenant_", idx, "/",
+                                    std::string(idx % 2 ? 3000 : 8, 'k')));
+        EXPECT_TRUE(page->Insert(idx, keys.back(), "dummy_value",
+                                 buffer_manager.get()));
+    }
+    auto next_page_id = buffer_manager->GetNextPageId();
+
+    // the prefix grows and then shrinks again
+    page->SetRightPageId(page_container->GetPageId() + 1);
+    EXPECT_TRUE(page->SetLowKey("tenant_", buffer_manager.get()));
+    EXPECT_TRUE(page->SetHighKey("tenant_9", buffer_manager.get()));
+    EXPECT_TRUE(page->UpdatePrefix(buffer_manager.get()));
+    EXPECT_EQ(page->GetPrefix(), "tenant_");
+    EXPECT_TRUE(page->SetLowKey("t", buffer_manager.get()));
+    EXPECT_TRUE(page->UpdatePrefix(buffer_manager.get()));
+    EXPECT_EQ(page->GetPrefix(), "t");
+    EXPECT_EQ(buffer_manager->GetNextPageId(), next_page_id);
+
+    auto key_heads = page->GetKeyHeads();
+    for (int32_t idx = 0; idx < page->GetCount(); idx++) {
+        EXPECT_EQ(keys[idx], page->GetKey(idx, buffer_manager.get()));
+        EXPECT_EQ(key_heads[idx],
+                  BplusTreePage::GetKeyHead(
+                      page->GetKeySuffix(idx, buffer_manager.get())));
+        EXPECT_EQ("dummy_value", page->GetValue(idx, buffer_manager.get()));
+    }
+}
+
+TEST_F(BplusTreeTest, BulkLoadGetScanInsertDeleteSucceeds) {
+    EXPECT_TRUE(Init().ok());
+
+    // enough keys for a few levels of internal pages
+    auto count = 20000;
+    auto key_of = [](int i) {
+        char key[32];
+        snprintf(key, sizeof(key), "dummy_key_%06d", i);
+        return std::string(key);
+    };
+
+    page_id_t empty_root_id = bplus_tree->root_page_id_;
+    BulkLoadOptions options;
+    options.fill_factor = 0.7;
+    int next_key = 0;
+    EXPECT_TRUE(bplus_tree
+                    ->BulkLoad(options,
+                               [&](std::string* key, std::string* value)
+                                   -> absl::StatusOr<bool> {
+                                   if (next_key == count) {
+                                       return false;
+                                   }
+                                   *key = key_of(2 * next_key);
+                                   *value = "dummy_value_" + *key;
+                                   next_key++;
+                                   return true;
+                               })
+                    .ok());
+    EXPECT_EQ(bplus_tree->TakeFreedPageIds(),
+              std::vector<page_id_t>{empty_root_id});
+
+    for (auto i = 0; i < count; i += 7) {
+        auto value_or_status =
+            bplus_tree->Get(dummy_read_options, key_of(2 * i));
+        EXPECT_TRUE(value_or_status.ok());
+        EXPECT_EQ("dummy_value_" + key_of(2 * i), value_or_status.value());
+        EXPECT_TRUE(absl::IsNotFound(
+            bplus_tree->Get(dummy_read_options, key_of(2 * i + 1)).status()));
+    }
+
+    auto iterator = bplus_tree->NewIterator();
+    EXPECT_TRUE(iterator->SeekToFirst().ok());
+    for (auto i = 0; i < count; i++) {
+        ASSERT_TRUE(iterator->IsValid());
+        EXPECT_EQ(key_of(2 * i), iterator->GetCurrent().value()->key);
+        EXPECT_TRUE(iterator->Next().ok());
+    }
+    EXPECT_FALSE(iterator->IsValid());
+    iterator.reset();
+
+    // the loaded tree takes inserts between the loaded keys and deletes
+    for (auto i = 0; i < count; i += 3) {
+        EXPECT_TRUE(bplus_tree
+                        ->Insert(dummy_write_options, key_of(2 * i + 1),
+                                 "dummy_value")
+                        .ok());
+    }
+    for (auto i = 0; i < count; i++) {
+        EXPECT_TRUE(
+            bplus_tree->Delete(dummy_write_options, key_of(2 * i)).ok());
+        if (i % 3 == 0) {
+            auto value_or_status =
+                bplus_tree->Get(dummy_read_options, key_of(2 * i + 1));
+            EXPECT_TRUE(value_or_status.ok());
+            EXPECT_EQ("dummy_value", value_or_status.value());
+        }
+    }
+}
+
+TEST_F(BplusTreeTest, BulkLoadInvalidInputFails) {
+    EXPECT_TRUE(Init().ok());
+
+    std::vector<std::string> keys = {"dummy_key_1", "dummy_key_3",
+                                     "dummy_key_2"};
+    size_t next_key = 0;
+    auto next = [&](std::string* key,
+                    std::string* value) -> absl::StatusOr<bool> {
+        if (next_key == keys.size()) {
+            return false;
+        }
+        *key = keys[next_key++];
+        *value = *key;
+        return true;
+    };
+
+    BulkLoadOptions options;
+    options.fill_factor = 0;
+    EXPECT_TRUE(absl::IsInvalidArgument(bplus_tree->BulkLoad(options, next)));
+
+    options.fill_factor = 1;
+    EXPECT_TRUE(absl::IsInvalidArgument(bplus_tree->BulkLoad(options, next)));
+    EXPECT_TRUE(absl::IsNotFound(
+        bplus_tree->Get(dummy_read_options, "dummy_key_1").status()));
+
+    // only an empty tree is loaded
+    EXPECT_TRUE(
+        bplus_tree->Insert(dummy_write_options, "dummy_key_0", "value").ok());
+    keys.pop_back();
+    next_key = 0;
+    EXPECT_TRUE(
+        absl::IsFailedPrecondition(bplus_tree->BulkLoad(options, next)));
+}
+
+TEST_F(BplusTreeTest, BorrowOrMergeChildLeafSucceeds) {
+    EXPECT_TRUE(Init().ok());
+
+    // setup: two halves of a split leaf
+    auto parent_page_container = buffer_manager->AllocateNewPage().value();
+    auto parent_page = reinterpret_cast<BplusTreeInternalPage*>(
+        parent_page_container->GetData());
+    parent_page->InitPage(parent_page_container->GetPageId(),
+                          PageType::PAGE_TYPE_BPLUS_INTERNAL, INVALID_PAGE_ID);
+
+    auto child_page_container = buffer_manager->AllocateNewPage().value();
+    auto child_page =
+        reinterpret_cast<BplusTreeLeafPage*>(child_page_container->GetData());
+    child_page->InitPage(child_page_container->GetPageId(),
+                         PageType::PAGE_TYPE_BPLUS_LEAF, INVALID_PAGE_ID);
+    parent_page->SetChild(0, child_page->GetPageId());
+
+    std::vector<std::pair<std::string, std::string>> pairs;
+    auto append = [&](BplusTreeLeafPage* page) {
+        char key[32];
+        char value[32];
+        snprintf(key, sizeof(key), "dummy_key_%04d",
+                 static_cast<int>(pairs.size()));
+        snprintf(value, sizeof(value), "dummy_value_%04d",
+                 static_cast<int>(pairs.size()));
+
+        EXPECT_TRUE(
+            page->Insert(page->GetCount(), key, value, buffer_manager.get()));
+        pairs.emplace_back(key, value);
+    };
+    while (!child_page->IsFull()) {
+        append(child_page);
+    }
+
+    auto second_child_page_id =
+        bplus_tree->SplitChild(parent_page_container, 0, child_page_container)
+            .value();
     auto second_child_page_container =
         buffer_manager->GetPageWithId(second_child_page_id).value();
     auto second_child_page = reinterpret_cast<BplusTreeLeafPage*>(
         second_child_page_container->GetData());
-    EXPECT_EQ(second_child_page->GetCount(), BPLUS_LEAF_KEY_VALUE_SIZE / 2);
 
-    for (int idx = BPLUS_LEAF_KEY_VALUE_SIZE / 2;
-         idx < BPLUS_LEAF_KEY_VALUE_SIZE; idx++) {
-        EXPECT_EQ(
-            child_page->data_[idx].key.GetStringData(buffer_manager.get()),
-            second_child_page->data_[idx - BPLUS_LEAF_KEY_VALUE_SIZE / 2]
-                .key.GetStringData(buffer_manager.get()));
+    auto expect_pairs = [&](int32_t first) {
+        auto left_count = child_page->GetCount();
+        EXPECT_EQ(left_count + second_child_page->GetCount(),
+                  static_cast<int32_t>(pairs.size()) - first);
+        for (int idx = first; idx < static_cast<int>(pairs.size()); idx++) {
+            auto page_idx = idx - first;
+            auto page = page_idx < left_count ? child_page : second_child_page;
+            page_idx = page_idx < left_count ? page_idx : page_idx - left_count;
+            EXPECT_EQ(page->GetKey(page_idx, buffer_manager.get()),
+                      pairs[idx].first);
+            EXPECT_EQ(page->GetValue(page_idx, buffer_manager.get()),
+                      pairs[idx].second);
+        }
+    };
+
+    // the left child is underfull next to a full sibling, so it borrows
+    while (!second_child_page->IsFull()) {
+        append(second_child_page);
+    }
+    int32_t first = 0;
+    while (!child_page->IsUnderfull()) {
+        child_page->Remove(0);
+        first++;
+    }
+
+    EXPECT_TRUE(
+        bplus_tree
+            ->BorrowOrMergeChild(parent_page_container, 0, child_page_container)
+            .ok());
+    EXPECT_EQ(parent_page->GetCount(), 1);
+    EXPECT_FALSE(child_page->IsUnderfull());
+    EXPECT_FALSE(second_child_page->IsUnderfull());
+    EXPECT_LE(std::abs(child_page->GetUsedSpace() -
+                       second_child_page->GetUsedSpace()),
+              BplusTreeLeafPage::MAX_CELL_SIZE);
+    expect_pairs(first);
 
-        EXPECT_EQ(
-            child_page->data_[idx].value.GetStringData(buffer_manager.get()),
-            second_child_page->data_[idx - BPLUS_LEAF_KEY_VALUE_SIZE / 2]
-                .value.GetStringData(buffer_manager.get()));
+    auto separator = parent_page->GetKey(0, buffer_manager.get());
+    EXPECT_EQ(child_page->GetHighKey(buffer_manager.get()), separator);
+    EXPECT_EQ(second_child_page->GetLowKey(buffer_manager.get()), separator);
+    EXPECT_LE(pairs[first + child_page->GetCount() - 1].first, separator);
+    EXPECT_LT(separator, pairs[first + child_page->GetCount()].first);
+    EXPECT_TRUE(bplus_tree->TakeFreedPageIds().empty());
+
+    // the right child is underfull next to a sibling which it fits into
+    while (!second_child_page->IsUnderfull()) {
+        second_child_page->Remove(second_child_page->GetCount() - 1);
+        pairs.pop_back();
     }
 
-    EXPECT_EQ(child_page->GetParentPageId(), parent_page->GetPageId());
-    EXPECT_EQ(second_child_page->GetParentPageId(), parent_page->GetPageId());
+    EXPECT_TRUE(bplus_tree
+                    ->BorrowOrMergeChild(parent_page_container, 1,
+                                         second_child_page_container)
+                    .ok());
+    EXPECT_EQ(parent_page->GetCount(), 0);
+    EXPECT_EQ(parent_page->GetChild(0), child_page->GetPageId());
+    EXPECT_EQ(child_page->GetNextPageId(), INVALID_PAGE_ID);
+    EXPECT_EQ(second_child_page->GetPageType(), PageType::PAGE_TYPE_INVALID);
+    EXPECT_EQ(bplus_tree->TakeFreedPageIds(),
+              std::vector<page_id_t>{second_child_page_id});
+
+    auto left_count = child_page->GetCount();
+    EXPECT_EQ(left_count, static_cast<int32_t>(pairs.size()) - first);
+    for (int idx = 0; idx < left_count; idx++) {
+        EXPECT_EQ(child_page->GetKey(idx, buffer_manager.get()),
+                  pairs[first + idx].first);
+        EXPECT_EQ(child_page->GetValue(idx, buffer_manager.get()),
+                  pairs[first + idx].second);
+    }
 }
 
 TEST_F(BplusTreeTest, SplitChildInternalSucceeds) { EXPECT_TRUE(Init().ok()); }
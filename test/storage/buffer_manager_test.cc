@@ -3,10 +3,13 @@
 #include <glog/logging.h>
 #include <gtest/gtest.h>
 
+#include <atomic>
 #include <chrono>
 #include <filesystem>
 #include <memory>
+#include <string>
 #include <thread>
+#include <vector>
 
 #include "absl/strings/string_view.h"
 #include "src/common/config.h"
@@ -14,6 +17,7 @@
 #include "src/storage/disk_manager.h"
 #include "src/storage/log_entry.h"
 #include "src/storage/log_manager.h"
+#include "src/storage/overflow_page.h"
 
 namespace graphchaindb {
 
@@ -176,4 +180,461 @@ TEST_F(BufferManagerTest, PagePersistenceSuccess) {
     }
 }
 
+TEST_F(BufferManagerTest, FlushDirtyPagesWritesOldestFirstSuccess) {
+    EXPECT_TRUE(Init().ok());
+
+    // stay at the low watermark so that the background writer leaves the
+    // pages alone
+    auto count = PAGE_BUFFER_SIZE * FLUSH_LOW_WATERMARK_PERCENT / 100;
+    std::vector<Page*> pages;
+    for (int i = 0; i < count; i++) {
+        auto page_status = buffer_manager->AllocateNewPage();
+        EXPECT_TRUE(page_status.ok());
+        pages.push_back(page_status.value());
+    }
+
+    // make the pages dirty in the reverse order of allocation
+    for (int i = count - 1; i >= 0; i--) {
+        buffer_manager->UnpinPage(pages[i], true);
+        log_manager->SetNextLogNumber(log_manager->GetNextLogNumber() + 1);
+    }
+    EXPECT_EQ(buffer_manager->GetDirtyPageCount(), count);
+
+    auto written_or_status = buffer_manager->FlushDirtyPages(2);
+    EXPECT_TRUE(written_or_status.ok());
+    EXPECT_EQ(written_or_status.value(), 2);
+    EXPECT_EQ(buffer_manager->GetDirtyPageCount(), count - 2);
+    for (int i = 0; i < count; i++) {
+        EXPECT_EQ(pages[i]->GetPageDirty(), i < count - 2);
+    }
+
+    // everything made dirty before the current log number
+    written_or_status = buffer_manager->FlushDirtyPages(
+        0, log_manager->GetNextLogNumber());
+    EXPECT_TRUE(written_or_status.ok());
+    EXPECT_EQ(written_or_status.value(), count - 2);
+    EXPECT_EQ(buffer_manager->GetDirtyPageCount(), 0);
+
+    // clean pages are not written again
+    written_or_status = buffer_manager->FlushDirtyPages(count);
+    EXPECT_TRUE(written_or_status.ok());
+    EXPECT_EQ(written_or_status.value(), 0);
+}
+
+TEST_F(BufferManagerTest, ConcurrentGetPageWithIdSuccess) {
+    EXPECT_TRUE(Init().ok());
+
+    for (int i = 0; i < PAGE_BUFFER_SIZE; i++) {
+        auto page_status = buffer_manager->AllocateNewPage();
+        EXPECT_TRUE(page_status.ok());
+
+        auto page = page_status.value();
+        memcpy(page->GetData(), &i, sizeof(int));
+        buffer_manager->UnpinPage(page, true);
+    }
+
+    // every thread reads all of the pages so that the partitions are accessed
+    // concurrently.
+    std::vector<std::thread> readers;
+    for (int t = 0; t < 4; t++) {
+        readers.emplace_back([&]() {
+            for (int round = 0; round < 100; round++) {
+                for (int i = 0; i < PAGE_BUFFER_SIZE; i++) {
+                    auto page_status = buffer_manager->GetPageWithId(
+                        STARTING_NORMAL_PAGE_ID + i);
+                    EXPECT_TRUE(page_status.ok());
+
+                    auto page = page_status.value();
+                    page->AquireReadLock();
+                    EXPECT_EQ(page->GetPageId(), STARTING_NORMAL_PAGE_ID + i);
+                    EXPECT_EQ(*reinterpret_cast<int*>(page->GetData()), i);
+                    page->ReleaseReadLock();
+
+                    buffer_manager->UnpinPage(page, false);
+                }
+            }
+        });
+    }
+
+    for (auto& reader : readers) {
+        reader.join();
+    }
+}
+
+TEST_F(BufferManagerTest, ConcurrentMissAndEvictionSuccess) {
+    EXPECT_TRUE(Init().ok());
+
+    // twice the pages of the pool so that most of the accesses are misses
+    // which evict a dirty page.
+    int page_count = 2 * PAGE_BUFFER_SIZE;
+    for (int i = 0; i < page_count; i++) {
+        auto page_status = buffer_manager->AllocateNewPage();
+        EXPECT_TRUE(page_status.ok());
+
+        auto page = page_status.value();
+        memcpy(page->GetData(), &i, sizeof(int));
+        buffer_manager->UnpinPage(page, true);
+    }
+
+    std::vector<std::thread> readers;
+    for (int t = 0; t < 4; t++) {
+        readers.emplace_back([&, t]() {
+            for (int round = 0; round < 20; round++) {
+                for (int i = 0; i < page_count; i++) {
+                    // threads walk the pages in different orders so that they
+                    // request the same page at different times.
+                    int idx = (t % 2 == 0) ? i : page_count - 1 - i;
+                    auto page_status = buffer_manager->GetPageWithId(
+                        STARTING_NORMAL_PAGE_ID + idx);
+                    EXPECT_TRUE(page_status.ok());
+
+                    auto page = page_status.value();
+                    page->AquireReadLock();
+                    EXPECT_EQ(page->GetPageId(), STARTING_NORMAL_PAGE_ID + idx);
+                    EXPECT_EQ(*reinterpret_cast<int*>(page->GetData()), idx);
+                    page->ReleaseReadLock();
+
+                    buffer_manager->UnpinPage(page, false);
+                }
+            }
+        });
+    }
+
+    for (auto& reader : readers) {
+        reader.join();
+    }
+}
+
+TEST_F(BufferManagerTest, TwoQueuePolicyEvictionSuccess) {
+    Options options;
+    options.replacement_policy = REPLACEMENT_POLICY_TWO_QUEUE;
+    buffer_manager = std::make_unique<BufferManager>(
+        disk_manager.get(), log_manager.get(), options);
+    EXPECT_TRUE(Init().ok());
+
+    for (int i = 0; i < 3 * PAGE_BUFFER_SIZE; i++) {
+        auto page_status = buffer_manager->AllocateNewPage();
+        EXPECT_TRUE(page_status.ok());
+
+        auto page = page_status.value();
+        memcpy(page->GetData(), &i, sizeof(int));
+        buffer_manager->UnpinPage(page, true);
+    }
+
+    for (int i = 0; i < 3 * PAGE_BUFFER_SIZE; i++) {
+        auto page_status =
+            buffer_manager->GetPageWithId(STARTING_NORMAL_PAGE_ID + i);
+        EXPECT_TRUE(page_status.ok());
+        EXPECT_EQ(*reinterpret_cast<int*>(page_status.value()->GetData()), i);
+        buffer_manager->UnpinPage(page_status.value(), false);
+    }
+}
+
+TEST_F(BufferManagerTest, StatsCountByPageTypeSuccess) {
+    EXPECT_TRUE(Init().ok());
+
+    // the first PAGE_BUFFER_SIZE pages are leaves and the rest internal
+    // pages, which evict all of the leaves
+    for (int i = 0; i < 2 * PAGE_BUFFER_SIZE; i++) {
+        auto page_status = buffer_manager->AllocateNewPage();
+        EXPECT_TRUE(page_status.ok());
+
+        auto page = page_status.value();
+        PageType page_type = i < PAGE_BUFFER_SIZE ? PAGE_TYPE_BPLUS_LEAF
+                                                  : PAGE_TYPE_BPLUS_INTERNAL;
+        memcpy(page->GetData(), &page_type, sizeof(page_type));
+        buffer_manager->UnpinPage(page, true);
+    }
+
+    auto stats = buffer_manager->GetStats();
+    EXPECT_EQ(stats.Get(PAGE_TYPE_BPLUS_LEAF, BUFFER_EVICTION),
+              PAGE_BUFFER_SIZE);
+    // every leaf was written once, either by the background writer or when
+    // it was evicted
+    EXPECT_EQ(stats.Get(PAGE_TYPE_BPLUS_LEAF, BUFFER_WRITE_BACK) +
+                  stats.Get(PAGE_TYPE_BPLUS_LEAF, BUFFER_FLUSH),
+              PAGE_BUFFER_SIZE);
+    EXPECT_EQ(stats.GetTotal(BUFFER_HIT), 0);
+    EXPECT_EQ(stats.GetTotal(BUFFER_MISS), 0);
+
+    // a miss on every leaf, then a hit on every one of them
+    for (int round = 0; round < 2; round++) {
+        for (int i = 0; i < PAGE_BUFFER_SIZE; i++) {
+            auto page_status =
+                buffer_manager->GetPageWithId(STARTING_NORMAL_PAGE_ID + i);
+            EXPECT_TRUE(page_status.ok());
+            buffer_manager->UnpinPage(page_status.value(), false);
+        }
+    }
+
+    stats = buffer_manager->GetStats();
+    EXPECT_EQ(stats.Get(PAGE_TYPE_BPLUS_LEAF, BUFFER_MISS), PAGE_BUFFER_SIZE);
+    EXPECT_EQ(stats.Get(PAGE_TYPE_BPLUS_LEAF, BUFFER_HIT), PAGE_BUFFER_SIZE);
+    EXPECT_EQ(stats.Get(PAGE_TYPE_BPLUS_INTERNAL, BUFFER_EVICTION),
+              PAGE_BUFFER_SIZE);
+    EXPECT_DOUBLE_EQ(stats.GetHitRatio(PAGE_TYPE_BPLUS_LEAF), 0.5);
+    EXPECT_DOUBLE_EQ(stats.GetHitRatio(PAGE_TYPE_OVERFLOW), 0);
+
+    // the internal pages were written too
+    EXPECT_EQ(stats.GetTotal(BUFFER_WRITE_BACK) + stats.GetTotal(BUFFER_FLUSH),
+              2 * PAGE_BUFFER_SIZE);
+    EXPECT_EQ(stats.GetTotal(BUFFER_EVICTION_FAILURE), 0);
+}
+
+TEST_F(BufferManagerTest, ConcurrentOverflowPageReuseSuccess) {
+    EXPECT_TRUE(Init().ok());
+
+    constexpr int string_length = 200;
+    constexpr int strings_per_thread = 50;
+    constexpr int thread_count = 4;
+
+    // (page id, offset) of every string, written by its thread only
+    std::vector<std::vector<std::pair<page_id_t, int32_t>>> locations(
+        thread_count);
+    std::vector<std::thread> writers;
+    for (int t = 0; t < thread_count; t++) {
+        writers.emplace_back([&, t]() {
+            std::string value(string_length, 'a' + t);
+            for (int i = 0; i < strings_per_thread; i++) {
+                auto page_status =
+                    buffer_manager->GetOverflowPageWithCapacity(string_length);
+                EXPECT_TRUE(page_status.ok());
+
+                auto page = page_status.value();
+                auto overflow_page =
+                    reinterpret_cast<OverflowPage*>(page->GetData());
+                auto offset = overflow_page->NextSlot();
+                EXPECT_TRUE(overflow_page->SetDataAtOffset(offset, value).ok());
+                locations[t].emplace_back(page->GetPageId(), offset);
+
+                buffer_manager->UnpinPage(page, true);
+                page->ReleaseExclusiveLock();
+            }
+        });
+    }
+
+    for (auto& writer : writers) {
+        writer.join();
+    }
+
+    for (int t = 0; t < thread_count; t++) {
+        std::string value(string_length, 'a' + t);
+        for (auto [page_id, offset] : locations[t]) {
+            auto page_status = buffer_manager->GetPageWithId(page_id);
+            EXPECT_TRUE(page_status.ok());
+
+            auto page = page_status.value();
+            page->AquireReadLock();
+            auto overflow_page =
+                reinterpret_cast<OverflowPage*>(page->GetData());
+            EXPECT_EQ(overflow_page->GetStringAtOffset(offset), value);
+            page->ReleaseReadLock();
+            buffer_manager->UnpinPage(page, false);
+        }
+    }
+
+    // the pages are filled up before new ones are allocated
+    int strings_per_page =
+        OverflowPage::DATA_SIZE / (string_length + sizeof(int32_t));
+    int pages_needed =
+        (thread_count * strings_per_thread + strings_per_page - 1) /
+        strings_per_page;
+    auto next_page_status = buffer_manager->AllocateNewPage();
+    EXPECT_TRUE(next_page_status.ok());
+    EXPECT_LE(next_page_status.value()->GetPageId() - STARTING_NORMAL_PAGE_ID,
+              2 * pages_needed);
+}
+
+TEST_F(BufferManagerTest, ConcurrentPinUnpinLeavesPageEvictableSuccess) {
+    EXPECT_TRUE(Init().ok());
+
+    auto page_status = buffer_manager->AllocateNewPage();
+    EXPECT_TRUE(page_status.ok());
+    auto page_id = page_status.value()->GetPageId();
+    buffer_manager->UnpinPage(page_status.value(), false);
+
+    // every thread holds a few pins at a time on the same page
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 8; t++) {
+        threads.emplace_back([&]() {
+            for (int round = 0; round < 200; round++) {
+                Page* pages[3];
+                for (auto& page : pages) {
+                    auto status = buffer_manager->GetPageWithId(page_id);
+                    EXPECT_TRUE(status.ok());
+                    page = status.value();
+                }
+                for (auto page : pages) {
+                    buffer_manager->UnpinPage(page, false);
+                }
+            }
+        });
+    }
+
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    // all of the pins are gone, so the page can be evicted to make room
+    for (int i = 0; i < PAGE_BUFFER_SIZE; i++) {
+        auto status = buffer_manager->AllocateNewPage();
+        EXPECT_TRUE(status.ok());
+    }
+    EXPECT_EQ(buffer_manager->GetPageForOptimisticRead(page_id), nullptr);
+}
+
+TEST_F(BufferManagerTest, SwizzledChildReferenceSuccess) {
+    EXPECT_TRUE(Init().ok());
+
+    auto parent_status = buffer_manager->AllocateNewPage();
+    EXPECT_TRUE(parent_status.ok());
+    auto parent = parent_status.value();
+
+    auto child_status = buffer_manager->AllocateNewPage();
+    EXPECT_TRUE(child_status.ok());
+    auto child_page_id = child_status.value()->GetPageId();
+    buffer_manager->UnpinPage(child_status.value(), false);
+
+    // the first request swizzles the reference and the second one uses it
+    for (int i = 0; i < 2; i++) {
+        auto status = buffer_manager->GetChildPage(parent, 3, child_page_id);
+        EXPECT_TRUE(status.ok());
+        EXPECT_EQ(status.value(), child_status.value());
+        buffer_manager->UnpinPage(status.value(), false);
+    }
+    EXPECT_EQ(buffer_manager->GetStats().GetTotal(BUFFER_SWIZZLED_HIT), 1);
+    EXPECT_EQ(buffer_manager->GetChildPageForOptimisticRead(parent, 3,
+                                                            child_page_id),
+              child_status.value());
+    EXPECT_EQ(buffer_manager->GetStats().GetTotal(BUFFER_SWIZZLED_HIT), 2);
+
+    // evict the child, but not the pinned parent
+    for (int i = 0; i < PAGE_BUFFER_SIZE; i++) {
+        auto status = buffer_manager->AllocateNewPage();
+        EXPECT_TRUE(status.ok());
+        buffer_manager->UnpinPage(status.value(), false);
+    }
+    EXPECT_EQ(buffer_manager->GetPageForOptimisticRead(child_page_id),
+              nullptr);
+
+    // the stale reference is noticed and swizzled again
+    auto misses = buffer_manager->GetStats().GetTotal(BUFFER_MISS);
+    for (int i = 0; i < 2; i++) {
+        auto status = buffer_manager->GetChildPage(parent, 3, child_page_id);
+        EXPECT_TRUE(status.ok());
+        EXPECT_EQ(status.value()->GetPageId(), child_page_id);
+        buffer_manager->UnpinPage(status.value(), false);
+    }
+    auto stats = buffer_manager->GetStats();
+    EXPECT_EQ(stats.GetTotal(BUFFER_MISS), misses + 1);
+    EXPECT_EQ(stats.GetTotal(BUFFER_SWIZZLED_HIT), 3);
+
+    buffer_manager->UnpinPage(parent, false);
+}
+
+TEST_F(BufferManagerTest, ConcurrentSwizzledChildAndEvictionSuccess) {
+    EXPECT_TRUE(Init().ok());
+
+    constexpr int child_count = 8;
+    constexpr int marker_offset = 64;
+
+    auto parent_status = buffer_manager->AllocateNewPage();
+    EXPECT_TRUE(parent_status.ok());
+    auto parent = parent_status.value();
+
+    // every child holds its own id
+    page_id_t child_page_ids[child_count];
+    for (auto& child_page_id : child_page_ids) {
+        auto status = buffer_manager->AllocateNewPage();
+        EXPECT_TRUE(status.ok());
+        auto page = status.value();
+        child_page_id = page->GetPageId();
+        page->AquireExclusiveLock();
+        memcpy(page->GetData() + marker_offset, &child_page_id,
+               sizeof(child_page_id));
+        buffer_manager->UnpinPage(page, true);
+        page->ReleaseExclusiveLock();
+    }
+
+    // readers follow the references while new pages evict the children
+    std::atomic<bool> done{false};
+    std::vector<std::thread> readers;
+    for (int t = 0; t < 4; t++) {
+        readers.emplace_back([&, t]() {
+            for (int i = 0; i < 500; i++) {
+                int slot = (i + t) % child_count;
+                auto status = buffer_manager->GetChildPage(
+                    parent, slot, child_page_ids[slot]);
+                EXPECT_TRUE(status.ok());
+
+                auto page = status.value();
+                page->AquireReadLock();
+                page_id_t marker = INVALID_PAGE_ID;
+                memcpy(&marker, page->GetData() + marker_offset,
+                       sizeof(marker));
+                EXPECT_EQ(page->GetPageId(), child_page_ids[slot]);
+                EXPECT_EQ(marker, child_page_ids[slot]);
+                page->ReleaseReadLock();
+                buffer_manager->UnpinPage(page, false);
+            }
+        });
+    }
+
+    std::thread allocator([&]() {
+        while (!done) {
+            auto status = buffer_manager->AllocateNewPage();
+            EXPECT_TRUE(status.ok());
+            buffer_manager->UnpinPage(status.value(), false);
+        }
+    });
+
+    for (auto& reader : readers) {
+        reader.join();
+    }
+    done = true;
+    allocator.join();
+
+    buffer_manager->UnpinPage(parent, false);
+}
+
+TEST_F(BufferManagerTest, CompressedCacheServesMissSuccess) {
+    Options options;
+    options.compressed_cache_size = PAGE_BUFFER_SIZE * PAGE_SIZE;
+    buffer_manager = std::make_unique<BufferManager>(
+        disk_manager.get(), log_manager.get(), options);
+    EXPECT_TRUE(Init().ok());
+
+    // evict the first PAGE_BUFFER_SIZE pages, written back or clean
+    for (int i = 0; i < 2 * PAGE_BUFFER_SIZE; i++) {
+        auto page_status = buffer_manager->AllocateNewPage();
+        EXPECT_TRUE(page_status.ok());
+
+        auto page = page_status.value();
+        PageType page_type = PAGE_TYPE_BPLUS_LEAF;
+        memcpy(page->GetData(), &page_type, sizeof(page_type));
+        memcpy(page->GetData() + PAGE_SIZE / 2, &i, sizeof(i));
+        buffer_manager->UnpinPage(page, true);
+        if (i % 2 == 0) {
+            EXPECT_TRUE(buffer_manager->FlushDirtyPages(1).ok());
+        }
+    }
+
+    for (int i = 0; i < PAGE_BUFFER_SIZE; i++) {
+        auto page_status =
+            buffer_manager->GetPageWithId(STARTING_NORMAL_PAGE_ID + i);
+        EXPECT_TRUE(page_status.ok());
+
+        int value = -1;
+        memcpy(&value, page_status.value()->GetData() + PAGE_SIZE / 2,
+               sizeof(value));
+        EXPECT_EQ(value, i);
+        buffer_manager->UnpinPage(page_status.value(), false);
+    }
+
+    auto stats = buffer_manager->GetStats();
+    EXPECT_EQ(stats.Get(PAGE_TYPE_BPLUS_LEAF, BUFFER_MISS), PAGE_BUFFER_SIZE);
+    EXPECT_EQ(stats.Get(PAGE_TYPE_BPLUS_LEAF, BUFFER_COMPRESSED_HIT),
+              PAGE_BUFFER_SIZE);
+}
+
 }  // namespace graphchaindb
@@ -0,0 +1,58 @@
+#include "src/storage/clock_replacement_policy.h"
+
+#include <glog/logging.h>
+#include <gtest/gtest.h>
+
+#include <memory>
+
+namespace graphchaindb {
+
+TEST(ClockReplacementPolicyTest, EvictsUnreferencedBeforeReferenced) {
+    auto policy = std::make_unique<ClockReplacementPolicy>(4);
+    for (int i = 0; i < 4; i++) {
+        policy->RecordInsert(i, i);
+    }
+
+    // the first sweep clears the reference bits set by the inserts, so the
+    // frames are evicted in clock order.
+    auto victim = policy->Evict([](int) { return true; });
+    EXPECT_TRUE(victim.ok());
+    EXPECT_EQ(victim.value(), 0);
+
+    // frame 1 is referenced after its bit was cleared and gets a second
+    // chance.
+    policy->RecordAccess(1);
+    victim = policy->Evict([](int) { return true; });
+    EXPECT_TRUE(victim.ok());
+    EXPECT_EQ(victim.value(), 2);
+}
+
+TEST(ClockReplacementPolicyTest, SkipsFramesWhichAreNotEvictable) {
+    auto policy = std::make_unique<ClockReplacementPolicy>(4);
+    for (int i = 0; i < 4; i++) {
+        policy->RecordInsert(i, i);
+    }
+
+    // only the last frame of the sweep is evictable. It has to be found even
+    // though its reference bit is set.
+    auto victim =
+        policy->Evict([](int frame_index) { return frame_index == 3; });
+    EXPECT_TRUE(victim.ok());
+    EXPECT_EQ(victim.value(), 3);
+}
+
+TEST(ClockReplacementPolicyTest, EvictFailsWhenNothingIsEvictable) {
+    auto policy = std::make_unique<ClockReplacementPolicy>(4);
+    for (int i = 0; i < 4; i++) {
+        policy->RecordInsert(i, i);
+    }
+
+    EXPECT_FALSE(policy->Evict([](int) { return false; }).ok());
+
+    policy->Remove(0);
+    policy->Remove(1);
+    EXPECT_FALSE(
+        policy->Evict([](int frame_index) { return frame_index < 2; }).ok());
+}
+
+}  // namespace graphchaindb
@@ -0,0 +1,77 @@
+#include "src/storage/compressed_page_cache.h"
+
+#include <gtest/gtest.h>
+
+#include <cstring>
+#include <string>
+
+#include "src/common/config.h"
+
+namespace graphchaindb {
+
+TEST(CompressedPageCacheTest, CompressDecompressRoundTripSucceeds) {
+    char data[PAGE_SIZE] = {};
+    char decompressed[PAGE_SIZE];
+    std::string compressed;
+
+    // an empty page
+    EXPECT_TRUE(CompressPage(data, &compressed));
+    EXPECT_LT(compressed.size(), 8);
+    EXPECT_TRUE(DecompressPage(compressed, decompressed));
+    EXPECT_EQ(memcmp(data, decompressed, PAGE_SIZE), 0);
+
+    // strings in fixed size slots with short zero runs in between, and data
+    // right at the end
+    for (int i = 0; i < PAGE_SIZE; i += STRING_CONTAINER_SIZE) {
+        memset(data + i, 'a' + i % 26, i % STRING_CONTAINER_SIZE + 3);
+        data[i + 5] = 0;
+    }
+    data[PAGE_SIZE - 1] = 'z';
+    EXPECT_TRUE(CompressPage(data, &compressed));
+    EXPECT_LT(compressed.size(), PAGE_SIZE / 2);
+    EXPECT_TRUE(DecompressPage(compressed, decompressed));
+    EXPECT_EQ(memcmp(data, decompressed, PAGE_SIZE), 0);
+}
+
+TEST(CompressedPageCacheTest, IncompressiblePageFails) {
+    char data[PAGE_SIZE];
+    for (int i = 0; i < PAGE_SIZE; i++) {
+        data[i] = 1 + i % 255;
+    }
+
+    std::string compressed;
+    EXPECT_FALSE(CompressPage(data, &compressed));
+    EXPECT_FALSE(DecompressPage(compressed.substr(0, 3), data));
+
+    CompressedPageCache cache(2 * PAGE_SIZE);
+    EXPECT_FALSE(cache.Insert(STARTING_NORMAL_PAGE_ID, data));
+    EXPECT_EQ(cache.GetPageCount(), 0);
+}
+
+TEST(CompressedPageCacheTest, TakeAndCapacitySucceeds) {
+    char data[PAGE_SIZE] = {};
+    data[0] = 1;
+    std::string compressed;
+    EXPECT_TRUE(CompressPage(data, &compressed));
+
+    // room for three pages
+    CompressedPageCache cache(3 * compressed.size());
+    for (int i = 0; i < 4; i++) {
+        data[0] = i + 1;
+        EXPECT_TRUE(cache.Insert(STARTING_NORMAL_PAGE_ID + i, data));
+    }
+    EXPECT_EQ(cache.GetPageCount(), 3);
+    EXPECT_EQ(cache.GetSize(), 3 * compressed.size());
+
+    // the first page was dropped, the others are taken out once
+    EXPECT_FALSE(cache.Take(STARTING_NORMAL_PAGE_ID, data));
+    for (int i = 1; i < 4; i++) {
+        EXPECT_TRUE(cache.Take(STARTING_NORMAL_PAGE_ID + i, data));
+        EXPECT_EQ(data[0], i + 1);
+        EXPECT_FALSE(cache.Take(STARTING_NORMAL_PAGE_ID + i, data));
+    }
+    EXPECT_EQ(cache.GetPageCount(), 0);
+    EXPECT_EQ(cache.GetSize(), 0);
+}
+
+}  // namespace graphchaindb
@@ -32,6 +32,19 @@ TEST_F(DiskManagerTest, CreateDBFilesSuccessWithNonExistentDB) {
     EXPECT_TRUE(disk_manager->CreateDBFilesAndLoadDB().ok());
 }
 
+TEST_F(DiskManagerTest, LoadDbWithoutFreeSpaceMapFails) {
+    EXPECT_TRUE(disk_manager->CreateDBFilesAndLoadDB().ok());
+
+    // a file of the older format has a B+ tree page at the same id
+    auto data = std::make_unique<char[]>(PAGE_SIZE);
+    memset(data.get(), 0, PAGE_SIZE);
+    EXPECT_TRUE(
+        disk_manager->WritePage(FREE_SPACE_MAP_PAGE_ID, data.get()).ok());
+
+    disk_manager = std::make_unique<DiskManager>(TEST_DB_PATH);
+    EXPECT_TRUE(absl::IsFailedPrecondition(disk_manager->LoadDB().status()));
+}
+
 TEST_F(DiskManagerTest, WriteAndReadDeleteLogEntrySucceeds) {
     EXPECT_TRUE(disk_manager->CreateDBFilesAndLoadDB().ok());
 
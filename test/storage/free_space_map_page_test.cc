@@ -0,0 +1,69 @@
+#include "src/storage/free_space_map_page.h"
+
+#include <glog/logging.h>
+#include <gtest/gtest.h>
+
+#include <memory>
+
+#include "src/common/config.h"
+
+namespace graphchaindb {
+
+TEST(FreeSpaceMapPageTest, AllocateFromPageWithEnoughSpaceSuccess) {
+    auto free_space_map = std::make_unique<FreeSpaceMapPage>();
+    free_space_map->InitPage(FREE_SPACE_MAP_PAGE_ID);
+
+    EXPECT_EQ(free_space_map->Allocate(100), FreeSpaceMapPage::NO_ENTRY);
+
+    int small = free_space_map->Add(2, 2 * FREE_SPACE_CLASS_SIZE);
+    int large = free_space_map->Add(3, 10 * FREE_SPACE_CLASS_SIZE);
+    EXPECT_EQ(free_space_map->GetCount(), 2);
+
+    // only the large page is guaranteed to have enough space
+    EXPECT_EQ(free_space_map->Allocate(3 * FREE_SPACE_CLASS_SIZE), large);
+    EXPECT_EQ(free_space_map->GetEntryFreeSpace(large),
+              7 * FREE_SPACE_CLASS_SIZE);
+
+    EXPECT_EQ(free_space_map->Allocate(FREE_SPACE_CLASS_SIZE / 2), small);
+    EXPECT_EQ(free_space_map->GetEntryPageId(small), 2);
+    EXPECT_EQ(free_space_map->GetEntryFreeSpace(small),
+              2 * FREE_SPACE_CLASS_SIZE - FREE_SPACE_CLASS_SIZE / 2);
+
+    EXPECT_EQ(free_space_map->Allocate(8 * FREE_SPACE_CLASS_SIZE),
+              FreeSpaceMapPage::NO_ENTRY);
+}
+
+TEST(FreeSpaceMapPageTest, SetFreeSpaceMovesEntrySuccess) {
+    auto free_space_map = std::make_unique<FreeSpaceMapPage>();
+    free_space_map->InitPage(FREE_SPACE_MAP_PAGE_ID);
+
+    for (int i = 0; i < 5; i++) {
+        free_space_map->Add(STARTING_NORMAL_PAGE_ID + i,
+                            4 * FREE_SPACE_CLASS_SIZE);
+    }
+
+    // shrink the entry in the middle of the list, the others stay
+    free_space_map->SetFreeSpace(2, 0);
+    for (int i = 0; i < 4; i++) {
+        int entry = free_space_map->Allocate(4 * FREE_SPACE_CLASS_SIZE);
+        EXPECT_NE(entry, FreeSpaceMapPage::NO_ENTRY);
+        EXPECT_NE(entry, 2);
+    }
+    EXPECT_EQ(free_space_map->Allocate(1), FreeSpaceMapPage::NO_ENTRY);
+
+    free_space_map->SetFreeSpace(2, PAGE_SIZE / 2);
+    EXPECT_EQ(free_space_map->Allocate(1), 2);
+}
+
+TEST(FreeSpaceMapPageTest, AddToFullMapFails) {
+    auto free_space_map = std::make_unique<FreeSpaceMapPage>();
+    free_space_map->InitPage(FREE_SPACE_MAP_PAGE_ID);
+
+    for (int i = 0; i < FreeSpaceMapPage::MAX_ENTRIES; i++) {
+        EXPECT_EQ(free_space_map->Add(STARTING_NORMAL_PAGE_ID + i, 0), i);
+    }
+    EXPECT_EQ(free_space_map->Add(STARTING_NORMAL_PAGE_ID, 0),
+              FreeSpaceMapPage::NO_ENTRY);
+}
+
+}  // namespace graphchaindb
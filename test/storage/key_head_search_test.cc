@@ -0,0 +1,64 @@
+#include "src/storage/key_head_search.h"
+
+#include <glog/logging.h>
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+namespace graphchaindb {
+
+static constexpr KeyHeadSearchType KEY_HEAD_SEARCH_TYPES[] = {
+    KeyHeadSearchType::SCALAR, KeyHeadSearchType::SSE42,
+    KeyHeadSearchType::AVX2, KeyHeadSearchType::NEON};
+
+TEST(KeyHeadSearchTest, SelectedTypeIsSupported) {
+    EXPECT_TRUE(IsKeyHeadSearchSupported(KeyHeadSearchType::SCALAR));
+    EXPECT_TRUE(IsKeyHeadSearchSupported(GetKeyHeadSearchType()));
+}
+
+TEST(KeyHeadSearchTest, AllTypesFindEqualRangeSucceeds) {
+    std::mt19937 generator(42);
+
+    // few distinct heads for duplicates, and heads with the top bit set which
+    // are negative as signed integers
+    std::vector<uint32_t> distinct_heads = {0, 1, 0x7fffffff, 0x80000000,
+                                            0x80000001, 0xfffffffe, 0xffffffff};
+    std::uniform_int_distribution<int> distribution(
+        0, distinct_heads.size() - 1);
+
+    for (int count = 0; count <= 200; count++) {
+        std::vector<uint32_t> key_heads;
+        for (int i = 0; i < count; i++) {
+            key_heads.push_back(distinct_heads[distribution(generator)]);
+        }
+        std::sort(key_heads.begin(), key_heads.end());
+
+        for (auto key_head : {0u, 1u, 2u, 0x7fffffffu, 0x80000000u,
+                              0x90000000u, 0xffffffffu}) {
+            auto expected_lower =
+                std::lower_bound(key_heads.begin(), key_heads.end(),
+                                 key_head) -
+                key_heads.begin();
+            auto expected_upper =
+                std::upper_bound(key_heads.begin(), key_heads.end(),
+                                 key_head) -
+                key_heads.begin();
+
+            for (auto type : KEY_HEAD_SEARCH_TYPES) {
+                if (!IsKeyHeadSearchSupported(type)) {
+                    continue;
+                }
+
+                auto range =
+                    SearchKeyHeads(type, key_heads.data(), count, key_head);
+                EXPECT_EQ(expected_lower, range.lower);
+                EXPECT_EQ(expected_upper, range.upper);
+            }
+        }
+    }
+}
+
+}  // namespace graphchaindb
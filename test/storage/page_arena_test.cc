@@ -0,0 +1,46 @@
+#include "src/storage/page_arena.h"
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <cstring>
+
+namespace graphchaindb {
+
+TEST(PageArenaTest, PagesAreAlignedAndZeroedSucceeds) {
+    PageArena arena(PAGE_BUFFER_SIZE);
+    EXPECT_EQ(arena.GetNumPages(), PAGE_BUFFER_SIZE);
+
+    for (int i = 0; i < PAGE_BUFFER_SIZE; i++) {
+        char* data = arena.GetPageData(i);
+        EXPECT_EQ(reinterpret_cast<uintptr_t>(data) % PAGE_SIZE, 0);
+        for (int j = 0; j < PAGE_SIZE; j++) {
+            ASSERT_EQ(data[j], 0);
+        }
+    }
+}
+
+TEST(PageArenaTest, PagesDontOverlapSucceeds) {
+    PageArena arena(PAGE_BUFFER_SIZE);
+
+    for (int i = 0; i < PAGE_BUFFER_SIZE; i++) {
+        memset(arena.GetPageData(i), i, PAGE_SIZE);
+    }
+    for (int i = 0; i < PAGE_BUFFER_SIZE; i++) {
+        char* data = arena.GetPageData(i);
+        EXPECT_EQ(data[0], static_cast<char>(i));
+        EXPECT_EQ(data[PAGE_SIZE - 1], static_cast<char>(i));
+    }
+}
+
+TEST(PageArenaTest, HugeArenaSucceeds) {
+    // spans multiple huge pages so MAP_HUGETLB is tried, with or without
+    // reserved huge pages the arena must be usable
+    int num_pages = 2 * HUGE_PAGE_SIZE / PAGE_SIZE + 1;
+    PageArena arena(num_pages);
+
+    memset(arena.GetPageData(num_pages - 1), 1, PAGE_SIZE);
+    EXPECT_EQ(arena.GetPageData(num_pages - 1)[PAGE_SIZE - 1], 1);
+}
+
+}  // namespace graphchaindb
@@ -0,0 +1,71 @@
+#include "src/storage/page.h"
+
+#include <gtest/gtest.h>
+
+#include <cstring>
+
+namespace graphchaindb {
+
+TEST(PageTest, OptimisticReadSucceedsWithoutWriters) {
+    char data[PAGE_SIZE];
+    Page page(data);
+    uint64_t version;
+    EXPECT_TRUE(page.StartOptimisticRead(&version));
+
+    // readers don't change the version
+    page.AquireReadLock();
+    page.ReleaseReadLock();
+
+    EXPECT_TRUE(page.ValidateOptimisticRead(version));
+}
+
+TEST(PageTest, OptimisticReadFailsWhileExclusivelyLocked) {
+    char data[PAGE_SIZE];
+    Page page(data);
+    uint64_t version;
+
+    page.AquireExclusiveLock();
+    EXPECT_FALSE(page.StartOptimisticRead(&version));
+    page.ReleaseExclusiveLock();
+
+    EXPECT_TRUE(page.StartOptimisticRead(&version));
+}
+
+TEST(PageTest, OptimisticReadFailsAfterWrite) {
+    char data[PAGE_SIZE];
+    Page page(data);
+    uint64_t version;
+    EXPECT_TRUE(page.StartOptimisticRead(&version));
+
+    page.AquireExclusiveLock();
+    memset(page.GetData(), 1, PAGE_SIZE);
+    page.ReleaseExclusiveLock();
+
+    EXPECT_FALSE(page.ValidateOptimisticRead(version));
+}
+
+TEST(PageTest, UpgradeOptimisticReadFailsAfterWrite) {
+    char data[PAGE_SIZE];
+    Page page(data);
+
+    uint64_t stale_version;
+    EXPECT_TRUE(page.StartOptimisticRead(&stale_version));
+    EXPECT_TRUE(page.UpgradeOptimisticRead(stale_version));
+
+    uint64_t version;
+    EXPECT_FALSE(page.StartOptimisticRead(&version));
+    page.ReleaseExclusiveLock();
+
+    // the release changed the version of the earlier read
+    EXPECT_TRUE(page.StartOptimisticRead(&version));
+    EXPECT_NE(version, stale_version);
+    EXPECT_FALSE(page.UpgradeOptimisticRead(stale_version));
+    EXPECT_TRUE(page.ValidateOptimisticRead(version));
+}
+
+TEST(PageTest, MetadataIsCacheLineAlignedSucceeds) {
+    EXPECT_EQ(alignof(Page) % CACHE_LINE_SIZE, 0);
+    EXPECT_EQ(sizeof(Page) % CACHE_LINE_SIZE, 0);
+}
+
+}  // namespace graphchaindb
@@ -0,0 +1,126 @@
+#include "src/storage/readahead.h"
+
+#include <glog/logging.h>
+#include <gtest/gtest.h>
+
+#include <filesystem>
+#include <memory>
+#include <vector>
+
+#include "src/common/config.h"
+#include "src/common/test_utils.h"
+#include "src/storage/bplus_tree_page_leaf.h"
+#include "src/storage/buffer_manager.h"
+#include "src/storage/disk_manager.h"
+#include "src/storage/log_manager.h"
+
+namespace graphchaindb {
+
+class ReadaheadTest : public ::testing::Test {
+   protected:
+    ReadaheadTest() {
+        std::filesystem::remove(
+            std::string{TEST_DB_PATH.data(), TEST_DB_PATH.size()} + ".db");
+        std::filesystem::remove(
+            std::string{TEST_DB_PATH.data(), TEST_DB_PATH.size()} + ".log");
+        disk_manager = std::make_unique<DiskManager>(TEST_DB_PATH);
+        log_manager = std::make_unique<LogManager>(disk_manager.get());
+        buffer_manager = std::make_unique<BufferManager>(disk_manager.get(),
+                                                         log_manager.get());
+        readahead = std::make_unique<Readahead>(buffer_manager.get());
+    }
+
+    absl::Status Init() {
+        auto s = disk_manager->CreateDBFilesAndLoadDB();
+        if (!s.ok()) {
+            return s.status();
+        }
+
+        log_manager->SetNextLogNumber(STARTING_LOG_NUMBER);
+
+        return buffer_manager->Init(STARTING_NORMAL_PAGE_ID);
+    }
+
+    // Allocate a chain of count linked leaves and return their ids
+    std::vector<page_id_t> CreateLeafChain(int count) {
+        std::vector<page_id_t> page_ids;
+        Page* previous_page_container = nullptr;
+        for (int i = 0; i < count; i++) {
+            auto page_container = buffer_manager->AllocateNewPage().value();
+            page_container->AquireExclusiveLock();
+
+            auto leaf_page = reinterpret_cast<BplusTreeLeafPage*>(
+                page_container->GetData());
+            leaf_page->InitPage(page_container->GetPageId(),
+                                PageType::PAGE_TYPE_BPLUS_LEAF,
+                                INVALID_PAGE_ID);
+
+            if (previous_page_container != nullptr) {
+                reinterpret_cast<BplusTreeLeafPage*>(
+                    previous_page_container->GetData())
+                    ->SetNextPageId(page_container->GetPageId());
+
+                buffer_manager->UnpinPage(previous_page_container,
+                                          /* is_dirty */ true);
+                previous_page_container->ReleaseExclusiveLock();
+            }
+
+            page_ids.push_back(page_container->GetPageId());
+            previous_page_container = page_container;
+        }
+
+        buffer_manager->UnpinPage(previous_page_container, /* is_dirty */ true);
+        previous_page_container->ReleaseExclusiveLock();
+        return page_ids;
+    }
+
+    std::unique_ptr<DiskManager> disk_manager;
+    std::unique_ptr<LogManager> log_manager;
+    std::unique_ptr<BufferManager> buffer_manager;
+    std::unique_ptr<Readahead> readahead;
+};
+
+TEST_F(ReadaheadTest, RandomAccessDoesNotPrefetch) {
+    EXPECT_TRUE(Init().ok());
+    auto page_ids = CreateLeafChain(10);
+    readahead->Start();
+
+    for (int i = 0; i < 10; i += 3) {
+        auto next_page_id = i + 1 < 10 ? page_ids[i + 1] : INVALID_PAGE_ID;
+        readahead->RecordLeafAccess(page_ids[i], next_page_id);
+    }
+
+    readahead->WaitUntilIdle();
+    EXPECT_EQ(readahead->GetPrefetchedPageCount(), 0);
+}
+
+TEST_F(ReadaheadTest, SequentialAccessPrefetchesAhead) {
+    EXPECT_TRUE(Init().ok());
+    auto count = 2 * PAGE_BUFFER_SIZE;
+    auto page_ids = CreateLeafChain(count);
+    readahead->Start();
+
+    for (int i = 0; i < count; i++) {
+        auto next_page_id = i + 1 < count ? page_ids[i + 1] : INVALID_PAGE_ID;
+        readahead->RecordLeafAccess(page_ids[i], next_page_id);
+        readahead->WaitUntilIdle();
+    }
+
+    // everything after the first two leaves which confirm the scan is read
+    // ahead, and nothing past the end of the chain
+    EXPECT_EQ(readahead->GetPrefetchedPageCount(), count - 2);
+}
+
+TEST_F(ReadaheadTest, SequentialHintPrefetchesRightAway) {
+    EXPECT_TRUE(Init().ok());
+    auto page_ids = CreateLeafChain(10);
+    readahead->Start();
+
+    readahead->RecordLeafAccess(page_ids[0], page_ids[1],
+                                /* sequential_hint */ true);
+    readahead->WaitUntilIdle();
+
+    EXPECT_EQ(readahead->GetPrefetchedPageCount(), READAHEAD_INITIAL_WINDOW);
+}
+
+}  // namespace graphchaindb
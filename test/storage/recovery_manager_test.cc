@@ -96,6 +96,23 @@ TEST_F(RecoveryManagerTest, RecoverSuccess) {
     EXPECT_EQ(index_root_page_id, 11);
 }
 
+TEST_F(RecoveryManagerTest, RecoverBulkLoadSuccess) {
+    EXPECT_TRUE(Init().ok());
+    EXPECT_TRUE(InsertDummyData().ok());
+
+    // a bulk load sets both the root and the next page id
+    auto entry = log_manager->PrepareLogEntry(BULK_LOAD_KEY, "20 57").value();
+    log_manager->WriteLogEntry(entry);
+
+    auto index_root_page_id = INVALID_PAGE_ID;
+    auto next_page_id_status = recovery_manager->Recover(index_root_page_id);
+    EXPECT_TRUE(next_page_id_status.ok());
+
+    EXPECT_EQ(next_page_id_status.value(), 57);
+
+    EXPECT_EQ(index_root_page_id, 20);
+}
+
 TEST_F(RecoveryManagerTest, RecoverDeleteAfterSetSuccess) {
     EXPECT_TRUE(Init().ok());
     EXPECT_TRUE(InsertDummyData().ok());
@@ -42,6 +42,7 @@ class StringContainerTest : public ::testing::Test {
         }
 
         log_manager->SetNextLogNumber(1);
+        return absl::OkStatus();
     }
 
     std::unique_ptr<DiskManager> disk_manager;
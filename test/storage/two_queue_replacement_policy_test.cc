@@ -0,0 +1,80 @@
+#include "src/storage/two_queue_replacement_policy.h"
+
+#include <glog/logging.h>
+#include <gtest/gtest.h>
+
+#include <memory>
+
+namespace graphchaindb {
+
+TEST(TwoQueueReplacementPolicyTest, EvictsFirstTimePagesInFifoOrder) {
+    auto policy = std::make_unique<TwoQueueReplacementPolicy>(8);
+    for (int i = 0; i < 8; i++) {
+        policy->RecordInsert(i, 100 + i);
+        policy->RecordAccess(i);
+    }
+
+    for (int i = 0; i < 8; i++) {
+        auto victim = policy->Evict([](int) { return true; });
+        EXPECT_TRUE(victim.ok());
+        EXPECT_EQ(victim.value(), i);
+    }
+
+    EXPECT_FALSE(policy->Evict([](int) { return true; }).ok());
+}
+
+TEST(TwoQueueReplacementPolicyTest, ScanDoesNotEvictHotPages) {
+    auto policy = std::make_unique<TwoQueueReplacementPolicy>(8);
+
+    // page 100 is read, evicted and read again, which makes it hot.
+    policy->RecordInsert(0, 100);
+    EXPECT_EQ(policy->Evict([](int) { return true; }).value(), 0);
+    policy->RecordInsert(0, 100);
+
+    // a scan over many pages reuses the other frames and never frame 0.
+    for (int i = 1; i < 8; i++) {
+        policy->RecordInsert(i, 200 + i);
+    }
+    for (page_id_t page_id = 300; page_id < 400; page_id++) {
+        auto victim = policy->Evict([](int) { return true; });
+        EXPECT_TRUE(victim.ok());
+        EXPECT_NE(victim.value(), 0);
+        policy->RecordInsert(victim.value(), page_id);
+    }
+}
+
+TEST(TwoQueueReplacementPolicyTest, RestoredPageStaysCold) {
+    auto policy = std::make_unique<TwoQueueReplacementPolicy>(4);
+    for (int i = 0; i < 4; i++) {
+        policy->RecordInsert(i, 100 + i);
+    }
+
+    // the write back of page 100 fails, so its frame keeps it. It isn't
+    // remembered as evicted, so reading it again doesn't make it hot.
+    EXPECT_EQ(policy->Evict([](int) { return true; }).value(), 0);
+    policy->RestoreEvicted(0, 100);
+    policy->RecordInsert(0, 100);
+
+    for (int i = 1; i < 4; i++) {
+        EXPECT_EQ(policy->Evict([](int) { return true; }).value(), i);
+    }
+    EXPECT_EQ(policy->Evict([](int) { return true; }).value(), 0);
+}
+
+TEST(TwoQueueReplacementPolicyTest, SkipsFramesWhichAreNotEvictable) {
+    auto policy = std::make_unique<TwoQueueReplacementPolicy>(4);
+    for (int i = 0; i < 4; i++) {
+        policy->RecordInsert(i, i);
+    }
+
+    auto victim =
+        policy->Evict([](int frame_index) { return frame_index == 2; });
+    EXPECT_TRUE(victim.ok());
+    EXPECT_EQ(victim.value(), 2);
+
+    policy->Remove(0);
+    EXPECT_FALSE(
+        policy->Evict([](int frame_index) { return frame_index == 0; }).ok());
+}
+
+}  // namespace graphchaindb
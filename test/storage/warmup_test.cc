@@ -0,0 +1,144 @@
+#include "src/storage/warmup.h"
+
+#include <glog/logging.h>
+#include <gtest/gtest.h>
+
+#include <cstring>
+#include <filesystem>
+#include <memory>
+#include <vector>
+
+#include "src/common/config.h"
+#include "src/common/test_utils.h"
+#include "src/storage/buffer_manager.h"
+#include "src/storage/disk_manager.h"
+#include "src/storage/log_manager.h"
+
+namespace graphchaindb {
+
+class WarmupTest : public ::testing::Test {
+   protected:
+    WarmupTest() {
+        for (auto extension : {".db", ".log", ".warmup"}) {
+            std::filesystem::remove(
+                std::string{TEST_DB_PATH.data(), TEST_DB_PATH.size()} +
+                extension);
+        }
+        disk_manager = std::make_unique<DiskManager>(TEST_DB_PATH);
+        log_manager = std::make_unique<LogManager>(disk_manager.get());
+        buffer_manager = std::make_unique<BufferManager>(disk_manager.get(),
+                                                         log_manager.get());
+    }
+
+    absl::Status Init() {
+        auto s = disk_manager->CreateDBFilesAndLoadDB();
+        if (!s.ok()) {
+            return s.status();
+        }
+
+        log_manager->SetNextLogNumber(STARTING_LOG_NUMBER);
+
+        return buffer_manager->Init(STARTING_NORMAL_PAGE_ID);
+    }
+
+    // Allocate count pages holding their index and write them to disk
+    void CreatePages(int count) {
+        for (int i = 0; i < count; i++) {
+            auto page = buffer_manager->AllocateNewPage().value();
+            memcpy(page->GetData(), &i, sizeof(int));
+            buffer_manager->UnpinPage(page, true);
+        }
+        EXPECT_TRUE(buffer_manager->FlushDirtyPages(count).ok());
+    }
+
+    // Replace the buffer manager as if the database was restarted
+    void Restart() {
+        buffer_manager.reset();
+        buffer_manager = std::make_unique<BufferManager>(disk_manager.get(),
+                                                         log_manager.get());
+        EXPECT_TRUE(buffer_manager->Init(next_page_id).ok());
+    }
+
+    std::unique_ptr<DiskManager> disk_manager;
+    std::unique_ptr<LogManager> log_manager;
+    std::unique_ptr<BufferManager> buffer_manager;
+    page_id_t next_page_id{STARTING_NORMAL_PAGE_ID};
+};
+
+TEST_F(WarmupTest, SaveOrdersPagesByHitsSucceeds) {
+    EXPECT_TRUE(Init().ok());
+    CreatePages(10);
+
+    // page i is hit 10 - i times
+    for (int i = 0; i < 10; i++) {
+        for (int hit = 0; hit < 10 - i; hit++) {
+            auto page = buffer_manager
+                            ->GetPageWithId(STARTING_NORMAL_PAGE_ID + i)
+                            .value();
+            buffer_manager->UnpinPage(page);
+        }
+    }
+
+    Warmup warmup(buffer_manager.get(), disk_manager.get());
+    EXPECT_TRUE(warmup.Save().ok());
+
+    auto page_ids_or_status = disk_manager->ReadWarmupFile();
+    EXPECT_TRUE(page_ids_or_status.ok());
+    auto page_ids = page_ids_or_status.value();
+    ASSERT_EQ(page_ids.size(), 10);
+    for (int i = 0; i < 10; i++) {
+        EXPECT_EQ(page_ids[i], STARTING_NORMAL_PAGE_ID + i);
+    }
+}
+
+TEST_F(WarmupTest, PrefetchAfterRestartSucceeds) {
+    EXPECT_TRUE(Init().ok());
+    constexpr int page_count = 20;
+    CreatePages(page_count);
+    next_page_id = STARTING_NORMAL_PAGE_ID + page_count;
+
+    // the buffer manager saves the resident pages when it stops
+    Restart();
+
+    Warmup warmup(buffer_manager.get(), disk_manager.get());
+    EXPECT_TRUE(warmup.StartPrefetch().ok());
+    warmup.WaitForPrefetch();
+    EXPECT_EQ(warmup.GetPrefetchedPageCount(), page_count);
+
+    auto misses = buffer_manager->GetStats().GetTotal(BUFFER_MISS);
+    for (int i = 0; i < page_count; i++) {
+        auto page = buffer_manager->GetPageWithId(STARTING_NORMAL_PAGE_ID + i)
+                        .value();
+        EXPECT_EQ(*reinterpret_cast<int*>(page->GetData()), i);
+        buffer_manager->UnpinPage(page);
+    }
+    EXPECT_EQ(buffer_manager->GetStats().GetTotal(BUFFER_MISS), misses);
+}
+
+TEST_F(WarmupTest, PrefetchDoesNotEvictSucceeds) {
+    EXPECT_TRUE(Init().ok());
+    constexpr int page_count = 20;
+    CreatePages(page_count);
+    next_page_id = STARTING_NORMAL_PAGE_ID + page_count;
+    Restart();
+
+    // the pages allocated after the restart take every frame
+    for (int i = 0; i < PAGE_BUFFER_SIZE; i++) {
+        auto page = buffer_manager->AllocateNewPage().value();
+        buffer_manager->UnpinPage(page);
+    }
+
+    Warmup warmup(buffer_manager.get(), disk_manager.get());
+    EXPECT_TRUE(warmup.StartPrefetch().ok());
+    warmup.WaitForPrefetch();
+    EXPECT_EQ(warmup.GetPrefetchedPageCount(), 0);
+}
+
+TEST_F(WarmupTest, PrefetchWithoutFileFails) {
+    EXPECT_TRUE(Init().ok());
+
+    Warmup warmup(buffer_manager.get(), disk_manager.get());
+    EXPECT_TRUE(absl::IsNotFound(warmup.StartPrefetch()));
+}
+
+}  // namespace graphchaindb